@@ -0,0 +1,225 @@
+#ifndef __AMBIENT_COLOR_H__
+#define __AMBIENT_COLOR_H__
+
+/**
+ * Ambient LED colour sampling behind GFX_extract_average_color in api.c.
+ *
+ * Samples the frame on a 7x7 grid, but only every AMBIENT_PHASES-th grid
+ * row per call, rotating through them. The per phase sums are kept around
+ * so the result still covers the whole grid, just spread over the last few
+ * frames, at a fraction of the cost per frame. Kept free of SDL so
+ * tests/ambient_test.c can check it against the full grid version.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#define AMBIENT_STEP 7
+#define AMBIENT_PHASES 4
+
+typedef struct AmbientSums {
+	uint32_t r, g, b, count;
+	uint32_t rcolor, gcolor, bcolor, colorful;
+} AmbientSums;
+
+#if defined(__ARM_NEON) || defined(__aarch64__)
+#include <arm_neon.h>
+#define AMBIENT_NEON
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define AMBIENT_SSE2
+#endif
+
+// A pixel counts as colorful if saturation > 50 && max_c > 50, where
+// saturation = (max_c - min_c) * 255 / max_c. Since 255 = 5 * 51 that
+// is exactly 5 * (max_c - min_c) >= max_c, no division needed.
+static inline void ambientSampleRow_c(const uint32_t* row, unsigned x, unsigned width, AmbientSums* sums) {
+	for (; x < width; x += AMBIENT_STEP) {
+		uint32_t pixel = row[x];
+
+		// input pixel format: AABBGGRR
+		uint8_t r = pixel & 0xFF;
+		uint8_t g = (pixel >> 8) & 0xFF;
+		uint8_t b = (pixel >> 16) & 0xFF;
+
+		uint8_t max_c = r > g ? r : g;
+		max_c = max_c > b ? max_c : b;
+		uint8_t min_c = r < g ? r : g;
+		min_c = min_c < b ? min_c : b;
+
+		sums->r += r;
+		sums->g += g;
+		sums->b += b;
+		sums->count++;
+		if (max_c > 50 && 5 * (max_c - min_c) >= max_c) {
+			sums->rcolor += r;
+			sums->gcolor += g;
+			sums->bcolor += b;
+			sums->colorful++;
+		}
+	}
+}
+
+static inline void ambientSampleRow(const uint32_t* row, unsigned width, AmbientSums* sums) {
+	unsigned x = 0;
+#if defined(AMBIENT_NEON)
+	uint32x4_t sum_r = vdupq_n_u32(0), sum_g = vdupq_n_u32(0), sum_b = vdupq_n_u32(0);
+	uint32x4_t col_r = vdupq_n_u32(0), col_g = vdupq_n_u32(0), col_b = vdupq_n_u32(0);
+	uint32x4_t col_n = vdupq_n_u32(0);
+	for (; x + 7 * AMBIENT_STEP < width; x += 8 * AMBIENT_STEP) {
+		uint32_t gathered[8];
+		for (int i = 0; i < 8; i++)
+			gathered[i] = row[x + i * AMBIENT_STEP];
+		uint8x8x4_t px = vld4_u8((const uint8_t*)gathered); // r, g, b, a planes
+		uint8x8_t max_c = vmax_u8(vmax_u8(px.val[0], px.val[1]), px.val[2]);
+		uint8x8_t min_c = vmin_u8(vmin_u8(px.val[0], px.val[1]), px.val[2]);
+		uint16x8_t max16 = vmovl_u8(max_c);
+		uint16x8_t spread = vmulq_n_u16(vmovl_u8(vsub_u8(max_c, min_c)), 5);
+		uint16x8_t mask = vandq_u16(vcgeq_u16(spread, max16), vcgtq_u16(max16, vdupq_n_u16(50)));
+
+		uint16x8_t r = vmovl_u8(px.val[0]);
+		uint16x8_t g = vmovl_u8(px.val[1]);
+		uint16x8_t b = vmovl_u8(px.val[2]);
+		sum_r = vpadalq_u16(sum_r, r);
+		sum_g = vpadalq_u16(sum_g, g);
+		sum_b = vpadalq_u16(sum_b, b);
+		col_r = vpadalq_u16(col_r, vandq_u16(r, mask));
+		col_g = vpadalq_u16(col_g, vandq_u16(g, mask));
+		col_b = vpadalq_u16(col_b, vandq_u16(b, mask));
+		col_n = vpadalq_u16(col_n, vshrq_n_u16(mask, 15));
+		sums->count += 8;
+	}
+	uint32_t lanes[7][4];
+	vst1q_u32(lanes[0], sum_r);
+	vst1q_u32(lanes[1], sum_g);
+	vst1q_u32(lanes[2], sum_b);
+	vst1q_u32(lanes[3], col_r);
+	vst1q_u32(lanes[4], col_g);
+	vst1q_u32(lanes[5], col_b);
+	vst1q_u32(lanes[6], col_n);
+#elif defined(AMBIENT_SSE2)
+	const __m128i byte_mask = _mm_set1_epi32(0xFF);
+	const __m128i ones = _mm_set1_epi16(1);
+	const __m128i fifty = _mm_set1_epi16(50);
+	__m128i sum_r = _mm_setzero_si128(), sum_g = _mm_setzero_si128(), sum_b = _mm_setzero_si128();
+	__m128i col_r = _mm_setzero_si128(), col_g = _mm_setzero_si128(), col_b = _mm_setzero_si128();
+	__m128i col_n = _mm_setzero_si128();
+	for (; x + 7 * AMBIENT_STEP < width; x += 8 * AMBIENT_STEP) {
+		const uint32_t* p = row + x;
+		__m128i lo = _mm_setr_epi32(p[0], p[AMBIENT_STEP], p[2 * AMBIENT_STEP], p[3 * AMBIENT_STEP]);
+		__m128i hi = _mm_setr_epi32(p[4 * AMBIENT_STEP], p[5 * AMBIENT_STEP], p[6 * AMBIENT_STEP], p[7 * AMBIENT_STEP]);
+		// one channel per 16 bit lane, values stay in 0..255 so signed packs and compares are fine
+		__m128i r = _mm_packs_epi32(_mm_and_si128(lo, byte_mask), _mm_and_si128(hi, byte_mask));
+		__m128i g = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(lo, 8), byte_mask), _mm_and_si128(_mm_srli_epi32(hi, 8), byte_mask));
+		__m128i b = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(lo, 16), byte_mask), _mm_and_si128(_mm_srli_epi32(hi, 16), byte_mask));
+		__m128i max_c = _mm_max_epi16(_mm_max_epi16(r, g), b);
+		__m128i min_c = _mm_min_epi16(_mm_min_epi16(r, g), b);
+		__m128i spread = _mm_mullo_epi16(_mm_sub_epi16(max_c, min_c), _mm_set1_epi16(5));
+		__m128i mask = _mm_andnot_si128(_mm_cmpgt_epi16(max_c, spread), _mm_cmpgt_epi16(max_c, fifty));
+
+		sum_r = _mm_add_epi32(sum_r, _mm_madd_epi16(r, ones));
+		sum_g = _mm_add_epi32(sum_g, _mm_madd_epi16(g, ones));
+		sum_b = _mm_add_epi32(sum_b, _mm_madd_epi16(b, ones));
+		col_r = _mm_add_epi32(col_r, _mm_madd_epi16(_mm_and_si128(r, mask), ones));
+		col_g = _mm_add_epi32(col_g, _mm_madd_epi16(_mm_and_si128(g, mask), ones));
+		col_b = _mm_add_epi32(col_b, _mm_madd_epi16(_mm_and_si128(b, mask), ones));
+		col_n = _mm_add_epi32(col_n, _mm_madd_epi16(_mm_and_si128(mask, ones), ones));
+		sums->count += 8;
+	}
+	uint32_t lanes[7][4];
+	_mm_storeu_si128((__m128i*)lanes[0], sum_r);
+	_mm_storeu_si128((__m128i*)lanes[1], sum_g);
+	_mm_storeu_si128((__m128i*)lanes[2], sum_b);
+	_mm_storeu_si128((__m128i*)lanes[3], col_r);
+	_mm_storeu_si128((__m128i*)lanes[4], col_g);
+	_mm_storeu_si128((__m128i*)lanes[5], col_b);
+	_mm_storeu_si128((__m128i*)lanes[6], col_n);
+#endif
+#if defined(AMBIENT_NEON) || defined(AMBIENT_SSE2)
+	uint32_t* fields[7] = {&sums->r, &sums->g, &sums->b, &sums->rcolor, &sums->gcolor, &sums->bcolor, &sums->colorful};
+	for (int i = 0; i < 7; i++)
+		*fields[i] += lanes[i][0] + lanes[i][1] + lanes[i][2] + lanes[i][3];
+#endif
+	ambientSampleRow_c(row, x, width, sums);
+}
+
+typedef struct AmbientState {
+	AmbientSums phase_sums[AMBIENT_PHASES];
+	int phase;
+	unsigned last_width;
+	unsigned last_height;
+
+	// keep track of last invocation's values
+	// in order to blend them
+	uint16_t prev_r;
+	uint16_t prev_g;
+	uint16_t prev_b;
+} AmbientState;
+
+/**
+ * Samples the next phase of the frame into state and returns the blended
+ * 0x00RRGGBB ambient colour, or 0 if nothing was sampled yet.
+ */
+static inline uint32_t ambientExtract(AmbientState* state, const void* data, unsigned width, unsigned height, size_t pitch) {
+	// a different frame size means the old sums no longer line up
+	if (width != state->last_width || height != state->last_height) {
+		memset(state->phase_sums, 0, sizeof(state->phase_sums));
+		state->phase = 0;
+		state->last_width = width;
+		state->last_height = height;
+	}
+
+	// Downsample 7x7 instead of 8x8 to de-emphasize effect of
+	// repeated scrolling tiles (intentionally interfere with patterns)
+	AmbientSums* sums = &state->phase_sums[state->phase];
+	memset(sums, 0, sizeof(AmbientSums));
+	for (unsigned y = state->phase * AMBIENT_STEP; y < height; y += AMBIENT_STEP * AMBIENT_PHASES) {
+		ambientSampleRow((const uint32_t*)((const uint8_t*)data + y * pitch), width, sums);
+	}
+	state->phase = (state->phase + 1) % AMBIENT_PHASES;
+
+	uint64_t total_r = 0;
+	uint64_t total_g = 0;
+	uint64_t total_b = 0;
+	uint64_t total_rcolor = 0;
+	uint64_t total_gcolor = 0;
+	uint64_t total_bcolor = 0;
+	uint64_t pixel_count = 0;
+	uint64_t colorful_pixel_count = 0;
+	for (int i = 0; i < AMBIENT_PHASES; i++) {
+		total_r += state->phase_sums[i].r;
+		total_g += state->phase_sums[i].g;
+		total_b += state->phase_sums[i].b;
+		pixel_count += state->phase_sums[i].count;
+		total_rcolor += state->phase_sums[i].rcolor;
+		total_gcolor += state->phase_sums[i].gcolor;
+		total_bcolor += state->phase_sums[i].bcolor;
+		colorful_pixel_count += state->phase_sums[i].colorful;
+	}
+
+	if (colorful_pixel_count > 0) {
+		total_r = total_rcolor;
+		total_g = total_gcolor;
+		total_b = total_bcolor;
+		pixel_count = colorful_pixel_count;
+	}
+	if (pixel_count == 0)
+		return 0;
+
+	uint8_t ambient_r = total_r / pixel_count;
+	uint8_t ambient_g = total_g / pixel_count;
+	uint8_t ambient_b = total_b / pixel_count;
+
+	uint32_t average_color = (((state->prev_r + ambient_r) / 2) << 16) |
+							 (((state->prev_g + ambient_g) / 2) << 8) |
+							 ((state->prev_b + ambient_b) / 2);
+
+	state->prev_r = ambient_r;
+	state->prev_g = ambient_g;
+	state->prev_b = ambient_b;
+
+	return average_color;
+}
+
+#endif // __AMBIENT_COLOR_H__
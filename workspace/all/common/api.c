@@ -4,6 +4,7 @@
 
 #include <errno.h>
 #include <fcntl.h>
+#include <limits.h>
 #include <math.h>
 #include <msettings.h>
 #include <pthread.h>
@@ -19,11 +20,14 @@
 
 #include "utils.h"
 #include "config.h"
+#include "audio_convert.h"
+#include "audio_polyphase.h"
+#include "frame_pacing.h"
+#include "ambient_color.h"
+#include "scale_blend.h"
 
 #include <pthread.h>
 
-extern pthread_mutex_t audio_mutex;
-
 ///////////////////////////////
 
 void LOG_note(int level, const char* fmt, ...) {
@@ -146,11 +150,14 @@ static inline uint32_t UintMult(uint32_t color, uint32_t modulate_rgb) {
 }
 
 ///////////////////////////////
+// index is the frontend option value, value is the libsamplerate converter type
+#define SND_QUALITY_POLYPHASE -1 // built-in fixed-point resampler, see SND_polyphaseResample()
 static int qualityLevels[] = {
 	3,
 	4,
 	2,
-	1};
+	1,
+	SND_QUALITY_POLYPHASE};
 static struct PWR_Context {
 	int initialized;
 
@@ -179,12 +186,9 @@ static struct SND_Context {
 	int sample_rate_in;
 	int sample_rate_out;
 
-	SND_Frame* buffer;	// buf
-	size_t frame_count; // buf_len
-
-	int frame_in;	  // buf_w
-	int frame_out;	  // buf_r
-	int frame_filled; // max_buf_w
+	// frame_in is only advanced by the emulation thread, frame_out only
+	// by the SDL audio callback, see audio_ring.h
+	SND_Ring ring;
 
 	int device_id; // SDL device id
 } snd = {0};
@@ -420,82 +424,13 @@ void GFX_startFrame(void) {
 	frame_start = SDL_GetTicks();
 }
 
+static AmbientState ambient = {0};
+
 uint32_t GFX_extract_average_color(const void* data, unsigned width, unsigned height, size_t pitch) {
 	if (!data) {
 		return 0;
 	}
-
-	const uint32_t* pixels = (const uint32_t*)data;
-	int pixel_count = 0;
-
-	uint64_t total_r = 0;
-	uint64_t total_g = 0;
-	uint64_t total_b = 0;
-	uint64_t total_rcolor = 0;
-	uint64_t total_gcolor = 0;
-	uint64_t total_bcolor = 0;
-	uint32_t colorful_pixel_count = 0;
-
-	// Downsample 7x7 instead of 8x8 to de-emphasize effect of
-	// repeated scrolling tiles (intentionally interfere with patterns)
-	for (unsigned y = 0; y < height; y += 7) {
-		for (unsigned x = 0; x < width; x += 7) {
-			uint32_t pixel = pixels[y * (pitch / 4) + x];
-
-			// input pixel format: AABBGGRR
-			uint8_t r = pixel & 0xFF;
-			uint8_t g = (pixel >> 8) & 0xFF;
-			uint8_t b = (pixel >> 16) & 0xFF;
-
-			// max_c = max(max(r, g), b)
-			uint8_t max_c = r > g ? r : g;
-			max_c = max_c > b ? max_c : b;
-
-			// min_c = min(min(r, g), b)
-			uint8_t min_c = r < g ? r : g;
-			min_c = min_c < b ? min_c : b;
-
-			uint8_t saturation = max_c == 0 ? 0 : (max_c - min_c) * 255 / max_c;
-
-			total_r += r;
-			total_g += g;
-			total_b += b;
-			pixel_count++;
-			if (saturation > 50 && max_c > 50) {
-				total_rcolor += r;
-				total_gcolor += g;
-				total_bcolor += b;
-				colorful_pixel_count++;
-			}
-		}
-	}
-
-	if (colorful_pixel_count > 0) {
-		total_r = total_rcolor;
-		total_g = total_gcolor;
-		total_b = total_bcolor;
-		pixel_count = colorful_pixel_count;
-	}
-
-	uint8_t ambient_r = total_r / pixel_count;
-	uint8_t ambient_g = total_g / pixel_count;
-	uint8_t ambient_b = total_b / pixel_count;
-
-	// keep track of last invocation's values
-	// in order to blend them
-	static uint16_t amb_prev_r = 0;
-	static uint16_t amb_prev_g = 0;
-	static uint16_t amb_prev_b = 0;
-
-	uint32_t average_color = (((amb_prev_r + ambient_r) / 2) << 16) |
-							 (((amb_prev_g + ambient_g) / 2) << 8) |
-							 ((amb_prev_b + ambient_b) / 2);
-
-	amb_prev_r = ambient_r;
-	amb_prev_g = ambient_g;
-	amb_prev_b = ambient_b;
-
-	return average_color;
+	return ambientExtract(&ambient, data, width, height, pitch);
 }
 
 void GFX_setAmbientColor(const void* data, unsigned width, unsigned height, size_t pitch, int mode) {
@@ -520,6 +455,13 @@ void GFX_setAmbientColor(const void* data, unsigned width, unsigned height, size
 	}
 }
 
+static void recordFrameTime(double frame_ms) {
+	int bin = frame_ms > 0.0 ? (int)frame_ms : 0;
+	if (bin >= PERF_FRAME_HIST_BINS)
+		bin = PERF_FRAME_HIST_BINS - 1;
+	perf.frame_hist[bin]++;
+}
+
 void GFX_flip(SDL_Surface* screen) {
 	{
 		uint64_t performance_frequency = SDL_GetPerformanceFrequency();
@@ -542,6 +484,7 @@ void GFX_flip(SDL_Surface* screen) {
 	double frame_ms = elapsed_time_s * 1000.0;
 	double target_ms = 1000.0 / SCREEN_FPS;
 	perf.jitter = fabs(frame_ms - target_ms);
+	recordFrameTime(frame_ms);
 
 	if (frame_ms > target_ms * 1.1) {
 		perf.frame_drops++;
@@ -598,6 +541,7 @@ void GFX_GL_Swap() {
 	double frame_ms = elapsed_time_s * 1000.0;
 	double target_ms = 1000.0 / SCREEN_FPS;
 	perf.jitter = fabs(frame_ms - target_ms);
+	recordFrameTime(frame_ms);
 
 	if (frame_ms > target_ms * 1.1) {
 		perf.frame_drops++;
@@ -646,6 +590,21 @@ void GFX_sync(void) {
 	}
 }
 
+static GFX_Pacer pacer = {0};
+
+// deadline and now are SDL performance counter values
+static void waitUntil(int64_t deadline, int64_t now, int64_t perf_freq) {
+	if (!pacer.max_ns)
+		GFX_pacerInit(&pacer);
+
+	// SDL's counter is not guaranteed to be CLOCK_MONOTONIC, so only carry
+	// the remaining time across and take the absolute deadline from the clock
+	// we're going to sleep on
+	int64_t mono_deadline = GFX_pacerNow() + (int64_t)((double)(deadline - now) * 1e9 / perf_freq);
+	GFX_pacerWait(&pacer, mono_deadline);
+	perf.wake_margin_us = pacer.wake_margin_ns / 1000.0;
+}
+
 void GFX_flip_fixed_rate(SDL_Surface* screen, double target_fps) {
 	if (target_fps == 0.0)
 		target_fps = SCREEN_FPS;
@@ -688,19 +647,7 @@ void GFX_flip_fixed_rate(SDL_Surface* screen, double target_fps) {
 			last_target_fps = 0.0;
 			LOG_debug("%s: lost sync by more than %d frames (early ?!) @%llu -> reset\n\n", __FUNCTION__, max_lost_frames, SDL_GetPerformanceCounter());
 		} else if (offset < 0) {
-			useconds_t time_to_sleep_us = (useconds_t)((time_of_frame - now) * 1e6 / perf_freq);
-
-			// The OS scheduling algorithm cannot guarantee that
-			// the sleep will last the exact amount of requested time.
-			// We sleep as much as we can using the OS primitive.
-			const useconds_t min_waiting_time = 2000;
-			if (time_to_sleep_us > min_waiting_time) {
-				usleep(time_to_sleep_us - min_waiting_time);
-			}
-
-			while (SDL_GetPerformanceCounter() < time_of_frame) {
-				// nothing...
-			}
+			waitUntil(time_of_frame, now, perf_freq);
 		}
 	}
 	PLAT_GL_Swap();
@@ -712,6 +659,7 @@ void GFX_flip_fixed_rate(SDL_Surface* screen, double target_fps) {
 	double frame_ms = elapsed_time_s * 1000.0;
 	double target_ms = 1000.0 / target_fps;
 	perf.jitter = fabs(frame_ms - target_ms);
+	recordFrameTime(frame_ms);
 
 	if (frame_ms > target_ms * 1.1) {
 		perf.frame_drops++;
@@ -948,19 +896,6 @@ struct blend_args {
 	uint16_t* blend_line;
 } blend_args;
 
-// Pure C fallbacks
-static inline uint32_t average16_c(uint32_t c1, uint32_t c2) {
-	return (c1 + c2 + ((c1 ^ c2) & 0x0821)) >> 1;
-}
-
-static inline uint32_t average32_c(uint32_t c1, uint32_t c2) {
-	uint32_t sum = c1 + c2;
-	uint32_t ret = sum + ((c1 ^ c2) & 0x08210821);
-	uint32_t of = ((sum < c1) | (ret < sum)) << 31;
-
-	return (ret >> 1) | of;
-}
-
 // not sure we are activating this anywhere currently, but we could.
 // to be honest, I'm not sure if we're using this function at all right now,
 // but I'm fixing it anyway so might as well improve it.
@@ -971,84 +906,6 @@ static inline uint32x4_t average32_neon(uint32x4_t a, uint32x4_t b) {
 }
 #endif
 
-// aarch32 asm
-#if defined(__arm__) && !defined(__aarch64__)
-static inline uint32_t average16(uint32_t c1, uint32_t c2) {
-	uint32_t ret, lowbits = 0x0821;
-	asm volatile(
-		"eor %0, %2, %3\n\t"
-		"and %0, %0, %1\n\t"
-		"add %0, %3, %0\n\t"
-		"add %0, %0, %2\n\t"
-		"lsr %0, %0, #1\n\t"
-		: "=&r"(ret)
-		: "r"(lowbits), "r"(c1), "r"(c2));
-	return ret;
-}
-
-static inline uint32_t average32(uint32_t c1, uint32_t c2) {
-	uint32_t ret, lowbits = 0x08210821;
-	asm volatile(
-		"eor %0, %3, %1\n\t"
-		"and %0, %0, %2\n\t"
-		"adds %0, %1, %0\n\t"
-		"and %1, %1, #0\n\t"
-		"movcs %1, #0x80000000\n\t"
-		"adds %0, %0, %3\n\t"
-		"rrx %0, %0\n\t"
-		"orr %0, %0, %1\n\t"
-		: "=&r"(ret), "+r"(c2)
-		: "r"(lowbits), "r"(c1)
-		: "cc");
-	return ret;
-}
-
-// aarch64 asm
-#elif defined(__aarch64__)
-
-static inline uint32_t average16(uint32_t c1, uint32_t c2) {
-	uint32_t result;
-	asm volatile(
-		"and w2, %w0, %w1\n\t"
-		"eor w3, %w0, %w1\n\t"
-		"lsr w3, w3, #1\n\t"
-		"add %w2, w2, w3\n\t"
-		"mov %w0, w2\n\t"
-		: "+r"(c1)
-		: "r"(c2)
-		: "w2", "w3");
-	return c1;
-}
-
-static inline uint32_t average32(uint32_t c1, uint32_t c2) {
-	uint32_t result;
-	asm volatile(
-		"and w2, %w0, %w1\n\t"
-		"eor w3, %w0, %w1\n\t"
-		"lsr w3, w3, #1\n\t"
-		"add w2, w2, w3\n\t"
-		"mov %w0, w2\n\t"
-		: "+r"(c1)
-		: "r"(c2)
-		: "w2", "w3");
-	return c1;
-}
-
-// fallback if nothing else works
-#else
-#define average16 average16_c
-#define average32 average32_c
-#endif
-
-#define AVERAGE16_NOCHK(c1, c2) (average16((c1), (c2)))
-#define AVERAGE32_NOCHK(c1, c2) (average32((c1), (c2)))
-
-#define AVERAGE16(c1, c2) ((c1) == (c2) ? (c1) : AVERAGE16_NOCHK((c1), (c2)))
-#define AVERAGE16_1_3(c1, c2) ((c1) == (c2) ? (c1) : (AVERAGE16_NOCHK(AVERAGE16_NOCHK((c1), (c2)), (c2))))
-
-#define AVERAGE32(c1, c2) ((c1) == (c2) ? (c1) : AVERAGE32_NOCHK((c1), (c2)))
-#define AVERAGE32_1_3(c1, c2) ((c1) == (c2) ? (c1) : (AVERAGE32_NOCHK(AVERAGE32_NOCHK((c1), (c2)), (c2))))
-
 static inline int gcd(int a, int b) {
 	return b ? gcd(b, a % b) : a;
 }
@@ -1093,19 +950,7 @@ static void scaleAA(void* __restrict src, void* __restrict dst, uint32_t w, uint
 					src32 = tmp;
 				}
 
-				if (dy > rat_dst_h - bh[1] || dy <= bh[1]) {
-					while (count--) {
-						*pblend32++ = AVERAGE32_1_3(*src32, *pnext32);
-						src32++;
-						pnext32++;
-					}
-				} else {
-					while (count--) {
-						*pblend32++ = AVERAGE32(*src32, *pnext32);
-						src32++;
-						pnext32++;
-					}
-				}
+				blendLines(pblend32, src32, pnext32, count, dy > rat_dst_h - bh[1] || dy <= bh[1]);
 			}
 
 			while (col--) {
@@ -1982,36 +1827,24 @@ SDL_Color GFX_mapColor(uint32_t c) {
 
 #define ms SDL_GetTicks
 
-pthread_mutex_t audio_mutex = PTHREAD_MUTEX_INITIALIZER;
-
 static void SND_audioCallback(void* userdata, uint8_t* stream, int len) {
-	if (snd.frame_count == 0)
+	if (snd.ring.frame_count == 0)
 		return;
 	if (!snd.initialized)
 		LOG_error("Calling callback without audio device\n");
 
-	int16_t* out = (int16_t*)stream;
-	len /= (sizeof(int16_t) * 2);
+	// SND_Frame is an interleaved stereo int16 pair, same layout as the AUDIO_S16 stream
+	int requested = len / sizeof(SND_Frame);
+	int read = SND_ringRead(&snd.ring, (SND_Frame*)stream, requested);
 
-	pthread_mutex_lock(&audio_mutex);
-	while (snd.frame_out != snd.frame_in && len > 0) {
-		*out++ = snd.buffer[snd.frame_out].left;
-		*out++ = snd.buffer[snd.frame_out].right;
-		snd.frame_out += 1;
-		len -= 1;
-		if (snd.frame_out >= snd.frame_count)
-			snd.frame_out = 0;
-	}
-	pthread_mutex_unlock(&audio_mutex);
-
-	if (len > 0)
-		memset(out, 0, len * (sizeof(int16_t) * 2));
+	if (read < requested)
+		memset(stream + read * sizeof(SND_Frame), 0, (requested - read) * sizeof(SND_Frame));
 }
 static void SND_resizeBuffer(void) { // plat_sound_resize_buffer
 
-	LOG_info("Resizing audio buffer for new frame count: %d\n", snd.frame_count);
+	LOG_info("Resizing audio buffer for new frame count: %d\n", snd.ring.frame_count);
 
-	if (snd.frame_count == 0)
+	if (snd.ring.frame_count == 0)
 		return;
 
 #if defined(USE_SDL2)
@@ -2020,15 +1853,14 @@ static void SND_resizeBuffer(void) { // plat_sound_resize_buffer
 	SDL_LockAudio();
 #endif
 
-	int buffer_bytes = snd.frame_count * sizeof(SND_Frame);
-	snd.buffer = (SND_Frame*)realloc(snd.buffer, buffer_bytes);
+	int buffer_bytes = snd.ring.frame_count * sizeof(SND_Frame);
+	snd.ring.buffer = (SND_Frame*)realloc(snd.ring.buffer, buffer_bytes);
 
 	LOG_info("Resized audio buffer to: %d bytes\n", buffer_bytes);
 
-	memset(snd.buffer, 0, buffer_bytes);
+	memset(snd.ring.buffer, 0, buffer_bytes);
 
-	snd.frame_in = 0;
-	snd.frame_out = 0;
+	SND_ringClear(&snd.ring);
 
 #if defined(USE_SDL2)
 	SDL_UnlockAudioDevice(snd.device_id);
@@ -2040,99 +1872,169 @@ static int soundQuality = 2;
 static int resetSrcState = 0;
 void SND_setQuality(int quality) {
 	LOG_info("Set sound quality\n");
+	if (quality < 0 || quality >= (int)(sizeof(qualityLevels) / sizeof(qualityLevels[0])))
+		quality = 2;
 	soundQuality = qualityLevels[quality];
 	resetSrcState = 1;
 }
-ResampledFrames resample_audio(const SND_Frame* input_frames,
-							   int input_frame_count, int input_sample_rate,
-							   int output_sample_rate, double ratio) {
+
+// Persistent resampler state, kept across batches so the audio path
+// doesn't hit the heap. Scratch buffers are sized from BATCH_SIZE and
+// only ever grow (when the ratio goes up), never shrink.
+static struct SND_Resampler {
+	SRC_STATE* state;
+	double ratio;
+
+	float* input;	 // interleaved stereo, in frames
+	float* output;	 // interleaved stereo, in frames
+	int input_size;	 // in frames
+	int output_size; // in frames
+} resampler = {0};
+
+static int SND_reserveResampler(int input_frames, int output_frames) {
+	if (input_frames > resampler.input_size) {
+		float* input = realloc(resampler.input, input_frames * 2 * sizeof(float));
+		if (!input)
+			return 0;
+		resampler.input = input;
+		resampler.input_size = input_frames;
+	}
+	if (output_frames > resampler.output_size) {
+		float* output = realloc(resampler.output, output_frames * 2 * sizeof(float));
+		if (!output)
+			return 0;
+		resampler.output = output;
+		resampler.output_size = output_frames;
+	}
+	return 1;
+}
+
+static void SND_initResampler(void) {
+	// enough room for a full batch at the max ratio SND_batchSamples allows
+	double max_ratio = ((double)snd.sample_rate_out / snd.sample_rate_in) * 1.5;
+	if (!SND_reserveResampler(BATCH_SIZE, (int)(BATCH_SIZE * max_ratio + 1)))
+		LOG_error("SND_initResampler: failed to allocate resampler buffers\n");
+}
+
+static SND_Polyphase poly = {0};
+
+static int SND_polyphaseResample(const SND_Frame* input_frames, int input_frame_count,
+								 int input_sample_rate, int output_sample_rate, double ratio) {
+	double final_ratio = ((double)output_sample_rate / input_sample_rate) * ratio;
+
+	double cutoff = SND_polyphaseCutoff(input_sample_rate, output_sample_rate);
+	if (!poly.coefs || resetSrcState || poly.cutoff != cutoff) {
+		resetSrcState = 0;
+		SND_polyphaseReset(&poly);
+		if (!SND_polyphaseInit(&poly, cutoff)) {
+			LOG_error("SND_polyphaseResample: failed to allocate filter\n");
+			return 0;
+		}
+	}
+
+	if (!SND_polyphasePush(&poly, input_frames, input_frame_count)) {
+		LOG_error("SND_polyphaseResample: failed to grow history buffer\n");
+		return 0;
+	}
+
+	uint64_t step = SND_polyphaseStep(final_ratio);
+
+	SND_Frame* first;
+	SND_Frame* second;
+	int first_count, second_count;
+	SND_ringReserve(&snd.ring, &first, &first_count, &second, &second_count);
+
+	int count = SND_polyphaseProcess(&poly, first, first_count, step);
+	if (count == first_count)
+		count += SND_polyphaseProcess(&poly, second, second_count, step);
+	SND_polyphaseProcess(&poly, NULL, INT_MAX, step);
+
+	if (count > 0)
+		SND_ringCommit(&snd.ring, count);
+
+	SND_polyphaseCompact(&poly);
+	return count;
+}
+
+static void SND_quitResampler(void) {
+	if (resampler.state)
+		src_delete(resampler.state);
+	free(resampler.input);
+	free(resampler.output);
+	memset(&resampler, 0, sizeof(resampler));
+	SND_polyphaseQuit(&poly);
+}
+
+// Resamples input_frame_count frames and writes the result straight into
+// the ring buffer, returns the number of frames written. Output that doesn't
+// fit in the ring is dropped.
+static int SND_resampleFrames(const SND_Frame* input_frames, int input_frame_count,
+							  int input_sample_rate, int output_sample_rate, double ratio) {
 	int error;
-	static double previous_ratio = 1.0;
-	static SRC_STATE* src_state = NULL;
+
+	if (soundQuality == SND_QUALITY_POLYPHASE)
+		return SND_polyphaseResample(input_frames, input_frame_count, input_sample_rate, output_sample_rate, ratio);
 
 	double final_ratio = ((double)output_sample_rate / input_sample_rate) * ratio;
 
-	if (!src_state || resetSrcState) {
+	if (!resampler.state || resetSrcState) {
 		resetSrcState = 0;
-		src_state = src_new(soundQuality, 2, &error);
-		if (src_state == NULL) {
+		if (resampler.state)
+			src_delete(resampler.state);
+		resampler.state = src_new(soundQuality, 2, &error);
+		if (resampler.state == NULL) {
 			fprintf(stderr, "Error initializing SRC state: %s\n",
 					src_strerror(error));
 			exit(1);
 		}
+		resampler.ratio = 1.0;
 	}
 
-	if (previous_ratio != final_ratio) {
-		if (src_set_ratio(src_state, final_ratio) != 0) {
+	if (resampler.ratio != final_ratio) {
+		if (src_set_ratio(resampler.state, final_ratio) != 0) {
 			fprintf(stderr, "Error setting resampling ratio: %s\n",
-					src_strerror(src_error(src_state)));
+					src_strerror(src_error(resampler.state)));
 			exit(1);
 		}
-		previous_ratio = final_ratio;
+		resampler.ratio = final_ratio;
 	}
 
 	int max_output_frames = (int)(input_frame_count * final_ratio + 1);
-
-	float* input_buffer = (float*)malloc(input_frame_count * 2 * sizeof(float));
-	float* output_buffer = (float*)malloc(max_output_frames * 2 * sizeof(float));
-	if (!input_buffer || !output_buffer) {
-		fprintf(stderr, "Error allocating buffers\n");
-		free(input_buffer);
-		free(output_buffer);
-		src_delete(src_state);
-		exit(1);
+	if (!SND_reserveResampler(input_frame_count, max_output_frames)) {
+		LOG_error("SND_resampleFrames: failed to grow resampler buffers\n");
+		return 0;
 	}
 
-	for (int i = 0; i < input_frame_count; i++) {
-		input_buffer[2 * i] = input_frames[i].left / 32768.0f;
-		input_buffer[2 * i + 1] = input_frames[i].right / 32768.0f;
-	}
+	AUDIO_s16ToFloat((const int16_t*)input_frames, resampler.input, input_frame_count * 2);
 
 	SRC_DATA src_data = {
-		.data_in = input_buffer,
-		.data_out = output_buffer,
+		.data_in = resampler.input,
+		.data_out = resampler.output,
 		.input_frames = input_frame_count,
 		.output_frames = max_output_frames,
 		.src_ratio = final_ratio,
 		.end_of_input = 0};
 
-	if (src_process(src_state, &src_data) != 0) {
+	if (src_process(resampler.state, &src_data) != 0) {
 		fprintf(stderr, "Error resampling: %s\n",
-				src_strerror(src_error(src_state)));
-		free(input_buffer);
-		free(output_buffer);
+				src_strerror(src_error(resampler.state)));
 		exit(1);
 	}
 
-	int output_frame_count = src_data.output_frames_gen;
-
-	SND_Frame* output_frames = (SND_Frame*)malloc(output_frame_count * sizeof(SND_Frame));
-	if (!output_frames) {
-		fprintf(stderr, "Error allocating output frames\n");
-		free(input_buffer);
-		free(output_buffer);
-		exit(1);
-	}
-
-	for (int i = 0; i < output_frame_count; i++) {
-		float left = output_buffer[2 * i];
-		float right = output_buffer[2 * i + 1];
-
-		left = fmaxf(-1.0f, fminf(1.0f, left));
-		right = fmaxf(-1.0f, fminf(1.0f, right));
-
-		output_frames[i].left = (int16_t)(left * 32767.0f);
-		output_frames[i].right = (int16_t)(right * 32767.0f);
-	}
-
-	free(input_buffer);
-	free(output_buffer);
+	SND_Frame* first;
+	SND_Frame* second;
+	int first_count, second_count;
+	int free_slots = SND_ringReserve(&snd.ring, &first, &first_count, &second, &second_count);
+	int count = MIN((int)src_data.output_frames_gen, free_slots);
 
-	ResampledFrames resampled;
-	resampled.frames = output_frames;
-	resampled.frame_count = output_frame_count;
+	int head = MIN(count, first_count);
+	AUDIO_floatToS16(resampler.output, (int16_t*)first, head * 2);
+	if (count > head)
+		AUDIO_floatToS16(resampler.output + head * 2, (int16_t*)second, (count - head) * 2);
 
-	return resampled;
+	if (count > 0)
+		SND_ringCommit(&snd.ring, count);
+	return count;
 }
 
 #define ROLLING_AVERAGE_WINDOW_SIZE 120
@@ -2185,50 +2087,28 @@ float calculateBufferAdjustment(float remaining_space, float targetbuffer_over,
 	return rolling_average;
 }
 
-static SND_Frame tmpbuffer[BATCH_SIZE];
-static SND_Frame* unwritten_frames = NULL;
-static int unwritten_frame_count = 0;
-
 size_t SND_batchSamples(const SND_Frame* frames, size_t frame_count) {
 	int framecount = (int)frame_count;
 	int consumed = 0;
 	int total_consumed_frames = 0;
 	double ratio = 1.0;
 
-	if (snd.frame_count <= 0) {
-		snd.frame_count = 4096; // idk some random samples nr this should never hit tho, just to be safe
-	}
-
-	pthread_mutex_lock(&audio_mutex);
-	if (snd.frame_in < 0 || snd.frame_in >= snd.frame_count) {
-		snd.frame_in = 0;
-	}
-
-	if (snd.frame_out < 0 || snd.frame_out >= snd.frame_count) {
-		snd.frame_out = 0;
+	if (snd.ring.frame_count <= 0) {
+		snd.ring.frame_count = 4096; // idk some random samples nr this should never hit tho, just to be safe
 	}
 
-	float remaining_space = 0.0f;
-	int frame_in_snapshot = snd.frame_in;
-	int frame_out_snapshot = snd.frame_out;
-	pthread_mutex_unlock(&audio_mutex);
-
-	if (frame_in_snapshot >= frame_out_snapshot) {
-		remaining_space = snd.frame_count - (frame_in_snapshot - frame_out_snapshot);
-	} else {
-		remaining_space = frame_out_snapshot - frame_in_snapshot;
-	}
+	float remaining_space = snd.ring.frame_count - SND_ringQueued(&snd.ring);
 	perf.buffer_free = remaining_space;
 
 	// let audio buffer fill a little first and then unpause audio so no underruns occur
-	if (perf.buffer_free < snd.frame_count * 0.6f) {
+	if (perf.buffer_free < snd.ring.frame_count * 0.6f) {
 		SND_pauseAudio(false);
-	} else if (perf.buffer_free > snd.frame_count * 0.99f) { // if for some reason buffer drops below threshold again, pause it (like psx core can stop sending audio in between scenes or after fast forward etc)
+	} else if (perf.buffer_free > snd.ring.frame_count * 0.99f) { // if for some reason buffer drops below threshold again, pause it (like psx core can stop sending audio in between scenes or after fast forward etc)
 		SND_pauseAudio(true);
 	}
 
 
-	float tempdelay = ((snd.frame_count - remaining_space) / snd.sample_rate_out) * 1000.0f;
+	float tempdelay = ((snd.ring.frame_count - remaining_space) / snd.sample_rate_out) * 1000.0f;
 	perf.buffer_ms = tempdelay;
 
 	// do some checks
@@ -2239,7 +2119,7 @@ size_t SND_batchSamples(const SND_Frame* frames, size_t frame_count) {
 		snd.frame_rate = 60.0f;
 	}
 
-	float bufferadjustment = calculateBufferAdjustment(remaining_space, snd.frame_count * 0.2, snd.frame_count * 0.8, frame_count);
+	float bufferadjustment = calculateBufferAdjustment(remaining_space, snd.ring.frame_count * 0.2, snd.ring.frame_count * 0.8, frame_count);
 
 	if (!isfinite(bufferadjustment)) {
 		bufferadjustment = 0.0f;
@@ -2267,32 +2147,13 @@ size_t SND_batchSamples(const SND_Frame* frames, size_t frame_count) {
 	while (framecount > 0) {
 		int amount = MIN(BATCH_SIZE, framecount);
 
-		// Copy frames to tmpbuffer for resampling
-		for (int i = 0; i < amount; i++) {
-			tmpbuffer[i] = frames[consumed + i];
-		}
+		// frames that don't fit in the ring are dropped
+		int written_frames = SND_resampleFrames(
+			frames + consumed, amount, snd.sample_rate_in, snd.sample_rate_out, ratio);
 		consumed += amount;
 		framecount -= amount;
 
-		ResampledFrames resampled = resample_audio(
-			tmpbuffer, amount, snd.sample_rate_in, snd.sample_rate_out, ratio);
-
-		int written_frames = 0;
-		pthread_mutex_lock(&audio_mutex);
-		for (int i = 0; i < resampled.frame_count; i++) {
-			// Check if buffer full (leave one slot free)
-			if ((snd.frame_in + 1) % snd.frame_count == snd.frame_out) {
-				// Buffer full, break early
-				break;
-			}
-			snd.buffer[snd.frame_in] = resampled.frames[i];
-			snd.frame_in = (snd.frame_in + 1) % snd.frame_count;
-			written_frames++;
-		}
-		pthread_mutex_unlock(&audio_mutex);
-
 		total_consumed_frames += written_frames;
-		free(resampled.frames);
 	}
 
 	return total_consumed_frames;
@@ -2317,27 +2178,20 @@ size_t SND_batchSamples_fixed_rate(const SND_Frame* frames, size_t frame_count)
 
 	// int full = 0;
 
-	float remaining_space = snd.frame_count;
-	pthread_mutex_lock(&audio_mutex);
-	if (snd.frame_in >= snd.frame_out) {
-		remaining_space = snd.frame_count - (snd.frame_in - snd.frame_out);
-	} else {
-		remaining_space = snd.frame_out - snd.frame_in;
-	}
-	pthread_mutex_unlock(&audio_mutex);
+	float remaining_space = snd.ring.frame_count - SND_ringQueued(&snd.ring);
 	// printf("    actual free: %g\n", remaining_space);
 	perf.buffer_free = remaining_space;
 	// let audio buffer fill up a little before playing audio, so no underruns occur. Target fill rate of buffer is about 50% so start playing when about 40% full
-	if (perf.buffer_free < snd.frame_count * 0.6f) {
+	if (perf.buffer_free < snd.ring.frame_count * 0.6f) {
 		SND_pauseAudio(false);
-	} else if (perf.buffer_free > snd.frame_count * 0.99f) { // if for some reason buffer drops below 1% again, pause audio again (like psx core can stop sending audio in between scenes or after fast forward etc)
+	} else if (perf.buffer_free > snd.ring.frame_count * 0.99f) { // if for some reason buffer drops below 1% again, pause audio again (like psx core can stop sending audio in between scenes or after fast forward etc)
 		SND_pauseAudio(true);
 	}
 
-	float tempdelay = ((snd.frame_count - remaining_space) / snd.sample_rate_out) * 1000;
+	float tempdelay = ((snd.ring.frame_count - remaining_space) / snd.sample_rate_out) * 1000;
 	perf.buffer_ms = tempdelay;
 
-	float occupancy = (float)(snd.frame_count - perf.buffer_free) / snd.frame_count;
+	float occupancy = (float)(snd.ring.frame_count - perf.buffer_free) / snd.ring.frame_count;
 	switch (current_mode) {
 	case SND_FF_ON_TIME:
 		if (occupancy > 0.65) {
@@ -2378,32 +2232,13 @@ size_t SND_batchSamples_fixed_rate(const SND_Frame* frames, size_t frame_count)
 	while (framecount > 0) {
 		int amount = MIN(BATCH_SIZE, framecount);
 
-		for (int i = 0; i < amount; i++) {
-			tmpbuffer[i] = frames[consumed + i];
-		}
+		// Write resampled frames to the buffer. It should never be full here tho, but just to be safe
+		int written_frames = SND_resampleFrames(
+			frames + consumed, amount, snd.sample_rate_in, snd.sample_rate_out, ratio);
 		consumed += amount;
 		framecount -= amount;
 
-		ResampledFrames resampled = resample_audio(
-			tmpbuffer, amount, snd.sample_rate_in, snd.sample_rate_out, ratio);
-
-		// Write resampled frames to the buffer
-		int written_frames = 0;
-
-		pthread_mutex_lock(&audio_mutex);
-		for (int i = 0; i < resampled.frame_count; i++) {
-			if ((snd.frame_in + 1) % snd.frame_count == snd.frame_out) {
-				// Buffer is full, break. This should never happen tho, but just to be safe
-				break;
-			}
-			snd.buffer[snd.frame_in] = resampled.frames[i];
-			snd.frame_in = (snd.frame_in + 1) % snd.frame_count;
-			written_frames++;
-		}
-		pthread_mutex_unlock(&audio_mutex);
-
 		total_consumed_frames += written_frames;
-		// No need to free - using static buffers
 	}
 
 	return total_consumed_frames;
@@ -2465,14 +2300,15 @@ void SND_init(double sample_rate, double frame_rate) { // plat_sound_init
 
 	LOG_info("We now have audio device #%d\n", snd.device_id);
 
-	snd.frame_count = ((float)spec_out.freq / SCREEN_FPS) * 8; // buffer size based on sample rate out (times 12 samples headroom)
-	perf.buffer_size = snd.frame_count;
+	snd.ring.frame_count = ((float)spec_out.freq / SCREEN_FPS) * 8; // buffer size based on sample rate out (times 12 samples headroom)
+	perf.buffer_size = snd.ring.frame_count;
 	snd.sample_rate_in = sample_rate;
 	snd.sample_rate_out = spec_out.freq;
 	perf.samplerate_in = snd.sample_rate_in;
 	perf.samplerate_out = snd.sample_rate_out;
 
 	SND_resizeBuffer();
+	SND_initResampler();
 
 	// start with audiodevice paused so buffer can fill a little, snd_batchsamples will unpause it
 	SND_pauseAudio(true);
@@ -2500,10 +2336,11 @@ void SND_quit(void) {
 	LOG_debug("SND_quit: quit audio!!\n");
 	snd.initialized = 0;
 
-	if (snd.buffer) {
-		free(snd.buffer);
-		snd.buffer = NULL;
+	if (snd.ring.buffer) {
+		free(snd.ring.buffer);
+		snd.ring.buffer = NULL;
 	}
+	SND_quitResampler();
 }
 
 void SND_resetAudio(double sample_rate, double frame_rate) {
@@ -5,6 +5,7 @@
 #include "scaler.h"
 #include "config.h"
 #include "defines.h"
+#include "audio_ring.h"
 #include <stdbool.h>
 
 ///////////////////////////////
@@ -85,6 +86,8 @@ extern uint32_t THEME_COLOR6;
 extern uint32_t THEME_COLOR7;
 extern SDL_Color ALT_BUTTON_TEXT_COLOR;
 
+#define PERF_FRAME_HIST_BINS 48 // 1ms per bin
+
 typedef struct {
 	float ratio;
 	int buffer_free;
@@ -107,6 +110,8 @@ typedef struct {
 	int frame_drops;
 	double avg_frame_ms;
 	double max_frame_ms;
+	int frame_hist[PERF_FRAME_HIST_BINS]; // frames per 1ms of frame time, the last bin also counts anything slower
+	double wake_margin_us; // how early GFX_flip_fixed_rate wakes up to spin out the rest of the frame
 } PerfProfile;
 
 extern PerfProfile perf;
@@ -399,16 +404,6 @@ void GFX_ApplyRoundedCorners_4444(SDL_Surface* surface, SDL_Rect* rect, int radi
 void GFX_ApplyRoundedCorners_8888(SDL_Surface* surface, SDL_Rect* rect, int radius);
 ///////////////////////////////
 
-typedef struct SND_Frame {
-	int16_t left;
-	int16_t right;
-} SND_Frame;
-
-typedef struct {
-	SND_Frame* frames;
-	int frame_count;
-} ResampledFrames;
-
 void SND_init(double sample_rate, double frame_rate);
 size_t SND_batchSamples(const SND_Frame* frames, size_t frame_count);
 size_t SND_batchSamples_fixed_rate(const SND_Frame* frames, size_t frame_count);
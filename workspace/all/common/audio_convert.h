@@ -0,0 +1,117 @@
+#ifndef __AUDIO_CONVERT_H__
+#define __AUDIO_CONVERT_H__
+
+/**
+ * Sample format conversion kernels shared by the emulator audio path
+ * (api.c) and the music player (player.c).
+ *
+ * Both convert interleaved int16 to float for libsamplerate and back.
+ * NEON is used on the device (and Apple Silicon desktop), SSE2 on x86
+ * desktop builds, with the scalar versions as the reference: the vector
+ * paths produce bit-identical output for all finite input.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__ARM_NEON) || defined(__aarch64__)
+#include <arm_neon.h>
+#define AUDIO_CONVERT_NEON
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define AUDIO_CONVERT_SSE2
+#endif
+
+/**
+ * Scalar reference: int16 -> float in [-1.0, 1.0).
+ * @param count Number of samples (not frames)
+ */
+static inline void AUDIO_s16ToFloat_c(const int16_t* in, float* out, size_t count) {
+	for (size_t i = 0; i < count; i++) {
+		out[i] = in[i] * (1.0f / 32768.0f);
+	}
+}
+
+/**
+ * Scalar reference: float -> int16, scaled by 32767 and saturated to the
+ * int16 range, truncating toward zero.
+ * @param count Number of samples (not frames)
+ */
+static inline void AUDIO_floatToS16_c(const float* in, int16_t* out, size_t count) {
+	for (size_t i = 0; i < count; i++) {
+		float sample = in[i] * 32767.0f;
+		if (sample > 32767.0f)
+			sample = 32767.0f;
+		if (sample < -32768.0f)
+			sample = -32768.0f;
+		out[i] = (int16_t)sample;
+	}
+}
+
+/**
+ * int16 -> float in [-1.0, 1.0), vectorized where available.
+ * @param count Number of samples (not frames)
+ */
+static inline void AUDIO_s16ToFloat(const int16_t* in, float* out, size_t count) {
+	size_t i = 0;
+#if defined(AUDIO_CONVERT_NEON)
+	const float32x4_t scale = vdupq_n_f32(1.0f / 32768.0f);
+	for (; i + 8 <= count; i += 8) {
+		int16x8_t s = vld1q_s16(in + i);
+		float32x4_t lo = vcvtq_f32_s32(vmovl_s16(vget_low_s16(s)));
+		float32x4_t hi = vcvtq_f32_s32(vmovl_s16(vget_high_s16(s)));
+		vst1q_f32(out + i, vmulq_f32(lo, scale));
+		vst1q_f32(out + i + 4, vmulq_f32(hi, scale));
+	}
+#elif defined(AUDIO_CONVERT_SSE2)
+	const __m128 scale = _mm_set1_ps(1.0f / 32768.0f);
+	for (; i + 8 <= count; i += 8) {
+		__m128i s = _mm_loadu_si128((const __m128i*)(in + i));
+		// sign-extend by unpacking into the high half and shifting back down
+		__m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(s, s), 16);
+		__m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(s, s), 16);
+		_mm_storeu_ps(out + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+		_mm_storeu_ps(out + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+	}
+#endif
+	AUDIO_s16ToFloat_c(in + i, out + i, count - i);
+}
+
+/**
+ * float -> int16, scaled by 32767 and saturated, vectorized where available.
+ * @param count Number of samples (not frames)
+ */
+static inline void AUDIO_floatToS16(const float* in, int16_t* out, size_t count) {
+	size_t i = 0;
+#if defined(AUDIO_CONVERT_NEON)
+	const float32x4_t scale = vdupq_n_f32(32767.0f);
+	const float32x4_t max = vdupq_n_f32(32767.0f);
+	const float32x4_t min = vdupq_n_f32(-32768.0f);
+	for (; i + 8 <= count; i += 8) {
+		float32x4_t lo = vmulq_f32(vld1q_f32(in + i), scale);
+		float32x4_t hi = vmulq_f32(vld1q_f32(in + i + 4), scale);
+		lo = vmaxq_f32(vminq_f32(lo, max), min);
+		hi = vmaxq_f32(vminq_f32(hi, max), min);
+		// vcvtq_s32_f32 truncates toward zero like the scalar cast
+		int16x4_t lo16 = vqmovn_s32(vcvtq_s32_f32(lo));
+		int16x4_t hi16 = vqmovn_s32(vcvtq_s32_f32(hi));
+		vst1q_s16(out + i, vcombine_s16(lo16, hi16));
+	}
+#elif defined(AUDIO_CONVERT_SSE2)
+	const __m128 scale = _mm_set1_ps(32767.0f);
+	const __m128 max = _mm_set1_ps(32767.0f);
+	const __m128 min = _mm_set1_ps(-32768.0f);
+	for (; i + 8 <= count; i += 8) {
+		__m128 lo = _mm_mul_ps(_mm_loadu_ps(in + i), scale);
+		__m128 hi = _mm_mul_ps(_mm_loadu_ps(in + i + 4), scale);
+		lo = _mm_max_ps(_mm_min_ps(lo, max), min);
+		hi = _mm_max_ps(_mm_min_ps(hi, max), min);
+		// cvttps truncates toward zero like the scalar cast
+		__m128i packed = _mm_packs_epi32(_mm_cvttps_epi32(lo), _mm_cvttps_epi32(hi));
+		_mm_storeu_si128((__m128i*)(out + i), packed);
+	}
+#endif
+	AUDIO_floatToS16_c(in + i, out + i, count - i);
+}
+
+#endif // __AUDIO_CONVERT_H__
@@ -0,0 +1,222 @@
+#ifndef __AUDIO_POLYPHASE_H__
+#define __AUDIO_POLYPHASE_H__
+
+/**
+ * Built-in fixed-point polyphase resampler behind the "polyphase" sound
+ * quality level (see SND_polyphaseResample() in api.c).
+ *
+ * Runs a Kaiser-windowed sinc directly on interleaved int16 frames with
+ * Q15 coefficients, so there is no float round trip, and the read position
+ * carries over between batches so the ratio can change smoothly every
+ * batch without resetting the filter. Kept free of SDL so
+ * tests/resampler_bench.c can measure it against libsamplerate.
+ */
+
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "audio_ring.h" // SND_Frame
+
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+#define POLY_TAPS 16
+#define POLY_PHASE_BITS 10
+#define POLY_PHASES (1 << POLY_PHASE_BITS)
+#define POLY_COEF_BITS 15
+#define POLY_KAISER_BETA 6.0
+
+typedef struct SND_Polyphase {
+	int16_t* coefs; // POLY_PHASES rows of POLY_TAPS coefficients
+	double cutoff;	// relative to the input nyquist
+
+	SND_Frame* history; // unconsumed input frames, at least POLY_TAPS - 1 of them between batches
+	int history_size;	// in frames
+	int history_count;	// in frames
+	int pos;			// integer read position in history
+	uint32_t frac;		// fractional read position, 0.32 fixed point
+} SND_Polyphase;
+
+static inline double SND_besselI0(double x) {
+	double sum = 1.0;
+	double term = 1.0;
+	for (int k = 1; k < 32; k++) {
+		term *= (x / (2.0 * k)) * (x / (2.0 * k));
+		sum += term;
+		if (term < sum * 1e-12)
+			break;
+	}
+	return sum;
+}
+
+/**
+ * Filter cutoff for a conversion between two nominal rates, relative to
+ * the input nyquist. The dynamic rate control adjustment is too small to
+ * need a different one.
+ */
+static inline double SND_polyphaseCutoff(int input_sample_rate, int output_sample_rate) {
+	double cutoff = (double)output_sample_rate / input_sample_rate;
+	if (cutoff > 1.0)
+		cutoff = 1.0;
+	return cutoff * 0.91;
+}
+
+/**
+ * Builds (or rebuilds) the coefficient table for cutoff, returns 0 if it
+ * could not be allocated.
+ */
+static inline int SND_polyphaseInit(SND_Polyphase* poly, double cutoff) {
+	if (!poly->coefs) {
+		poly->coefs = malloc(POLY_PHASES * POLY_TAPS * sizeof(int16_t));
+		if (!poly->coefs)
+			return 0;
+	}
+	poly->cutoff = cutoff;
+
+	double beta_norm = SND_besselI0(POLY_KAISER_BETA);
+	for (int p = 0; p < POLY_PHASES; p++) {
+		double frac = (double)p / POLY_PHASES;
+		double taps[POLY_TAPS];
+		double sum = 0.0;
+		for (int k = 0; k < POLY_TAPS; k++) {
+			// distance of this tap from the output position, in input samples
+			double t = k - (POLY_TAPS / 2 - 1) - frac;
+			double x = t / (POLY_TAPS / 2);
+			double window = fabs(x) >= 1.0 ? 0.0 : SND_besselI0(POLY_KAISER_BETA * sqrt(1.0 - x * x)) / beta_norm;
+			double arg = M_PI * cutoff * t;
+			double sinc = t == 0.0 ? 1.0 : sin(arg) / arg;
+			taps[k] = cutoff * sinc * window;
+			sum += taps[k];
+		}
+
+		// normalize each phase to unity gain so DC passes through unchanged
+		int16_t* row = &poly->coefs[p * POLY_TAPS];
+		int total = 0;
+		int peak = 0;
+		for (int k = 0; k < POLY_TAPS; k++) {
+			row[k] = (int16_t)lround(taps[k] / sum * (1 << POLY_COEF_BITS));
+			total += row[k];
+			if (row[k] > row[peak])
+				peak = k;
+		}
+		row[peak] += (1 << POLY_COEF_BITS) - total;
+	}
+	return 1;
+}
+
+static inline void SND_polyphaseReset(SND_Polyphase* poly) {
+	poly->history_count = 0;
+	poly->pos = 0;
+	poly->frac = 0;
+}
+
+static inline void SND_polyphaseQuit(SND_Polyphase* poly) {
+	free(poly->coefs);
+	free(poly->history);
+	memset(poly, 0, sizeof(SND_Polyphase));
+}
+
+/**
+ * Appends input frames to the history, returns 0 if it could not grow.
+ */
+static inline int SND_polyphasePush(SND_Polyphase* poly, const SND_Frame* frames, int count) {
+	int needed = poly->history_count + count;
+	if (needed > poly->history_size) {
+		SND_Frame* history = realloc(poly->history, needed * sizeof(SND_Frame));
+		if (!history)
+			return 0;
+		poly->history = history;
+		poly->history_size = needed;
+	}
+	memcpy(&poly->history[poly->history_count], frames, count * sizeof(SND_Frame));
+	poly->history_count = needed;
+	return 1;
+}
+
+/**
+ * Read position increment per output frame for an output/input ratio,
+ * 32.32 fixed point.
+ */
+static inline uint64_t SND_polyphaseStep(double ratio) {
+	return (uint64_t)(4294967296.0 / ratio);
+}
+
+static inline int16_t SND_clampSample(int32_t sample) {
+	if (sample > INT16_MAX)
+		return INT16_MAX;
+	if (sample < INT16_MIN)
+		return INT16_MIN;
+	return (int16_t)sample;
+}
+
+static inline void SND_polyphaseFrame(const SND_Frame* in, const int16_t* coefs, SND_Frame* out) {
+#if defined(__aarch64__)
+	int16x8x2_t a = vld2q_s16((const int16_t*)in);
+	int16x8x2_t b = vld2q_s16((const int16_t*)(in + 8));
+	int16x8_t c0 = vld1q_s16(coefs);
+	int16x8_t c1 = vld1q_s16(coefs + 8);
+
+	int32x4_t l = vmull_s16(vget_low_s16(a.val[0]), vget_low_s16(c0));
+	l = vmlal_s16(l, vget_high_s16(a.val[0]), vget_high_s16(c0));
+	l = vmlal_s16(l, vget_low_s16(b.val[0]), vget_low_s16(c1));
+	l = vmlal_s16(l, vget_high_s16(b.val[0]), vget_high_s16(c1));
+
+	int32x4_t r = vmull_s16(vget_low_s16(a.val[1]), vget_low_s16(c0));
+	r = vmlal_s16(r, vget_high_s16(a.val[1]), vget_high_s16(c0));
+	r = vmlal_s16(r, vget_low_s16(b.val[1]), vget_low_s16(c1));
+	r = vmlal_s16(r, vget_high_s16(b.val[1]), vget_high_s16(c1));
+
+	int32_t left = vaddvq_s32(l);
+	int32_t right = vaddvq_s32(r);
+#else
+	int32_t left = 0;
+	int32_t right = 0;
+	for (int k = 0; k < POLY_TAPS; k++) {
+		left += in[k].left * coefs[k];
+		right += in[k].right * coefs[k];
+	}
+#endif
+	out->left = SND_clampSample((left + (1 << (POLY_COEF_BITS - 1))) >> POLY_COEF_BITS);
+	out->right = SND_clampSample((right + (1 << (POLY_COEF_BITS - 1))) >> POLY_COEF_BITS);
+}
+
+/**
+ * Produces up to out_count frames from the buffered history. With
+ * out == NULL the frames are skipped instead (dropped because the ring
+ * is full).
+ */
+static inline int SND_polyphaseProcess(SND_Polyphase* poly, SND_Frame* out, int out_count, uint64_t step) {
+	int produced = 0;
+	while (produced < out_count && poly->pos + POLY_TAPS <= poly->history_count) {
+		if (out) {
+			const int16_t* coefs = &poly->coefs[(poly->frac >> (32 - POLY_PHASE_BITS)) * POLY_TAPS];
+			SND_polyphaseFrame(&poly->history[poly->pos], coefs, &out[produced]);
+		}
+		produced += 1;
+
+		uint64_t next = (uint64_t)poly->frac + step;
+		poly->pos += (int)(next >> 32);
+		poly->frac = (uint32_t)next;
+	}
+	return produced;
+}
+
+/**
+ * Drops the consumed part of the history, keeping the unconsumed tail
+ * for the next batch.
+ */
+static inline void SND_polyphaseCompact(SND_Polyphase* poly) {
+	if (poly->pos >= poly->history_count) {
+		poly->pos -= poly->history_count;
+		poly->history_count = 0;
+	} else {
+		poly->history_count -= poly->pos;
+		memmove(poly->history, &poly->history[poly->pos], poly->history_count * sizeof(SND_Frame));
+		poly->pos = 0;
+	}
+}
+
+#endif // __AUDIO_POLYPHASE_H__
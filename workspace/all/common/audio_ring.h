@@ -0,0 +1,122 @@
+#ifndef __AUDIO_RING_H__
+#define __AUDIO_RING_H__
+
+/**
+ * Lock-free single-producer/single-consumer ring of stereo frames, shared
+ * between SND_batchSamples (producer, emulation thread) and the SDL audio
+ * callback (consumer) in api.c.
+ *
+ * One slot is always left empty so that frame_in == frame_out
+ * unambiguously means "empty". Each side publishes its own index with a
+ * release store after touching the frames, and reads the other side's
+ * index with an acquire load before touching them. Kept free of SDL so
+ * tests/audio_ring_test.c can hammer it from two plain pthreads.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+typedef struct SND_Frame {
+	int16_t left;
+	int16_t right;
+} SND_Frame;
+
+typedef struct SND_Ring {
+	SND_Frame* buffer;
+	size_t frame_count; // one more than the ring can hold
+	int frame_in;		// only advanced by the producer
+	int frame_out;		// only advanced by the consumer
+} SND_Ring;
+
+/**
+ * Frames currently queued. Only a snapshot when called while both sides
+ * are running.
+ */
+static inline int SND_ringQueued(SND_Ring* ring) {
+	int in = __atomic_load_n(&ring->frame_in, __ATOMIC_ACQUIRE);
+	int out = __atomic_load_n(&ring->frame_out, __ATOMIC_ACQUIRE);
+	int queued = in - out;
+	if (queued < 0)
+		queued += ring->frame_count;
+	return queued;
+}
+
+/**
+ * Producer: returns the free space of the ring as (up to) two contiguous
+ * segments that may be written into, followed by SND_ringCommit() to
+ * publish however many frames were actually written.
+ */
+static inline int SND_ringReserve(SND_Ring* ring, SND_Frame** first, int* first_count, SND_Frame** second, int* second_count) {
+	*first_count = 0;
+	*second_count = 0;
+	if (!ring->buffer || ring->frame_count == 0)
+		return 0;
+
+	int in = __atomic_load_n(&ring->frame_in, __ATOMIC_RELAXED);
+	int out = __atomic_load_n(&ring->frame_out, __ATOMIC_ACQUIRE);
+
+	int free_slots = out - in - 1;
+	if (free_slots < 0)
+		free_slots += ring->frame_count;
+
+	int to_end = (int)ring->frame_count - in;
+	*first = &ring->buffer[in];
+	*first_count = free_slots < to_end ? free_slots : to_end;
+	*second = ring->buffer;
+	*second_count = free_slots - *first_count;
+	return free_slots;
+}
+
+/**
+ * Producer: publishes count frames written after SND_ringReserve().
+ */
+static inline void SND_ringCommit(SND_Ring* ring, int count) {
+	int in = __atomic_load_n(&ring->frame_in, __ATOMIC_RELAXED) + count;
+	if (in >= (int)ring->frame_count)
+		in -= ring->frame_count;
+	__atomic_store_n(&ring->frame_in, in, __ATOMIC_RELEASE);
+}
+
+/**
+ * Consumer: copies up to count queued frames out of the ring, returns how
+ * many were copied.
+ */
+static inline int SND_ringRead(SND_Ring* ring, SND_Frame* frames, int count) {
+	if (!ring->buffer || ring->frame_count == 0 || count <= 0)
+		return 0;
+
+	int in = __atomic_load_n(&ring->frame_in, __ATOMIC_ACQUIRE);
+	int out = __atomic_load_n(&ring->frame_out, __ATOMIC_RELAXED);
+
+	int queued = in - out;
+	if (queued < 0)
+		queued += ring->frame_count;
+	if (count > queued)
+		count = queued;
+	if (count == 0)
+		return 0;
+
+	int to_end = (int)ring->frame_count - out;
+	int first = count < to_end ? count : to_end;
+	memcpy(frames, &ring->buffer[out], first * sizeof(SND_Frame));
+	if (count > first)
+		memcpy(frames + first, ring->buffer, (count - first) * sizeof(SND_Frame));
+
+	out += count;
+	if (out >= (int)ring->frame_count)
+		out -= ring->frame_count;
+	__atomic_store_n(&ring->frame_out, out, __ATOMIC_RELEASE);
+	return count;
+}
+
+/**
+ * Empties the ring. Only safe while neither side is running, eg. with the
+ * audio device locked.
+ */
+static inline void SND_ringClear(SND_Ring* ring) {
+	__atomic_store_n(&ring->frame_in, 0, __ATOMIC_RELAXED);
+	__atomic_store_n(&ring->frame_out, 0, __ATOMIC_RELAXED);
+}
+
+#endif // __AUDIO_RING_H__
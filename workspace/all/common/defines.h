@@ -31,6 +31,7 @@
 #define RESUME_SLOT_DEFAULT 8
 #define AUTO_RESUME_SLOT 9
 #define GAME_SWITCHER_PERSIST_PATH SHARED_USERDATA_PATH "/.minui/game_switcher.txt"
+#define THUMB_CACHE_PATH USERDATA_PATH "/.thumbs" // display-ready game art, per platform since it depends on the screen
 
 #define FAUX_RECENT_PATH SDCARD_PATH "/Recently Played"
 #define COLLECTIONS_PATH SDCARD_PATH "/Collections"
@@ -39,8 +40,7 @@
 #define CHANGE_DISC_PATH "/tmp/change_disc.txt"
 #define RESUME_SLOT_PATH "/tmp/resume_slot.txt"
 #define NOUI_PATH "/tmp/noui"
-#define EMULIST_CACHE_PATH "/tmp/emulist_cache.txt"
-#define ROMINDEX_CACHE_PATH "/tmp/romindex_cache.txt"
+#define ROMINDEX_CACHE_PATH "/tmp/romindex_cache.bin"
 
 #define TRIAD_WHITE 0xff, 0xff, 0xff
 #define TRIAD_BLACK 0x00, 0x00, 0x00
@@ -0,0 +1,84 @@
+#ifndef __FRAME_PACING_H__
+#define __FRAME_PACING_H__
+
+/**
+ * Absolute-deadline frame wait used by GFX_flip_fixed_rate in api.c.
+ *
+ * The OS scheduling algorithm cannot guarantee that the sleep will last
+ * the exact amount of requested time, so we sleep until a little before
+ * the deadline and spin out the rest. How early we need to wake is learned
+ * from how late the previous sleeps came back, so on a quiet system we only
+ * spin for a couple hundred microseconds instead of burning a core for
+ * a fixed 2ms every frame (which also keeps the governor from clocking down).
+ *
+ * Everything is CLOCK_MONOTONIC nanoseconds. Kept free of SDL so
+ * tests/pacing_bench.c can measure it on a desktop.
+ */
+
+#include <errno.h>
+#include <stdint.h>
+#include <time.h>
+
+#define WAKE_MARGIN_INIT_NS 2000000LL
+#define WAKE_MARGIN_MIN_NS 150000LL
+#define WAKE_MARGIN_MAX_NS 4000000LL
+#define WAKE_MARGIN_SLACK_NS 100000LL // on top of the typical oversleep
+
+typedef struct GFX_Pacer {
+	int64_t wake_margin_ns; // how early the next wait wakes up to spin
+
+	// tuning, GFX_pacerInit fills in the WAKE_MARGIN_* defaults
+	int64_t min_ns;
+	int64_t max_ns;
+	int64_t slack_ns;
+} GFX_Pacer;
+
+static inline void GFX_pacerInit(GFX_Pacer* pacer) {
+	pacer->wake_margin_ns = WAKE_MARGIN_INIT_NS;
+	pacer->min_ns = WAKE_MARGIN_MIN_NS;
+	pacer->max_ns = WAKE_MARGIN_MAX_NS;
+	pacer->slack_ns = WAKE_MARGIN_SLACK_NS;
+}
+
+static inline int64_t GFX_pacerNow(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/**
+ * Returns once GFX_pacerNow() >= deadline, never before.
+ */
+static inline void GFX_pacerWait(GFX_Pacer* pacer, int64_t deadline) {
+	int64_t wake = deadline - pacer->wake_margin_ns;
+
+	if (wake > GFX_pacerNow()) {
+		struct timespec ts = {
+			.tv_sec = wake / 1000000000LL,
+			.tv_nsec = wake % 1000000000LL,
+		};
+		while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {
+			// absolute deadline, so just go back to sleep
+		}
+
+		int64_t woke = GFX_pacerNow();
+		if (woke > deadline) {
+			// overslept the frame itself, back off right away
+			pacer->wake_margin_ns += woke - deadline;
+		} else {
+			// otherwise drift toward the oversleep we're actually seeing
+			int64_t wanted = (woke - wake) + pacer->slack_ns;
+			pacer->wake_margin_ns += (wanted - pacer->wake_margin_ns) / 16;
+		}
+		if (pacer->wake_margin_ns < pacer->min_ns)
+			pacer->wake_margin_ns = pacer->min_ns;
+		if (pacer->wake_margin_ns > pacer->max_ns)
+			pacer->wake_margin_ns = pacer->max_ns;
+	}
+
+	while (GFX_pacerNow() < deadline) {
+		// nothing...
+	}
+}
+
+#endif // __FRAME_PACING_H__
@@ -0,0 +1,122 @@
+#ifndef __SCALE_BLEND_H__
+#define __SCALE_BLEND_H__
+
+/**
+ * rgb565 averaging used by scaleAA (api.c), kept in its own header so the
+ * vector line blend can be checked against the scalar macros on desktop
+ * (see tests/blend_test.c).
+ */
+
+#include <stdint.h>
+
+// Pure C fallbacks
+static inline uint32_t average16_c(uint32_t c1, uint32_t c2) {
+	return (c1 + c2 + ((c1 ^ c2) & 0x0821)) >> 1;
+}
+
+static inline uint32_t average32_c(uint32_t c1, uint32_t c2) {
+	uint32_t sum = c1 + c2;
+	uint32_t ret = sum + ((c1 ^ c2) & 0x08210821);
+	uint32_t of = ((sum < c1) | (ret < sum)) << 31;
+
+	return (ret >> 1) | of;
+}
+
+// aarch32 asm
+#if defined(__arm__) && !defined(__aarch64__)
+static inline uint32_t average16(uint32_t c1, uint32_t c2) {
+	uint32_t ret, lowbits = 0x0821;
+	asm volatile(
+		"eor %0, %2, %3\n\t"
+		"and %0, %0, %1\n\t"
+		"add %0, %3, %0\n\t"
+		"add %0, %0, %2\n\t"
+		"lsr %0, %0, #1\n\t"
+		: "=&r"(ret)
+		: "r"(lowbits), "r"(c1), "r"(c2));
+	return ret;
+}
+
+static inline uint32_t average32(uint32_t c1, uint32_t c2) {
+	uint32_t ret, lowbits = 0x08210821;
+	asm volatile(
+		"eor %0, %3, %1\n\t"
+		"and %0, %0, %2\n\t"
+		"adds %0, %1, %0\n\t"
+		"and %1, %1, #0\n\t"
+		"movcs %1, #0x80000000\n\t"
+		"adds %0, %0, %3\n\t"
+		"rrx %0, %0\n\t"
+		"orr %0, %0, %1\n\t"
+		: "=&r"(ret), "+r"(c2)
+		: "r"(lowbits), "r"(c1)
+		: "cc");
+	return ret;
+}
+
+// aarch64 and anything else use the C versions, on aarch64 they compile
+// to the same handful of instructions and they're what the vector blend
+// in scaleAA is checked against
+#else
+#define average16 average16_c
+#define average32 average32_c
+#endif
+
+#define AVERAGE16_NOCHK(c1, c2) (average16((c1), (c2)))
+#define AVERAGE32_NOCHK(c1, c2) (average32((c1), (c2)))
+
+#define AVERAGE16(c1, c2) ((c1) == (c2) ? (c1) : AVERAGE16_NOCHK((c1), (c2)))
+#define AVERAGE16_1_3(c1, c2) ((c1) == (c2) ? (c1) : (AVERAGE16_NOCHK(AVERAGE16_NOCHK((c1), (c2)), (c2))))
+
+#define AVERAGE32(c1, c2) ((c1) == (c2) ? (c1) : AVERAGE32_NOCHK((c1), (c2)))
+#define AVERAGE32_1_3(c1, c2) ((c1) == (c2) ? (c1) : (AVERAGE32_NOCHK(AVERAGE32_NOCHK((c1), (c2)), (c2))))
+
+// Vertical blend of two source lines into blend_line, 8 pixels at a time.
+// Per rgb565 pixel average16 is (a + b + ((a ^ b) & 0x0821)) >> 1, which
+// is the rounding-up average plus ((a ^ b) & 0x0820) >> 1, so the vector
+// paths match the scalar AVERAGE32 macros bit for bit (average32 never
+// carries between the two pixels it packs, and a == b averages to a).
+#if defined(__ARM_NEON) || defined(__aarch64__)
+#include <arm_neon.h>
+#define SCALE_AA_NEON
+static inline uint16x8_t average16x8(uint16x8_t a, uint16x8_t b) {
+	uint16x8_t diff = vandq_u16(veorq_u16(a, b), vdupq_n_u16(0x0820));
+	return vaddq_u16(vrhaddq_u16(a, b), vshrq_n_u16(diff, 1));
+}
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define SCALE_AA_SSE2
+static inline __m128i average16x8(__m128i a, __m128i b) {
+	__m128i diff = _mm_and_si128(_mm_xor_si128(a, b), _mm_set1_epi16(0x0820));
+	return _mm_add_epi16(_mm_avg_epu16(a, b), _mm_srli_epi16(diff, 1));
+}
+#endif
+
+// count is in pixel pairs, one_third blends 1:3 towards next
+static inline void blendLines(uint32_t* __restrict out, const uint32_t* src, const uint32_t* next, int count, int one_third) {
+	int i = 0;
+#if defined(SCALE_AA_NEON)
+	for (; i + 4 <= count; i += 4) {
+		uint16x8_t a = vld1q_u16((const uint16_t*)(src + i));
+		uint16x8_t b = vld1q_u16((const uint16_t*)(next + i));
+		uint16x8_t avg = average16x8(a, b);
+		vst1q_u16((uint16_t*)(out + i), one_third ? average16x8(avg, b) : avg);
+	}
+#elif defined(SCALE_AA_SSE2)
+	for (; i + 4 <= count; i += 4) {
+		__m128i a = _mm_loadu_si128((const __m128i*)(src + i));
+		__m128i b = _mm_loadu_si128((const __m128i*)(next + i));
+		__m128i avg = average16x8(a, b);
+		_mm_storeu_si128((__m128i*)(out + i), one_third ? average16x8(avg, b) : avg);
+	}
+#endif
+	if (one_third) {
+		for (; i < count; i++)
+			out[i] = AVERAGE32_1_3(src[i], next[i]);
+	} else {
+		for (; i < count; i++)
+			out[i] = AVERAGE32(src[i], next[i]);
+	}
+}
+
+#endif // __SCALE_BLEND_H__
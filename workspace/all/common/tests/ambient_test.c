@@ -0,0 +1,310 @@
+// checks ambient_color.h: the vector row sampler against the scalar one,
+// and the phased ambientExtract against the full 7x7 grid version it
+// replaced. On a still frame the phased result has to match the full grid
+// exactly once every phase has been sampled, and stay close before that.
+//
+// The NEON or SSE2 row path is whatever this host builds, the scalar one
+// always runs.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ambient_color.h"
+
+// per channel, while the phases are still filling in. Only holds where a
+// single phase sees enough of the frame to stand in for all of it, so it
+// is only enforced from MIN_TOLERANCE_PIXELS up and not on FRAME_SPARSE,
+// where a sprite band can fall between one phase's rows entirely.
+#define TOLERANCE 12
+#define MIN_TOLERANCE_PIXELS (160 * 144)
+
+static int failures = 0;
+
+#define CHECK(cond, ...)              \
+	do {                              \
+		if (!(cond)) {                \
+			printf("  FAIL: ");       \
+			printf(__VA_ARGS__);      \
+			printf("\n");             \
+			if (++failures > 20)      \
+				exit(1);              \
+		}                             \
+	} while (0)
+
+///////////////////////////////
+
+// GFX_extract_average_color before it sampled in phases, verbatim apart
+// from keeping the blend history in a struct
+typedef struct ReferenceState {
+	uint16_t amb_prev_r;
+	uint16_t amb_prev_g;
+	uint16_t amb_prev_b;
+} ReferenceState;
+
+static uint32_t referenceExtract(ReferenceState* state, const void* data, unsigned width, unsigned height, size_t pitch) {
+	const uint32_t* pixels = (const uint32_t*)data;
+	int pixel_count = 0;
+
+	uint64_t total_r = 0;
+	uint64_t total_g = 0;
+	uint64_t total_b = 0;
+	uint64_t total_rcolor = 0;
+	uint64_t total_gcolor = 0;
+	uint64_t total_bcolor = 0;
+	uint32_t colorful_pixel_count = 0;
+
+	for (unsigned y = 0; y < height; y += 7) {
+		for (unsigned x = 0; x < width; x += 7) {
+			uint32_t pixel = pixels[y * (pitch / 4) + x];
+
+			uint8_t r = pixel & 0xFF;
+			uint8_t g = (pixel >> 8) & 0xFF;
+			uint8_t b = (pixel >> 16) & 0xFF;
+
+			uint8_t max_c = r > g ? r : g;
+			max_c = max_c > b ? max_c : b;
+
+			uint8_t min_c = r < g ? r : g;
+			min_c = min_c < b ? min_c : b;
+
+			uint8_t saturation = max_c == 0 ? 0 : (max_c - min_c) * 255 / max_c;
+
+			total_r += r;
+			total_g += g;
+			total_b += b;
+			pixel_count++;
+			if (saturation > 50 && max_c > 50) {
+				total_rcolor += r;
+				total_gcolor += g;
+				total_bcolor += b;
+				colorful_pixel_count++;
+			}
+		}
+	}
+
+	if (colorful_pixel_count > 0) {
+		total_r = total_rcolor;
+		total_g = total_gcolor;
+		total_b = total_bcolor;
+		pixel_count = colorful_pixel_count;
+	}
+
+	uint8_t ambient_r = total_r / pixel_count;
+	uint8_t ambient_g = total_g / pixel_count;
+	uint8_t ambient_b = total_b / pixel_count;
+
+	uint32_t average_color = (((state->amb_prev_r + ambient_r) / 2) << 16) |
+							 (((state->amb_prev_g + ambient_g) / 2) << 8) |
+							 ((state->amb_prev_b + ambient_b) / 2);
+
+	state->amb_prev_r = ambient_r;
+	state->amb_prev_g = ambient_g;
+	state->amb_prev_b = ambient_b;
+
+	return average_color;
+}
+
+///////////////////////////////
+
+// channel values around the colorful thresholds, mixed in with plain
+// random ones so the saturation and max_c > 50 edges get hit
+static const uint8_t edges[] = {0, 1, 10, 40, 41, 49, 50, 51, 52, 60, 61, 100, 127, 128, 200, 204, 254, 255};
+
+static uint8_t randomChannel(void) {
+	if (rand() & 1)
+		return edges[rand() % sizeof(edges)];
+	return rand() & 0xFF;
+}
+
+static uint32_t randomPixel(void) {
+	return (uint32_t)(rand() & 0xFF) << 24 | randomChannel() << 16 | randomChannel() << 8 | randomChannel();
+}
+
+static int sameSums(const AmbientSums* a, const AmbientSums* b) {
+	return memcmp(a, b, sizeof(AmbientSums)) == 0;
+}
+
+static void checkRows(void) {
+	static uint32_t row[1024];
+	for (unsigned width = 0; width <= 1024; width += width < 140 ? 1 : 61) {
+		for (int round = 0; round < 20; round++) {
+			for (unsigned x = 0; x < width; x++)
+				row[x] = randomPixel();
+
+			AmbientSums vector = {0};
+			AmbientSums scalar = {0};
+			ambientSampleRow(row, width, &vector);
+			ambientSampleRow_c(row, 0, width, &scalar);
+			CHECK(sameSums(&vector, &scalar), "row of %u: vector sums differ from scalar (count %u vs %u, colorful %u vs %u)",
+				  width, vector.count, scalar.count, vector.colorful, scalar.colorful);
+		}
+	}
+
+	// every level against every spread, one sampled pixel per spread
+	for (int v = 0; v < 256; v++) {
+		unsigned width = 64 * AMBIENT_STEP;
+		for (unsigned x = 0; x < width; x++) {
+			int spread = (x / AMBIENT_STEP) * 4;
+			uint32_t g = v > spread ? v - spread : 0;
+			uint32_t b = v > spread / 2 ? v - spread / 2 : 0;
+			row[x] = (uint32_t)v | g << 8 | b << 16;
+		}
+		AmbientSums vector = {0};
+		AmbientSums scalar = {0};
+		ambientSampleRow(row, width, &vector);
+		ambientSampleRow_c(row, 0, width, &scalar);
+		CHECK(sameSums(&vector, &scalar), "ramp at %i: vector sums differ from scalar", v);
+	}
+}
+
+///////////////////////////////
+
+typedef enum {
+	FRAME_NOISE,	 // every pixel random
+	FRAME_SCENE,	 // gradients and flat blocks with a bit of noise, closer to a game
+	FRAME_GREY,		 // nothing colorful, takes the plain average path
+	FRAME_DARK,		 // colorful hues but all below max_c > 50
+	FRAME_SPARSE,	 // mostly grey with a few colorful sprites
+	FRAME_KIND_COUNT,
+} FrameKind;
+
+static const char* kind_names[] = {"noise", "scene", "grey", "dark", "sparse"};
+
+static void fillFrame(uint32_t* pixels, unsigned width, unsigned height, size_t pitch, FrameKind kind) {
+	int bx = rand() % 64;
+	int by = rand() % 64;
+	for (unsigned y = 0; y < height; y++) {
+		uint32_t* row = (uint32_t*)((uint8_t*)pixels + y * pitch);
+		for (unsigned x = 0; x < width; x++) {
+			uint32_t r, g, b;
+			switch (kind) {
+			case FRAME_NOISE:
+				row[x] = randomPixel();
+				continue;
+			case FRAME_SCENE:
+				r = (x * 255 / (width ? width : 1) + rand() % 9) & 0xFF;
+				g = (y * 255 / (height ? height : 1) + rand() % 9) & 0xFF;
+				b = ((x + bx) / 16 + (y + by) / 16) & 1 ? 180 : 40;
+				break;
+			case FRAME_GREY:
+				r = g = b = (x + y + rand() % 5) & 0xFF;
+				break;
+			case FRAME_DARK:
+				r = rand() % 51;
+				g = rand() % 20;
+				b = rand() % 51;
+				break;
+			default:
+				if (((x + bx) % 40) < 6 && ((y + by) % 30) < 6) {
+					r = 220;
+					g = 40 + rand() % 20;
+					b = 30;
+				} else {
+					r = g = b = 90 + rand() % 10;
+				}
+				break;
+			}
+			row[x] = 0xFF000000 | b << 16 | g << 8 | r;
+		}
+	}
+}
+
+static int channelDistance(uint32_t a, uint32_t b) {
+	int worst = 0;
+	for (int shift = 0; shift < 24; shift += 8) {
+		int d = (int)((a >> shift) & 0xFF) - (int)((b >> shift) & 0xFF);
+		if (d < 0)
+			d = -d;
+		if (d > worst)
+			worst = d;
+	}
+	return worst;
+}
+
+// one still frame shown for a while: the blend on both sides settles to
+// the frame's own colour after a few calls, the phased one just needs
+// AMBIENT_PHASES calls before its sums cover the same grid
+static void checkStill(AmbientState* state, unsigned width, unsigned height, size_t pitch, FrameKind kind, int tolerance, int* worst) {
+	uint32_t* pixels = malloc(pitch * (height ? height : 1));
+	fillFrame(pixels, width, height, pitch, kind);
+
+	ReferenceState reference = {0};
+	for (int call = 0; call < AMBIENT_PHASES + 2; call++) {
+		uint32_t got = ambientExtract(state, pixels, width, height, pitch);
+		uint32_t expected = referenceExtract(&reference, pixels, width, height, pitch);
+
+		// all phases are in after AMBIENT_PHASES calls, but the blend still
+		// carries the last partial value into that call, so the output only
+		// has to be exact on the one after
+		if (call == AMBIENT_PHASES + 1) {
+			CHECK(got == expected, "%s %ux%u pitch %zu: call %i got %06x, full grid %06x",
+				  kind_names[kind], width, height, pitch, call, got, expected);
+		} else {
+			int d = channelDistance(got, expected);
+			if (d > *worst)
+				*worst = d;
+			CHECK(tolerance < 0 || d <= tolerance, "%s %ux%u pitch %zu: call %i got %06x, full grid %06x (off by %i)",
+				  kind_names[kind], width, height, pitch, call, got, expected, d);
+		}
+	}
+	free(pixels);
+}
+
+static void checkFrames(void) {
+	static const unsigned sizes[][2] = {
+		{1, 1}, {6, 6}, {7, 7}, {8, 29}, {57, 29}, {160, 144}, {256, 224}, {256, 240}, {320, 240}, {512, 448}, {640, 480},
+	};
+	for (int kind = 0; kind < FRAME_KIND_COUNT; kind++) {
+		int worst = 0;
+		int worst_small = 0;
+		for (int s = 0; s < (int)(sizeof(sizes) / sizeof(sizes[0])); s++) {
+			unsigned width = sizes[s][0];
+			unsigned height = sizes[s][1];
+			// tight pitch, and a padded one like a core's framebuffer
+			for (int pad = 0; pad <= 1; pad++) {
+				size_t pitch = (width + pad * 13) * sizeof(uint32_t);
+				// fresh state each time so the blend history matches the reference
+				AmbientState state = {0};
+				if (width * height >= MIN_TOLERANCE_PIXELS)
+					checkStill(&state, width, height, pitch, kind, kind == FRAME_SPARSE ? -1 : TOLERANCE, &worst);
+				else
+					checkStill(&state, width, height, pitch, kind, -1, &worst_small);
+			}
+		}
+		printf("%-7s frames: exact after %i calls, off by at most %i before that (%i on tiny frames)%s\n",
+			   kind_names[kind], AMBIENT_PHASES + 2, worst, worst_small, kind == FRAME_SPARSE ? ", not enforced" : "");
+	}
+
+	// a size change has to drop the sums of the old size, otherwise a
+	// 320x240 menu would leak into the first frames of a 160x144 game
+	AmbientState used = {0};
+	int worst = 0;
+	checkStill(&used, 320, 240, 320 * 4, FRAME_SCENE, TOLERANCE, &worst);
+	used.prev_r = used.prev_g = used.prev_b = 0;
+	AmbientState fresh = {0};
+
+	uint32_t* pixels = malloc(160 * 144 * 4);
+	fillFrame(pixels, 160, 144, 160 * 4, FRAME_SPARSE);
+	for (int call = 0; call < AMBIENT_PHASES; call++) {
+		uint32_t got = ambientExtract(&used, pixels, 160, 144, 160 * 4);
+		uint32_t expected = ambientExtract(&fresh, pixels, 160, 144, 160 * 4);
+		CHECK(got == expected, "after a size change: call %i got %06x, fresh state %06x", call, got, expected);
+	}
+	free(pixels);
+	printf("size change: old sums dropped\n");
+}
+
+int main(void) {
+	srand(25);
+	checkRows();
+	printf("rows: vector and scalar sums match\n");
+	checkFrames();
+
+	if (failures) {
+		printf("%i failures\n", failures);
+		return 1;
+	}
+	printf("ok\n");
+	return 0;
+}
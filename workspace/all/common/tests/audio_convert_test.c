@@ -0,0 +1,184 @@
+// Checks that AUDIO_s16ToFloat and AUDIO_floatToS16 match their scalar
+// _c references bit for bit: every int16 value, floats either side of
+// +-1.0 and of the -32768 clamp, and every count up to a couple of vector
+// widths at every alignment (so the scalar tail runs and nothing is
+// written past the end). Also pins the few values the rest of the audio
+// path relies on.
+//
+//	make audio_convert_test && ./audio_convert_test
+
+#include <float.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "audio_convert.h"
+
+#define ALL_S16 65536
+#define MAX_COUNT 17
+#define CANARY 0x5A5A
+
+static int failed = 0;
+
+#define CHECK(cond, ...)         \
+	do {                         \
+		if (!(cond)) {           \
+			printf("  FAIL: ");  \
+			printf(__VA_ARGS__); \
+			printf("\n");        \
+			if (++failed > 20)   \
+				exit(1);         \
+		}                        \
+	} while (0)
+
+static int sameFloat(float a, float b) {
+	return memcmp(&a, &b, sizeof(float)) == 0;
+}
+
+static void checkS16ToFloat(void) {
+	static int16_t in[ALL_S16];
+	static float out[ALL_S16];
+	static float expect[ALL_S16];
+	for (int i = 0; i < ALL_S16; i++)
+		in[i] = (int16_t)(i - 32768);
+
+	AUDIO_s16ToFloat(in, out, ALL_S16);
+	AUDIO_s16ToFloat_c(in, expect, ALL_S16);
+	for (int i = 0; i < ALL_S16; i++)
+		CHECK(sameFloat(out[i], expect[i]), "s16ToFloat(%d) = %a, expected %a", in[i], out[i], expect[i]);
+
+	CHECK(out[0] == -1.0f, "s16ToFloat(-32768) = %a, expected -1", out[0]);
+	CHECK(out[32768] == 0.0f, "s16ToFloat(0) = %a, expected 0", out[32768]);
+	CHECK(out[ALL_S16 - 1] < 1.0f, "s16ToFloat(32767) = %a, expected below 1", out[ALL_S16 - 1]);
+	printf("s16ToFloat: all %d int16 values\n", ALL_S16);
+}
+
+// floats either side of value, up to ulps steps away
+static int around(float value, int ulps, float* out) {
+	int n = 0;
+	float below = value;
+	float above = value;
+	out[n++] = value;
+	for (int i = 0; i < ulps; i++) {
+		below = nextafterf(below, -INFINITY);
+		above = nextafterf(above, INFINITY);
+		out[n++] = below;
+		out[n++] = above;
+	}
+	return n;
+}
+
+static void checkFloatToS16(void) {
+	// every int16 back again, then the edges the clamps and truncation care about
+	static float in[ALL_S16 + 4096];
+	static int16_t out[ALL_S16 + 4096];
+	static int16_t expect[ALL_S16 + 4096];
+	int count = 0;
+	for (int i = 0; i < ALL_S16; i++)
+		in[count++] = (i - 32768) / 32768.0f;
+
+	static const float edges[] = {
+		1.0f, -1.0f,
+		32767.0f / 32767.0f, -32767.0f / 32767.0f,
+		-32768.0f / 32767.0f, // the one value only the negative clamp lets through
+		0.5f / 32767.0f, -0.5f / 32767.0f, // truncate toward zero, not round
+		1.5f / 32767.0f, -1.5f / 32767.0f,
+		0.0f, -0.0f,
+	};
+	for (int e = 0; e < (int)(sizeof(edges) / sizeof(edges[0])); e++)
+		count += around(edges[e], 64, &in[count]);
+
+	// way out of range, still finite
+	static const float wild[] = {2.0f, -2.0f, 1000.0f, -1000.0f, 1e30f, -1e30f, FLT_MAX, -FLT_MAX, FLT_MIN, -FLT_MIN};
+	for (int w = 0; w < (int)(sizeof(wild) / sizeof(wild[0])); w++)
+		in[count++] = wild[w];
+
+	AUDIO_floatToS16(in, out, count);
+	AUDIO_floatToS16_c(in, expect, count);
+	for (int i = 0; i < count; i++)
+		CHECK(out[i] == expect[i], "floatToS16(%a) = %d, expected %d", in[i], out[i], expect[i]);
+
+	// what the scalar reference promises, pinned so a change there shows up too
+	static const struct {
+		float in;
+		int16_t out;
+	} pinned[] = {
+		{1.0f, 32767},
+		{-1.0f, -32767},
+		{-32768.0f / 32767.0f, -32768},
+		{2.0f, 32767},
+		{-2.0f, -32768},
+		{FLT_MAX, 32767},
+		{-FLT_MAX, -32768},
+		{0.5f / 32767.0f, 0},
+		{-0.5f / 32767.0f, 0},
+		{1.5f / 32767.0f, 1},
+		{-1.5f / 32767.0f, -1},
+	};
+	for (int p = 0; p < (int)(sizeof(pinned) / sizeof(pinned[0])); p++) {
+		float in8[8];
+		int16_t out8[8];
+		for (int i = 0; i < 8; i++)
+			in8[i] = pinned[p].in; // a full vector so the vector path is the one pinned
+		AUDIO_floatToS16(in8, out8, 8);
+		CHECK(out8[0] == pinned[p].out, "floatToS16(%a) = %d, expected %d", pinned[p].in, out8[0], pinned[p].out);
+	}
+	printf("floatToS16: %d values, every int16 and around +-1.0 and -32768\n", count);
+}
+
+// every count up to MAX_COUNT at every offset into the buffers, with a
+// canary after the last sample
+static void checkCounts(void) {
+	int16_t s16[MAX_COUNT + 8];
+	float floats[MAX_COUNT + 8];
+	float float_expect[MAX_COUNT + 8];
+	int16_t s16_out[MAX_COUNT + 8];
+	int16_t s16_expect[MAX_COUNT + 8];
+	srand(3);
+
+	for (int count = 0; count <= MAX_COUNT; count++) {
+		for (int offset = 0; offset < 4; offset++) {
+			for (int i = 0; i < MAX_COUNT + 8; i++) {
+				s16[i] = (int16_t)rand();
+				floats[i] = ((float)rand() / RAND_MAX) * 2.2f - 1.1f;
+			}
+
+			float canary_float = -1234.5f;
+			for (int i = 0; i < MAX_COUNT + 8; i++)
+				float_expect[i] = canary_float;
+			AUDIO_s16ToFloat_c(s16 + offset, float_expect + offset, count);
+			float float_out[MAX_COUNT + 8];
+			for (int i = 0; i < MAX_COUNT + 8; i++)
+				float_out[i] = canary_float;
+			AUDIO_s16ToFloat(s16 + offset, float_out + offset, count);
+			CHECK(memcmp(float_out, float_expect, sizeof(float_out)) == 0, "s16ToFloat count:%d offset:%d differs or overran", count, offset);
+
+			for (int i = 0; i < MAX_COUNT + 8; i++)
+				s16_out[i] = s16_expect[i] = CANARY;
+			AUDIO_floatToS16_c(floats + offset, s16_expect + offset, count);
+			AUDIO_floatToS16(floats + offset, s16_out + offset, count);
+			CHECK(memcmp(s16_out, s16_expect, sizeof(s16_out)) == 0, "floatToS16 count:%d offset:%d differs or overran", count, offset);
+		}
+	}
+	printf("counts: 0..%d at offsets 0..3\n", MAX_COUNT);
+}
+
+int main(void) {
+#if defined(AUDIO_CONVERT_NEON)
+	printf("NEON conversion\n");
+#elif defined(AUDIO_CONVERT_SSE2)
+	printf("SSE2 conversion\n");
+#else
+	printf("scalar conversion\n");
+#endif
+	checkS16ToFloat();
+	checkFloatToS16();
+	checkCounts();
+
+	if (failed)
+		printf("%d failures\n", failed);
+	else
+		printf("ok\n");
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,72 @@
+// Checks that blendLines matches AVERAGE32 / AVERAGE32_1_3 bit for bit,
+// for every pair count up to a few vector widths (so odd counts run the
+// scalar tail) and for every rgb565 value against a spread of partners.
+//
+//	make blend_test && ./blend_test
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "scale_blend.h"
+
+#define MAX_COUNT 37
+
+static uint32_t rand32(void) {
+	return ((uint32_t)rand() << 16) ^ (uint32_t)rand();
+}
+
+static int checkLines(const uint32_t* src, const uint32_t* next, int count) {
+	uint32_t out[MAX_COUNT + 1];
+	int failed = 0;
+	for (int one_third = 0; one_third <= 1; one_third++) {
+		out[count] = 0xDEADBEEF;
+		blendLines(out, src, next, count, one_third);
+		for (int i = 0; i < count; i++) {
+			uint32_t expect = one_third ? AVERAGE32_1_3(src[i], next[i]) : AVERAGE32(src[i], next[i]);
+			if (out[i] != expect) {
+				if (failed++ < 8)
+					printf("FAIL count:%d one_third:%d [%d] %08x %08x -> %08x, expected %08x\n", count, one_third, i, src[i], next[i], out[i], expect);
+			}
+		}
+		if (out[count] != 0xDEADBEEF) {
+			printf("FAIL count:%d one_third:%d wrote past the end\n", count, one_third);
+			failed++;
+		}
+	}
+	return failed;
+}
+
+int main(void) {
+	uint32_t src[MAX_COUNT];
+	uint32_t next[MAX_COUNT];
+	int failed = 0;
+	srand(1);
+
+	// random lines, plus some equal pairs for the a == b shortcut in the macros
+	for (int count = 0; count <= MAX_COUNT; count++) {
+		for (int round = 0; round < 200; round++) {
+			for (int i = 0; i < count; i++) {
+				src[i] = rand32();
+				next[i] = (rand() & 3) ? rand32() : src[i];
+			}
+			failed += checkLines(src, next, count);
+		}
+	}
+
+	// every 16 bit value in both halves of the pair, against random partners
+	// and the ones that set every carry
+	for (uint32_t a = 0; a <= 0xFFFF; a++) {
+		for (int i = 0; i < MAX_COUNT; i++) {
+			uint32_t b = i == 0 ? 0xFFFF : i == 1 ? (a ^ 0xFFFF) : (rand32() & 0xFFFF);
+			src[i] = (i & 1) ? (a << 16) | b : (b << 16) | a;
+			next[i] = (i & 1) ? (b << 16) | a : (a << 16) | b;
+		}
+		failed += checkLines(src, next, MAX_COUNT);
+	}
+
+	if (failed)
+		printf("%d mismatches\n", failed);
+	else
+		printf("blendLines matches AVERAGE32 / AVERAGE32_1_3\n");
+	return failed ? 1 : 0;
+}
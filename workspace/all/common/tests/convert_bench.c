@@ -0,0 +1,159 @@
+// checks the frame converters in pixel_convert.h against a per pixel
+// reference (odd widths and padded pitches included, so the row tails
+// run), then reports ns per frame converting 320x240, 640x480 and
+// 1280x720 frames from XRGB8888 and RGB565, the two formats cores hand
+// minarch.
+//
+//	./convert_bench [seconds per size]
+//
+// Whatever the host builds is timed: NEON on arm, the unrolled scalar
+// loop elsewhere. Exits non zero if a conversion doesn't match.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "pixel_convert.h"
+
+static const int sizes[][2] = {
+	{320, 240},
+	{640, 480},
+	{1280, 720},
+};
+
+static double now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static uint32_t referenceXrgb8888(uint32_t pixel) {
+	uint32_t r = (pixel >> 16) & 0xFF;
+	uint32_t g = (pixel >> 8) & 0xFF;
+	uint32_t b = pixel & 0xFF;
+	return 0xFF000000 | b << 16 | g << 8 | r;
+}
+
+static uint32_t referenceRgb565(uint16_t pixel) {
+	// widen by repeating the top bits into the new low ones
+	uint32_t r = (pixel >> 11) & 0x1F;
+	uint32_t g = (pixel >> 5) & 0x3F;
+	uint32_t b = pixel & 0x1F;
+	r = r << 3 | r >> 2;
+	g = g << 2 | g >> 4;
+	b = b << 3 | b >> 2;
+	return 0xFF000000 | b << 16 | g << 8 | r;
+}
+
+typedef void (*convert_t)(const void* src, uint32_t* dst, unsigned width, unsigned height, size_t pitch);
+
+typedef struct Format {
+	const char* name;
+	int bpp;
+	convert_t convert;
+} Format;
+
+static const Format formats[] = {
+	{"XRGB8888", 4, convert_xrgb8888_to_rgba},
+	{"RGB565", 2, convert_rgb565_to_rgba},
+};
+
+static uint32_t reference(const Format* f, const uint8_t* row, unsigned x) {
+	if (f->bpp == 4) {
+		uint32_t pixel;
+		memcpy(&pixel, row + x * 4, 4);
+		return referenceXrgb8888(pixel);
+	}
+	uint16_t pixel;
+	memcpy(&pixel, row + x * 2, 2);
+	return referenceRgb565(pixel);
+}
+
+static int check(const Format* f, unsigned width, unsigned height, unsigned pad) {
+	size_t pitch = (width + pad) * f->bpp;
+	uint8_t* src = malloc(pitch * height + 1);
+	uint32_t* dst = malloc(((size_t)width * height + 1) * sizeof(uint32_t));
+	for (size_t i = 0; i < pitch * height; i++)
+		src[i] = rand();
+	dst[width * height] = 0xA5A5A5A5;
+
+	f->convert(src, dst, width, height, pitch);
+
+	int ok = 1;
+	for (unsigned y = 0; y < height && ok; y++) {
+		for (unsigned x = 0; x < width; x++) {
+			if (dst[y * width + x] != reference(f, src + y * pitch, x)) {
+				printf("FAIL %s %ux%u pad %u at %u,%u: %08x, expected %08x\n",
+					   f->name, width, height, pad, x, y, dst[y * width + x], reference(f, src + y * pitch, x));
+				ok = 0;
+				break;
+			}
+		}
+	}
+	if (ok && dst[width * height] != 0xA5A5A5A5) {
+		printf("FAIL %s %ux%u pad %u: wrote past the frame\n", f->name, width, height, pad);
+		ok = 0;
+	}
+	free(src);
+	free(dst);
+	return ok;
+}
+
+static double bench(const Format* f, unsigned width, unsigned height, double seconds) {
+	size_t pitch = width * f->bpp;
+	uint8_t* src = malloc(pitch * height);
+	uint32_t* dst = malloc((size_t)width * height * sizeof(uint32_t));
+	for (size_t i = 0; i < pitch * height; i++)
+		src[i] = rand();
+
+	f->convert(src, dst, width, height, pitch); // fault the pages in
+	int frames = 0;
+	double start = now();
+	double elapsed = 0.0;
+	do {
+		f->convert(src, dst, width, height, pitch);
+		frames++;
+		elapsed = now() - start;
+	} while (elapsed < seconds);
+
+	free(src);
+	free(dst);
+	return elapsed / frames * 1e9;
+}
+
+int main(int argc, char* argv[]) {
+	double seconds = argc > 1 ? atof(argv[1]) : 0.5;
+	int failed = 0;
+	srand(23);
+
+#if defined(__ARM_NEON) || defined(__aarch64__)
+	printf("NEON conversion\n");
+#else
+	printf("scalar conversion\n");
+#endif
+	for (int i = 0; i < (int)(sizeof(formats) / sizeof(formats[0])); i++) {
+		const Format* f = &formats[i];
+		int ok = 1;
+		for (unsigned width = 1; width <= 19; width++) {
+			for (unsigned pad = 0; pad <= 3; pad += 3)
+				ok &= check(f, width, 3, pad);
+		}
+		for (int s = 0; s < (int)(sizeof(sizes) / sizeof(sizes[0])); s++)
+			ok &= check(f, sizes[s][0], sizes[s][1], 32);
+		if (!ok)
+			failed++;
+
+		for (int s = 0; s < (int)(sizeof(sizes) / sizeof(sizes[0])); s++) {
+			unsigned width = sizes[s][0];
+			unsigned height = sizes[s][1];
+			double ns = bench(f, width, height, seconds);
+			printf("%-8s %4ux%-4u %s %10.0f ns/frame %8.2f ns/pixel\n",
+				   f->name, width, height, ok ? "ok  " : "FAIL", ns, ns / (width * height));
+		}
+	}
+
+	if (failed)
+		printf("%d formats FAILED\n", failed);
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,146 @@
+// drives the frame pacer from frame_pacing.h the way GFX_flip_fixed_rate
+// does (a bit of simulated frame work, then a wait for the next absolute
+// frame deadline) at 50, 60 and 75Hz, and prints how late each wait came
+// back and how much cpu the waits burned, for the learned wake margin as
+// well as a fixed 2ms spin and a plain sleep to compare against.
+//
+//	./pacing_bench [seconds per run] [min_us max_us slack_us]
+//
+// The optional margins override WAKE_MARGIN_MIN/MAX/SLACK for the learned
+// run, to recheck the tuning. Exits non zero if a wait ever returns before
+// its deadline.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "frame_pacing.h"
+
+#define WORK_MIN 0.2 // of the frame budget, picked at random per frame
+#define WORK_MAX 0.7
+
+static const double rates[] = {50.0, 60.0, 75.0};
+
+typedef struct Mode {
+	const char* name;
+	int64_t min_ns; // -1 keeps the default
+	int64_t max_ns;
+	int64_t slack_ns;
+} Mode;
+
+static Mode modes[] = {
+	{"learned", -1, -1, -1},
+	{"fixed 2ms spin", 2000000LL, 2000000LL, 0},
+	{"sleep only", 0, 0, 0},
+};
+
+static int64_t threadCpu(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+	return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static void spinUntil(int64_t until) {
+	while (GFX_pacerNow() < until) {
+		// nothing...
+	}
+}
+
+static int compareLateness(const void* a, const void* b) {
+	int64_t x = *(const int64_t*)a;
+	int64_t y = *(const int64_t*)b;
+	return x < y ? -1 : x > y;
+}
+
+// returns 0 if a wait came back early
+static int run(const Mode* mode, double hz, double seconds) {
+	GFX_Pacer pacer;
+	GFX_pacerInit(&pacer);
+	if (mode->min_ns >= 0)
+		pacer.min_ns = mode->min_ns;
+	if (mode->max_ns >= 0)
+		pacer.max_ns = mode->max_ns;
+	if (mode->slack_ns >= 0)
+		pacer.slack_ns = mode->slack_ns;
+	if (pacer.wake_margin_ns > pacer.max_ns)
+		pacer.wake_margin_ns = pacer.max_ns;
+
+	int64_t frame_duration = (int64_t)(1e9 / hz);
+	int frames = (int)(seconds * hz);
+	if (frames < 1)
+		frames = 1;
+	int64_t* lateness = malloc(frames * sizeof(int64_t));
+
+	int early = 0;
+	int missed = 0;
+	int64_t wait_cpu = 0;
+	int64_t wait_wall = 0;
+	int64_t start = GFX_pacerNow();
+
+	for (int i = 0; i < frames; i++) {
+		int64_t deadline = start + (int64_t)(i + 1) * frame_duration;
+		double work = WORK_MIN + (WORK_MAX - WORK_MIN) * rand() / RAND_MAX;
+		spinUntil(GFX_pacerNow() + (int64_t)(work * frame_duration));
+
+		int64_t before = GFX_pacerNow();
+		int64_t before_cpu = threadCpu();
+		if (before >= deadline)
+			missed += 1;
+		else
+			GFX_pacerWait(&pacer, deadline);
+		int64_t after = GFX_pacerNow();
+		wait_cpu += threadCpu() - before_cpu;
+		wait_wall += after - before;
+
+		lateness[i] = after - deadline;
+		if (lateness[i] < 0)
+			early += 1;
+		if (lateness[i] > frame_duration) {
+			// way behind, resync like GFX_flip_fixed_rate does
+			start = after - (int64_t)(i + 1) * frame_duration;
+		}
+	}
+
+	double sum = 0.0;
+	for (int i = 0; i < frames; i++)
+		sum += lateness[i];
+	qsort(lateness, frames, sizeof(int64_t), compareLateness);
+
+	printf("%5.0fHz  %-15s %9.1f %9.1f %9.1f %8.1f%% %8.1f %6i\n",
+		   hz,
+		   mode->name,
+		   sum / frames / 1000.0,
+		   lateness[(int)(frames * 0.99)] / 1000.0,
+		   lateness[frames - 1] / 1000.0,
+		   wait_wall ? 100.0 * wait_cpu / wait_wall : 0.0,
+		   pacer.wake_margin_ns / 1000.0,
+		   missed);
+
+	free(lateness);
+	if (early)
+		printf("  %i waits returned before their deadline\n", early);
+	return !early;
+}
+
+int main(int argc, char** argv) {
+	double seconds = argc > 1 ? atof(argv[1]) : 3.0;
+	if (argc > 4) {
+		modes[0].min_ns = atoll(argv[2]) * 1000LL;
+		modes[0].max_ns = atoll(argv[3]) * 1000LL;
+		modes[0].slack_ns = atoll(argv[4]) * 1000LL;
+	}
+
+	printf("learned margin: min %lldus max %lldus slack %lldus\n\n",
+		   (long long)(modes[0].min_ns >= 0 ? modes[0].min_ns : WAKE_MARGIN_MIN_NS) / 1000,
+		   (long long)(modes[0].max_ns >= 0 ? modes[0].max_ns : WAKE_MARGIN_MAX_NS) / 1000,
+		   (long long)(modes[0].slack_ns >= 0 ? modes[0].slack_ns : WAKE_MARGIN_SLACK_NS) / 1000);
+	printf("%7s  %-15s %9s %9s %9s %9s %8s %6s\n",
+		   "rate", "wait", "avg us", "p99 us", "max us", "cpu", "margin", "missed");
+
+	int ok = 1;
+	for (int r = 0; r < (int)(sizeof(rates) / sizeof(rates[0])); r++) {
+		for (int m = 0; m < (int)(sizeof(modes) / sizeof(modes[0])); m++)
+			ok &= run(&modes[m], rates[r], seconds);
+	}
+	return !ok;
+}
@@ -0,0 +1,14 @@
+#ifndef PLATFORM_H
+#define PLATFORM_H
+
+// Stand-in for workspace/<platform>/platform/platform.h so the pure C parts
+// of common/ can be built into desktop tests without SDL. Only define what
+// those sources actually use.
+
+#if defined(__arm__) && defined(__ARM_NEON)
+#define HAS_NEON // the NEON scalers are ARMv7 inline asm
+#endif
+
+#define FIXED_BPP 2
+
+#endif // PLATFORM_H
@@ -0,0 +1,361 @@
+// resamples stepped sine sweeps through the built-in polyphase resampler
+// (audio_polyphase.h) and the libsamplerate converters the frontend offers,
+// and prints SNR (signal to noise and distortion) and THD for each tone,
+// then the time each soundQuality level takes to resample one video frame's
+// worth of audio.
+//
+//	./resampler_bench [seconds per tone]
+//
+// Input is fed in video frame sized batches the same way SND_batchSamples()
+// does, so the polyphase path carries its read position across batches
+// like it does on device. Exits non zero if the polyphase SNR drops below
+// POLY_SNR_FLOOR anywhere in the passband.
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <samplerate.h>
+
+#include "audio_convert.h"
+#include "audio_polyphase.h"
+
+#define AMPLITUDE 0.5 // -6dBFS, leaves room for the filter ripple
+#define SETTLE 0.1	  // seconds trimmed from both ends of the output
+#define MAX_HARMONIC 5
+#define POLY_SNR_FLOOR 60.0 // dB, for tones below 80% of the polyphase cutoff
+#define TIMING_SECONDS 0.25 // minimum wall time per level and case
+
+typedef struct Case {
+	const char* name;
+	int in_rate;
+	int out_rate;
+	double ratio; // dynamic rate control adjustment
+} Case;
+
+static const Case cases[] = {
+	{"32040 -> 48000", 32040, 48000, 1.0},
+	{"44100 -> 48000", 44100, 48000, 1.0},
+	{"48000 -> 48000 -0.5%", 48000, 48000, 0.995},
+	{"48000 -> 48000 +0.5%", 48000, 48000, 1.005},
+};
+
+static const double tones[] = {100, 440, 1000, 2500, 5000, 8000, 10000, 12000, 14000, 16000, 18000, 20000};
+
+typedef struct Level {
+	const char* name; // frontend label (resample_labels in minarch.c) and converter
+	int type; // libsamplerate converter type, -1 for polyphase
+} Level;
+
+// index is the soundQuality option value, same order as qualityLevels in api.c
+static const Level levels[] = {
+	{"Low (zoh)", SRC_ZERO_ORDER_HOLD},
+	{"Medium (linear)", SRC_LINEAR},
+	{"High (fastest)", SRC_SINC_FASTEST},
+	{"Max (medium)", SRC_SINC_MEDIUM_QUALITY},
+	{"Low Power (poly)", -1},
+};
+#define LEVEL_COUNT (int)(sizeof(levels) / sizeof(levels[0]))
+
+///////////////////////////////
+
+static int resamplePolyphase(const SND_Frame* in, int in_count, int batch, const Case* c, SND_Frame* out, int out_size) {
+	SND_Polyphase poly = {0};
+	double final_ratio = ((double)c->out_rate / c->in_rate) * c->ratio;
+	if (!SND_polyphaseInit(&poly, SND_polyphaseCutoff(c->in_rate, c->out_rate)))
+		return -1;
+	uint64_t step = SND_polyphaseStep(final_ratio);
+
+	int produced = 0;
+	for (int i = 0; i < in_count; i += batch) {
+		int count = in_count - i < batch ? in_count - i : batch;
+		if (!SND_polyphasePush(&poly, &in[i], count))
+			break;
+		produced += SND_polyphaseProcess(&poly, &out[produced], out_size - produced, step);
+		SND_polyphaseCompact(&poly);
+	}
+	SND_polyphaseQuit(&poly);
+	return produced;
+}
+
+static int resampleSrc(const SND_Frame* in, int in_count, int batch, const Case* c, int type, SND_Frame* out, int out_size) {
+	int error;
+	SRC_STATE* state = src_new(type, 2, &error);
+	if (!state) {
+		fprintf(stderr, "src_new: %s\n", src_strerror(error));
+		return -1;
+	}
+	double final_ratio = ((double)c->out_rate / c->in_rate) * c->ratio;
+	int max_out = (int)(batch * final_ratio + 1);
+	float* input = malloc(batch * 2 * sizeof(float));
+	float* output = malloc(max_out * 2 * sizeof(float));
+
+	int produced = 0;
+	for (int i = 0; i < in_count; i += batch) {
+		int count = in_count - i < batch ? in_count - i : batch;
+		AUDIO_s16ToFloat((const int16_t*)&in[i], input, count * 2);
+		SRC_DATA data = {
+			.data_in = input,
+			.data_out = output,
+			.input_frames = count,
+			.output_frames = max_out,
+			.src_ratio = final_ratio,
+			.end_of_input = 0};
+		if (src_process(state, &data) != 0) {
+			fprintf(stderr, "src_process: %s\n", src_strerror(src_error(state)));
+			break;
+		}
+		int gen = (int)data.output_frames_gen;
+		if (gen > out_size - produced)
+			gen = out_size - produced;
+		AUDIO_floatToS16(output, (int16_t*)&out[produced], gen * 2);
+		produced += gen;
+	}
+
+	free(input);
+	free(output);
+	src_delete(state);
+	return produced;
+}
+
+static double now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// ns per batch (one video frame of audio), the s16 <-> float conversion
+// the libsamplerate path needs included
+static double timeLevel(const SND_Frame* in, int in_count, int batch, const Case* c, int type, SND_Frame* out, int out_size) {
+	int runs = 0;
+	double start = now();
+	double elapsed = 0.0;
+	do {
+		int count = type < 0
+						? resamplePolyphase(in, in_count, batch, c, out, out_size)
+						: resampleSrc(in, in_count, batch, c, type, out, out_size);
+		if (count < 0)
+			return -1.0;
+		runs++;
+		elapsed = now() - start;
+	} while (elapsed < TIMING_SECONDS);
+
+	int batches = (in_count + batch - 1) / batch;
+	return elapsed / runs / batches * 1e9;
+}
+
+///////////////////////////////
+
+#define MAX_PARAMS (2 * MAX_HARMONIC + 1)
+
+// joint least squares fit of the fundamental at w, its harmonics 2..harmonics
+// and dc. amplitudes[h - 1] is the amplitude of harmonic h, returns the
+// residual energy (everything that is neither the tone nor its harmonics).
+// fitting them together matters, fitted one at a time over a non integer
+// number of cycles the fundamental leaks into the harmonics.
+static double fitTones(const int16_t* x, int stride, int count, double w, int harmonics, double* amplitudes) {
+	int params = 2 * harmonics + 1;
+	double m[MAX_PARAMS][MAX_PARAMS + 1];
+	memset(m, 0, sizeof(m));
+
+	double v[MAX_PARAMS];
+	for (int n = 0; n < count; n++) {
+		for (int h = 0; h < harmonics; h++) {
+			v[2 * h] = cos((h + 1) * w * n);
+			v[2 * h + 1] = sin((h + 1) * w * n);
+		}
+		v[params - 1] = 1.0;
+		double s = x[n * stride];
+		for (int i = 0; i < params; i++) {
+			for (int j = i; j < params; j++)
+				m[i][j] += v[i] * v[j];
+			m[i][params] += v[i] * s;
+		}
+	}
+	for (int i = 0; i < params; i++)
+		for (int j = 0; j < i; j++)
+			m[i][j] = m[j][i];
+
+	// gaussian elimination, symmetric positive definite so no pivoting
+	for (int i = 0; i < params; i++) {
+		for (int k = i + 1; k < params; k++) {
+			double f = m[k][i] / m[i][i];
+			for (int j = i; j <= params; j++)
+				m[k][j] -= f * m[i][j];
+		}
+	}
+	double p[MAX_PARAMS];
+	for (int i = params - 1; i >= 0; i--) {
+		double s = m[i][params];
+		for (int j = i + 1; j < params; j++)
+			s -= m[i][j] * p[j];
+		p[i] = s / m[i][i];
+	}
+
+	for (int h = 0; h < harmonics; h++)
+		amplitudes[h] = sqrt(p[2 * h] * p[2 * h] + p[2 * h + 1] * p[2 * h + 1]);
+
+	double noise = 0.0;
+	for (int n = 0; n < count; n++) {
+		double fit = p[params - 1];
+		for (int h = 0; h < harmonics; h++)
+			fit += p[2 * h] * cos((h + 1) * w * n) + p[2 * h + 1] * sin((h + 1) * w * n);
+		double r = x[n * stride] - fit;
+		noise += r * r;
+	}
+	return noise;
+}
+
+typedef struct Result {
+	double snr; // dB, signal to noise and distortion
+	double thd; // dB relative to the fundamental
+	int harmonics; // that fit below nyquist, 0 means no THD
+} Result;
+
+static Result analyze(const int16_t* samples, int count, int out_rate, double w) {
+	Result result = {0};
+	int skip = (int)(SETTLE * out_rate);
+	const int16_t* x = samples + skip * 2;
+	int n = count - 2 * skip;
+
+	int harmonics = 1;
+	while (harmonics < MAX_HARMONIC && (harmonics + 1) * w < M_PI * 0.98)
+		harmonics += 1;
+
+	double amplitudes[MAX_HARMONIC];
+	double noise = fitTones(x, 2, n, w, harmonics, amplitudes);
+
+	double distortion = 0.0;
+	for (int h = 1; h < harmonics; h++)
+		distortion += amplitudes[h] * amplitudes[h];
+
+	double fundamental = amplitudes[0] * amplitudes[0];
+	noise += distortion / 2.0 * n;
+	result.snr = 10.0 * log10(fundamental / 2.0 * n / (noise > 1e-9 ? noise : 1e-9));
+	result.harmonics = harmonics - 1;
+	if (result.harmonics)
+		result.thd = 10.0 * log10((distortion > 1e-18 ? distortion : 1e-18) / fundamental);
+	return result;
+}
+
+///////////////////////////////
+
+int main(int argc, char** argv) {
+	double seconds = argc > 1 ? atof(argv[1]) : 1.0;
+	if (seconds < 5 * SETTLE)
+		seconds = 5 * SETTLE; // leaves at least 3 * SETTLE to analyze
+
+	int failed = 0;
+	for (int ci = 0; ci < (int)(sizeof(cases) / sizeof(cases[0])); ci++) {
+		const Case* c = &cases[ci];
+		double final_ratio = ((double)c->out_rate / c->in_rate) * c->ratio;
+		int in_count = (int)(seconds * c->in_rate);
+		int out_size = (int)(in_count * final_ratio) + 64;
+		int batch = c->in_rate / 60;
+		double passband = SND_polyphaseCutoff(c->in_rate, c->out_rate) * c->in_rate / 2.0 * 0.8;
+		double nyquist = (c->in_rate < c->out_rate ? c->in_rate : c->out_rate) / 2.0;
+
+		SND_Frame* in = malloc(in_count * sizeof(SND_Frame));
+		SND_Frame* out = malloc(out_size * sizeof(SND_Frame));
+
+		printf("%s (batches of %i frames)\n", c->name, batch);
+		printf("%8s", "tone Hz");
+		for (int k = 0; k < LEVEL_COUNT; k++)
+			printf(" | %-19s", levels[k].name);
+		printf("\n%8s", "");
+		for (int k = 0; k < LEVEL_COUNT; k++)
+			printf(" | %8s  %8s", "SNR dB", "THD dB");
+		printf("\n");
+
+		for (int ti = 0; ti < (int)(sizeof(tones) / sizeof(tones[0])); ti++) {
+			double f = tones[ti];
+			if (f >= nyquist * 0.98)
+				break;
+
+			// opposite phase on the right channel so a channel mixup shows up
+			for (int n = 0; n < in_count; n++) {
+				double s = AMPLITUDE * 32767.0 * sin(2.0 * M_PI * f * n / c->in_rate);
+				in[n].left = (int16_t)lrint(s);
+				in[n].right = (int16_t)lrint(-s);
+			}
+			// radians per output frame
+			double w = 2.0 * M_PI * f / (c->in_rate * final_ratio);
+
+			printf("%8.0f", f);
+			for (int k = 0; k < LEVEL_COUNT; k++) {
+				int count = levels[k].type < 0
+								? resamplePolyphase(in, in_count, batch, c, out, out_size)
+								: resampleSrc(in, in_count, batch, c, levels[k].type, out, out_size);
+				if (count < (int)(3 * SETTLE * c->out_rate)) {
+					printf(" | %19s <-", "failed");
+					failed = 1;
+					continue;
+				}
+				// report the worse channel
+				Result r = analyze(&out->left, count, c->out_rate, w);
+				Result right = analyze(&out->right, count, c->out_rate, w);
+				if (right.snr < r.snr)
+					r = right;
+
+				if (r.harmonics)
+					printf(" | %8.1f  %8.1f", r.snr, r.thd);
+				else
+					printf(" | %8.1f  %8s", r.snr, "-");
+
+				if (levels[k].type < 0 && f < passband && r.snr < POLY_SNR_FLOOR) {
+					printf(" <-");
+					failed = 1;
+				}
+			}
+			printf("\n");
+		}
+		printf("\n");
+
+		free(in);
+		free(out);
+	}
+
+	// content doesn't change the cost of any of these, a single tone will do
+	printf("time per video frame batch, ns (%% of a 60fps frame)\n");
+	printf("%-16s", "quality");
+	for (int ci = 0; ci < (int)(sizeof(cases) / sizeof(cases[0])); ci++)
+		printf(" | %-22s", cases[ci].name);
+	printf("\n");
+	for (int k = 0; k < LEVEL_COUNT; k++) {
+		printf("%-16s", levels[k].name);
+		for (int ci = 0; ci < (int)(sizeof(cases) / sizeof(cases[0])); ci++) {
+			const Case* c = &cases[ci];
+			double final_ratio = ((double)c->out_rate / c->in_rate) * c->ratio;
+			int in_count = (int)(seconds * c->in_rate);
+			int out_size = (int)(in_count * final_ratio) + 64;
+			int batch = c->in_rate / 60;
+
+			SND_Frame* in = malloc(in_count * sizeof(SND_Frame));
+			SND_Frame* out = malloc(out_size * sizeof(SND_Frame));
+			for (int n = 0; n < in_count; n++) {
+				double s = AMPLITUDE * 32767.0 * sin(2.0 * M_PI * 440.0 * n / c->in_rate);
+				in[n].left = (int16_t)lrint(s);
+				in[n].right = (int16_t)lrint(-s);
+			}
+
+			double ns = timeLevel(in, in_count, batch, c, levels[k].type, out, out_size);
+			if (ns < 0.0) {
+				printf(" | %22s", "failed");
+				failed = 1;
+			} else {
+				printf(" | %10.0f  (%6.3f%%)", ns, ns / (1e9 / 60.0) * 100.0);
+			}
+
+			free(in);
+			free(out);
+		}
+		printf("\n");
+	}
+	printf("\n");
+
+	if (failed)
+		printf("failed, see the marked rows above (polyphase SNR floor %.0fdB)\n", POLY_SNR_FLOOR);
+	return failed;
+}
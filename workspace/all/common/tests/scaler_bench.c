@@ -0,0 +1,162 @@
+// Checks every integer scaler in scaler.c against a plain nearest neighbour
+// reference over a grid of sizes, pitches, alignments and bit depths, then
+// reports the throughput of each one in output MPixel/s.
+//
+//	make scaler_bench && ./scaler_bench [seconds per scaler]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "scaler.h"
+
+typedef void (*dispatch_t)(uint32_t xmul, uint32_t ymul, void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp);
+
+typedef struct Variant {
+	const char* suffix;
+	dispatch_t scaler;
+	int bpp;
+} Variant;
+
+static Variant variants[] = {
+	{"c16", scaler_c16, 2},
+	{"c32", scaler_c32, 4},
+#ifdef HAS_NEON
+	{"n16", scaler_n16, 2},
+	{"n32", scaler_n32, 4},
+#endif
+};
+
+static const int sizes[][2] = {
+	{1, 1},
+	{3, 2},
+	{7, 5},
+	{160, 144},
+	{256, 224},
+	{320, 240},
+};
+
+#define CANARY 0xA5
+
+static double now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// xmul 1-4 go up to 4 lines, 5 and 6 up to their own multiplier (see scaler_c16)
+static int maxYmul(int xmul) {
+	return xmul < 5 ? 4 : xmul;
+}
+
+// sp/dp of 0 asks the scaler to derive the pitch, offset shifts src and dst
+// by one pixel to hit the unaligned fallbacks
+static int check(Variant* v, int xmul, int ymul, int sw, int sh, int src_pad, int dst_pad, int offset, int zero_pitch) {
+	int bpp = v->bpp;
+	int sp = (sw + src_pad) * bpp;
+	int dw = sw * xmul;
+	int dh = sh * ymul;
+	int dp = (dw + dst_pad) * bpp;
+
+	size_t src_size = (size_t)sp * sh + bpp;
+	size_t dst_size = (size_t)dp * dh + bpp * 2;
+	uint8_t* src_buf = malloc(src_size);
+	uint8_t* dst_buf = malloc(dst_size);
+	uint8_t* ref = malloc(dst_size);
+	if (!src_buf || !dst_buf || !ref) {
+		free(src_buf);
+		free(dst_buf);
+		free(ref);
+		return 0;
+	}
+
+	for (size_t i = 0; i < src_size; i++)
+		src_buf[i] = rand();
+	memset(dst_buf, CANARY, dst_size);
+	memset(ref, CANARY, dst_size);
+
+	uint8_t* src = src_buf + offset * bpp;
+	uint8_t* dst = dst_buf + offset * bpp;
+	uint8_t* expect = ref + offset * bpp;
+	for (int y = 0; y < dh; y++) {
+		for (int x = 0; x < dw; x++) {
+			memcpy(expect + y * dp + x * bpp, src + (y / ymul) * sp + (x / xmul) * bpp, bpp);
+		}
+	}
+
+	v->scaler(xmul, ymul, src, dst, sw, sh, zero_pitch ? 0 : sp, dw, dh, zero_pitch ? 0 : dp);
+
+	// comparing the whole buffer also catches writes into the row padding
+	// or past the last row
+	int ok = memcmp(dst_buf, ref, dst_size) == 0;
+	if (!ok) {
+		printf("FAIL scale%dx%d_%s %dx%d src_pad:%d dst_pad:%d offset:%d zero_pitch:%d\n", xmul, ymul, v->suffix, sw, sh, src_pad, dst_pad, offset, zero_pitch);
+	}
+
+	free(src_buf);
+	free(dst_buf);
+	free(ref);
+	return ok;
+}
+
+static double bench(Variant* v, int xmul, int ymul, double seconds) {
+	int sw = 320;
+	int sh = 240;
+	int bpp = v->bpp;
+	int sp = sw * bpp;
+	int dp = sw * xmul * bpp;
+	uint8_t* src = malloc((size_t)sp * sh);
+	uint8_t* dst = malloc((size_t)dp * sh * ymul);
+	if (!src || !dst) {
+		free(src);
+		free(dst);
+		return 0.0;
+	}
+	for (int i = 0; i < sp * sh; i++)
+		src[i] = rand();
+
+	int frames = 0;
+	double start = now();
+	double elapsed = 0.0;
+	do {
+		v->scaler(xmul, ymul, src, dst, sw, sh, sp, sw * xmul, sh * ymul, dp);
+		frames++;
+		elapsed = now() - start;
+	} while (elapsed < seconds);
+
+	free(src);
+	free(dst);
+	return (double)frames * sw * xmul * sh * ymul / elapsed / 1e6;
+}
+
+int main(int argc, char* argv[]) {
+	double seconds = argc > 1 ? atof(argv[1]) : 0.1;
+	int failed = 0;
+	srand(1);
+
+	for (int i = 0; i < (int)(sizeof(variants) / sizeof(variants[0])); i++) {
+		Variant* v = &variants[i];
+		for (int xmul = 1; xmul <= 6; xmul++) {
+			for (int ymul = 1; ymul <= maxYmul(xmul); ymul++) {
+				int ok = 1;
+				for (int s = 0; s < (int)(sizeof(sizes) / sizeof(sizes[0])); s++) {
+					int sw = sizes[s][0];
+					int sh = sizes[s][1];
+					ok &= check(v, xmul, ymul, sw, sh, 0, 0, 0, 1);
+					ok &= check(v, xmul, ymul, sw, sh, 0, 0, 0, 0);
+					ok &= check(v, xmul, ymul, sw, sh, 3, 0, 0, 0);
+					ok &= check(v, xmul, ymul, sw, sh, 0, 5, 0, 0);
+					ok &= check(v, xmul, ymul, sw, sh, 1, 1, 1, 0);
+				}
+				if (!ok)
+					failed++;
+				printf("scale%dx%d_%s %s %8.1f MPixel/s\n", xmul, ymul, v->suffix, ok ? "ok  " : "FAIL", bench(v, xmul, ymul, seconds));
+			}
+		}
+	}
+
+	if (failed)
+		printf("%d scalers FAILED\n", failed);
+	return failed ? 1 : 0;
+}
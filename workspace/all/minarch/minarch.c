@@ -9,6 +9,9 @@
 #include <libgen.h>
 #include <time.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
+#include <sys/statvfs.h>
+#include <utime.h>
 #include <errno.h>
 #include <zip.h>
 #include <pthread.h>
@@ -31,6 +34,8 @@
 #include "config.h"
 #include "ra_integration.h"
 #include "ra_badges.h"
+#include "rewind_ring.h"
+#include "pixel_convert.h"
 #include <dirent.h>
 #include <SDL2/SDL_image.h>
 #include <SDL2/SDL.h>
@@ -61,15 +66,18 @@ enum {
 #define MINARCH_DEFAULT_REWIND_GRANULARITY 16
 #define MINARCH_DEFAULT_REWIND_AUDIO 0
 #define MINARCH_DEFAULT_REWIND_LZ4_ACCELERATION 2
+#define MINARCH_DEFAULT_REWIND_KEYFRAME_INTERVAL 60
 
 // rewind implementation constants
-#define REWIND_ENTRY_SIZE_HINT 4096					   // assumed avg entry size for capacity calc
+#define REWIND_ENTRY_SIZE_HINT 1024					   // assumed avg entry size for capacity calc (unchanged blocks aren't stored, so entries are often tiny)
 #define REWIND_MIN_ENTRIES 8						   // minimum entry table size
 #define REWIND_POOL_SIZE_SMALL 3					   // capture pool size for small states
 #define REWIND_POOL_SIZE_LARGE 4					   // capture pool size for large states
 #define REWIND_LARGE_STATE_THRESHOLD (2 * 1024 * 1024) // 2MB threshold for pool sizing
 #define REWIND_MAX_BUFFER_MB 256					   // max rewind buffer size
 #define REWIND_MAX_LZ4_ACCELERATION 64				   // max LZ4 acceleration value
+#define REWIND_COMPRESS_THREADS 2					   // helper threads compressing blocks alongside the capture worker
+#define REWIND_JUMP_SECONDS 5						   // how far the "Jump Back" shortcut goes
 
 // default frontend options
 static int screen_scaling = SCALE_ASPECT;
@@ -98,6 +106,7 @@ static int rewind_cfg_granularity = MINARCH_DEFAULT_REWIND_GRANULARITY;
 static int rewind_cfg_audio = MINARCH_DEFAULT_REWIND_AUDIO;
 static int rewind_cfg_compress = 1;
 static int rewind_cfg_lz4_acceleration = MINARCH_DEFAULT_REWIND_LZ4_ACCELERATION;
+static int rewind_cfg_keyframe_interval = MINARCH_DEFAULT_REWIND_KEYFRAME_INTERVAL;
 static int overclock = 3; // auto
 static int has_custom_controllers = 0;
 static int gamepad_type = 0; // index in gamepad_labels/gamepad_values
@@ -158,7 +167,7 @@ static struct Core {
 	// retro_audio_buffer_status_callback_t audio_buffer_status;
 } core;
 
-int extract_zip(char** extensions);
+int extract_zip(char** extensions, int to_memory);
 static bool getAlias(char* path, char* alias);
 
 static struct Game {
@@ -169,40 +178,42 @@ static struct Game {
 	char tmp_path[MAX_PATH]; // location of unzipped file
 	void* data;
 	size_t size;
+	int is_mapped; // data is an mmap of the rom rather than a malloc'd copy
 	int is_open;
 } game;
+
+// Maps the rom copy-on-write so pages are only read from the card as the core
+// touches them and aren't duplicated when it keeps its own copy
+static int Game_map(const char* path) {
+	int fd = open(path, O_RDONLY);
+	if (fd < 0)
+		return 0;
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+		close(fd);
+		return 0;
+	}
+	// writable since some cores patch the rom in place, MAP_PRIVATE keeps that off the card
+	void* data = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (data == MAP_FAILED)
+		return 0;
+	madvise(data, st.st_size, MADV_WILLNEED);
+
+	game.data = data;
+	game.size = st.st_size;
+	game.is_mapped = 1;
+	return 1;
+}
 static void Game_open(char* path) {
-	int skipzip = 0;
 	memset(&game, 0, sizeof(game));
 
 	strcpy((char*)game.path, path);
 	strcpy((char*)game.name, strrchr(path, '/') + 1);
 	strcpy((char*)game.alt_name, game.name); // default it
 
-	// check first if the rom already is alive in tmp folder if so skip unzipping shit
-	char tmpfldr[255];
-	snprintf(tmpfldr, sizeof(tmpfldr), "/tmp/nextarch/%s", core.tag);
-	char* tmppath = findFileInDir(tmpfldr, game.name);
-	if (tmppath) {
-		// Verify the file exists and has non-zero size (not being written or truncated)
-		struct stat st;
-		if (stat(tmppath, &st) == 0 && st.st_size > 0) {
-			printf("File exists skipping unzipping and setting game.tmp_path: %s\n", tmppath);
-			strcpy((char*)game.tmp_path, tmppath);
-			skipzip = 1;
-			// Update the game name to the extracted file name instead of the zip name
-			if (CFG_getUseExtractedFileName())
-				strcpy((char*)game.alt_name, strrchr(game.tmp_path, '/') + 1);
-		} else {
-			printf("File exists but is empty or inaccessible, will re-extract: %s\n", tmppath);
-		}
-		free(tmppath);
-	} else {
-		printf("File does not exist in %s\n", tmpfldr);
-	}
-
 	// if we have a zip file
-	if (suffixMatch(".zip", game.path) && !skipzip) {
+	if (suffixMatch(".zip", game.path)) {
 		int supports_zip = 0;
 		int i = 0;
 		char* ext;
@@ -220,9 +231,9 @@ static void Game_open(char* path) {
 
 		// if the core doesn't support zip files natively
 		if (!supports_zip) {
-			// extract zip file located at game.path to game.tmp_path
-			// game.tmp_path is temp dir generated by mkdtemp
-			if (!extract_zip(extensions))
+			// extract zip file located at game.path to game.tmp_path (reused if still cached),
+			// cores we hand the data to get it straight in memory instead
+			if (!extract_zip(extensions, !core.need_fullpath))
 				return;
 			// Update the game name to the extracted file name instead of the zip name
 			if (CFG_getUseExtractedFileName())
@@ -232,28 +243,33 @@ static void Game_open(char* path) {
 
 	// some cores handle opening files themselves, eg. pcsx_rearmed
 	// if the frontend tries to load a 500MB file itself bad things happen
-	if (!core.need_fullpath) {
+	if (!core.need_fullpath && !game.data) {
 		path = game.tmp_path[0] == '\0' ? game.path : game.tmp_path;
 
-		FILE* file = fopen(path, "r");
-		if (file == NULL) {
-			LOG_error("Error opening game: %s\n\t%s\n", path, strerror(errno));
-			return;
-		}
+		// Extracted roms live in /tmp and may get replaced by a later extraction, and cores
+		// that take archives unpack them up front anyway, so both are still read in full
+		int can_map = !game.tmp_path[0] && !suffixMatch(".zip", path);
+		if (!can_map || !Game_map(path)) {
+			FILE* file = fopen(path, "r");
+			if (file == NULL) {
+				LOG_error("Error opening game: %s\n\t%s\n", path, strerror(errno));
+				return;
+			}
 
-		fseek(file, 0, SEEK_END);
-		game.size = ftell(file);
+			fseek(file, 0, SEEK_END);
+			game.size = ftell(file);
 
-		rewind(file);
-		game.data = malloc(game.size);
-		if (game.data == NULL) {
-			LOG_error("Couldn't allocate memory for file: %s\n", path);
-			return;
-		}
+			rewind(file);
+			game.data = malloc(game.size);
+			if (game.data == NULL) {
+				LOG_error("Couldn't allocate memory for file: %s\n", path);
+				return;
+			}
 
-		fread(game.data, sizeof(uint8_t), game.size, file);
+			fread(game.data, sizeof(uint8_t), game.size, file);
 
-		fclose(file);
+			fclose(file);
+		}
 	}
 
 	// m3u-based?
@@ -289,8 +305,14 @@ static void Game_open(char* path) {
 	game.is_open = 1;
 }
 static void Game_close(void) {
-	if (game.data)
-		free(game.data);
+	if (game.data) {
+		if (game.is_mapped)
+			munmap(game.data, game.size);
+		else
+			free(game.data);
+	}
+	game.data = NULL;
+	game.is_mapped = 0;
 	// why delete tempfile? keep it for next time when loading the game its much faster from /tmp ram folder
 	// if (game.tmp_path[0]) remove(game.tmp_path);
 	game.is_open = 0;
@@ -314,8 +336,193 @@ static void Game_changeDisc(char* path) {
 	putFile(CHANGE_DISC_PATH, path); // NextUI still needs to know this to update recents.txt
 }
 
-int extract_zip(char** extensions) {
-	char buf[100];
+///////////////////////////////
+// Zip extraction cache: extracted roms stay in tmpfs between launches, each
+// with a hidden .key file recording the archive and entry it came from so a
+// changed zip is never served stale. Key files are touched on every hit and
+// the least recently used extractions go once the cache outgrows its budget.
+
+#define ZIP_CACHE_DIR "/tmp/nextarch"
+#define ZIP_CACHE_CHUNK (256 * 1024)
+#define ZIP_CACHE_BUDGET_PERCENT 50 // of tmpfs, which is RAM shared with everything else
+
+typedef struct {
+	long long zip_mtime;
+	long long zip_size;
+	unsigned int crc;
+	long long size;
+	char zip_path[MAX_PATH];
+} ZipCacheKey;
+
+typedef struct {
+	char path[MAX_PATH];
+	time_t used;
+	long long size;
+} ZipCacheFile;
+
+static void ZipCache_keyPath(const char* file_path, char* key_path) {
+	const char* name = strrchr(file_path, '/') + 1;
+	snprintf(key_path, MAX_PATH, "%.*s.%s.key", (int)(name - file_path), file_path, name);
+}
+
+static int ZipCache_readKey(const char* key_path, ZipCacheKey* key) {
+	FILE* file = fopen(key_path, "r");
+	if (!file)
+		return 0;
+	int ok = fscanf(file, "%lld %lld %u %lld\n", &key->zip_mtime, &key->zip_size, &key->crc, &key->size) == 4 &&
+			 fgets(key->zip_path, sizeof(key->zip_path), file);
+	fclose(file);
+	if (ok) {
+		normalizeNewline(key->zip_path);
+		trimTrailingNewlines(key->zip_path);
+	}
+	return ok;
+}
+
+static int ZipCache_keyMatches(const ZipCacheKey* a, const ZipCacheKey* b) {
+	return a->zip_mtime == b->zip_mtime && a->zip_size == b->zip_size && a->crc == b->crc &&
+		   a->size == b->size && exactMatch(a->zip_path, b->zip_path);
+}
+
+static int ZipCache_writeKey(const char* key_path, const ZipCacheKey* key) {
+	FILE* file = fopen(key_path, "w");
+	if (!file)
+		return 0;
+	fprintf(file, "%lld %lld %u %lld\n%s\n", key->zip_mtime, key->zip_size, key->crc, key->size, key->zip_path);
+	return fclose(file) == 0;
+}
+
+static int ZipCache_compareUsed(const void* a, const void* b) {
+	const ZipCacheFile* fa = a;
+	const ZipCacheFile* fb = b;
+	return (fa->used > fb->used) - (fa->used < fb->used);
+}
+
+// Deletes least recently used extractions (across all cores) until needed more
+// bytes fit in the budget. keep is about to be rewritten so it's not counted.
+static void ZipCache_makeRoom(long long needed, const char* keep) {
+	struct statvfs vfs;
+	if (statvfs(ZIP_CACHE_DIR, &vfs) != 0)
+		return;
+	long long budget = (long long)vfs.f_blocks * vfs.f_frsize / 100 * ZIP_CACHE_BUDGET_PERCENT;
+
+	int count = 0;
+	int capacity = 0;
+	ZipCacheFile* files = NULL;
+	long long used = 0;
+
+	DIR* root = opendir(ZIP_CACHE_DIR);
+	if (!root)
+		return;
+	struct dirent* tag;
+	while ((tag = readdir(root))) {
+		if (tag->d_name[0] == '.')
+			continue;
+		char dir_path[MAX_PATH];
+		snprintf(dir_path, sizeof(dir_path), "%s/%s", ZIP_CACHE_DIR, tag->d_name);
+		DIR* dir = opendir(dir_path);
+		if (!dir)
+			continue;
+		struct dirent* entry;
+		while ((entry = readdir(dir))) {
+			if (entry->d_name[0] == '.')
+				continue; // keys, partial extractions and . / ..
+			ZipCacheFile file;
+			snprintf(file.path, sizeof(file.path), "%s/%s", dir_path, entry->d_name);
+			struct stat st;
+			if (stat(file.path, &st) != 0 || !S_ISREG(st.st_mode) || exactMatch(file.path, keep))
+				continue;
+			char key_path[MAX_PATH];
+			ZipCache_keyPath(file.path, key_path);
+			struct stat key_st;
+			file.used = stat(key_path, &key_st) == 0 ? key_st.st_mtime : st.st_mtime;
+			file.size = st.st_size;
+			used += file.size;
+
+			if (count == capacity) {
+				capacity = capacity ? capacity * 2 : 16;
+				ZipCacheFile* grown = realloc(files, capacity * sizeof(ZipCacheFile));
+				if (!grown)
+					break;
+				files = grown;
+			}
+			files[count++] = file;
+		}
+		closedir(dir);
+	}
+	closedir(root);
+
+	qsort(files, count, sizeof(ZipCacheFile), ZipCache_compareUsed);
+	for (int i = 0; i < count && used + needed > budget; i++) {
+		char key_path[MAX_PATH];
+		ZipCache_keyPath(files[i].path, key_path);
+		LOG_info("Evicting cached extraction: %s\n", files[i].path);
+		unlink(key_path);
+		unlink(files[i].path);
+		used -= files[i].size;
+	}
+	free(files);
+}
+
+static int ZipCache_read(struct zip_file* zf, void* data, long long size) {
+	long long sum = 0;
+	while (sum < size) {
+		long long chunk = size - sum < ZIP_CACHE_CHUNK ? size - sum : ZIP_CACHE_CHUNK;
+		zip_int64_t len = zip_fread(zf, (uint8_t*)data + sum, chunk);
+		if (len <= 0)
+			return 0;
+		sum += len;
+	}
+	return 1;
+}
+
+static int ZipCache_extract(struct zip_file* zf, const char* path, long long size) {
+	char part_path[MAX_PATH];
+	const char* name = strrchr(path, '/') + 1;
+	snprintf(part_path, sizeof(part_path), "%.*s.%s.part", (int)(name - path), path, name);
+
+	int fd = open(part_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0) {
+		LOG_error("open failed: %s\n", strerror(errno));
+		return 0;
+	}
+	uint8_t* buf = malloc(ZIP_CACHE_CHUNK);
+	int ok = buf != NULL;
+	long long sum = 0;
+	while (ok && sum < size) {
+		zip_int64_t len = zip_fread(zf, buf, ZIP_CACHE_CHUNK);
+		if (len <= 0) {
+			LOG_error("zip_fread failed\n");
+			ok = 0;
+			break;
+		}
+		for (zip_int64_t off = 0; off < len;) {
+			ssize_t written = write(fd, buf + off, len - off);
+			if (written < 0) {
+				LOG_error("write failed: %s\n", strerror(errno));
+				ok = 0;
+				break;
+			}
+			off += written;
+		}
+		sum += len;
+	}
+	free(buf);
+	close(fd);
+	// only complete extractions ever carry the real name
+	if (ok && rename(part_path, path) != 0) {
+		LOG_error("rename failed: %s\n", strerror(errno));
+		ok = 0;
+	}
+	if (!ok)
+		unlink(part_path);
+	return ok;
+}
+
+// Sets game.tmp_path to the first entry matching extensions. It's reused if the
+// cache already holds this exact entry, otherwise extracted, or with to_memory
+// decompressed straight into game.data (tmp_path then only names the rom).
+int extract_zip(char** extensions, int to_memory) {
 	struct zip* za;
 	int ze;
 	if ((za = zip_open(game.path, 0, &ze)) == NULL) {
@@ -325,105 +532,88 @@ int extract_zip(char** extensions) {
 		return 0;
 	}
 
-	// char tmp_template[MAX_PATH];
-	// strcpy(tmp_template, "/tmp/minarch-XXXXXX");
-
-	mkdir("/tmp/nextarch", 0777);
+	mkdir(ZIP_CACHE_DIR, 0777);
 	char tmp_dirname[255];
-	snprintf(tmp_dirname, sizeof(tmp_dirname), "%s/%s", "/tmp/nextarch", core.tag);
+	snprintf(tmp_dirname, sizeof(tmp_dirname), "%s/%s", ZIP_CACHE_DIR, core.tag);
 	mkdir(tmp_dirname, 0777);
 
-	int i, len;
-	int fd;
-	struct zip_file* zf;
+	struct stat zip_st;
+	stat(game.path, &zip_st);
+
+	int success = 0;
 	struct zip_stat sb;
-	long long sum;
-	for (i = 0; i < zip_get_num_entries(za, 0); i++) {
-		if (zip_stat_index(za, i, 0, &sb) == 0) {
-			len = strlen(sb.name);
-			if (sb.name[len - 1] == '/') {
-				sprintf(game.tmp_path, "%s/%s", tmp_dirname, basename((char*)sb.name));
-			} else {
-				int found = 0;
-				char extension[8];
-				for (int e = 0; extensions[e]; e++) {
-					sprintf(extension, ".%s", extensions[e]);
-					if (suffixMatch(extension, sb.name)) {
-						found = 1;
-						break;
-					}
-				}
-				if (!found)
-					continue;
+	zip_int64_t count = zip_get_num_entries(za, 0);
+	for (zip_int64_t i = 0; i < count; i++) {
+		if (zip_stat_index(za, i, 0, &sb) != 0)
+			continue;
+		int len = strlen(sb.name);
+		if (!len || sb.name[len - 1] == '/')
+			continue;
 
-				sprintf(game.tmp_path, "%s/%s", tmp_dirname, basename((char*)sb.name));
+		int found = 0;
+		char extension[8];
+		for (int e = 0; extensions[e]; e++) {
+			sprintf(extension, ".%s", extensions[e]);
+			if (suffixMatch(extension, sb.name)) {
+				found = 1;
+				break;
+			}
+		}
+		if (!found)
+			continue;
 
-				// Check if file already exists and has the correct size
-				struct stat st;
-				if (stat(game.tmp_path, &st) == 0 && st.st_size == sb.size) {
-					// File already exists with correct size, skip extraction
-					return 1;
-				}
+		sprintf(game.tmp_path, "%s/%s", tmp_dirname, basename((char*)sb.name));
 
-				zf = zip_fopen_index(za, i, 0);
-				if (!zf) {
-					LOG_error("zip_fopen_index failed\n");
-					return 0;
-				}
+		ZipCacheKey key = {
+			.zip_mtime = zip_st.st_mtime,
+			.zip_size = zip_st.st_size,
+			.crc = sb.crc,
+			.size = sb.size,
+		};
+		snprintf(key.zip_path, sizeof(key.zip_path), "%s", game.path);
 
-				// Try to create file exclusively first to avoid race condition
-				fd = open(game.tmp_path, O_RDWR | O_CREAT | O_EXCL, 0644);
-				if (fd < 0) {
-					if (errno == EEXIST) {
-						// File was created by another process, verify it's complete
-						zip_fclose(zf);
-						if (stat(game.tmp_path, &st) == 0 && st.st_size == sb.size) {
-							return 1;
-						}
-						// File exists but wrong size, try to truncate and rewrite
-						fd = open(game.tmp_path, O_RDWR | O_TRUNC, 0644);
-						if (fd < 0) {
-							LOG_error("open failed after EEXIST: %s\n", strerror(errno));
-							return 0;
-						}
-						zf = zip_fopen_index(za, i, 0);
-						if (!zf) {
-							LOG_error("zip_fopen_index failed on retry\n");
-							close(fd);
-							return 0;
-						}
-					} else {
-						LOG_error("open failed: %s\n", strerror(errno));
-						zip_fclose(zf);
-						return 0;
-					}
-				}
+		char key_path[MAX_PATH];
+		ZipCache_keyPath(game.tmp_path, key_path);
+		ZipCacheKey cached;
+		struct stat st;
+		if (ZipCache_readKey(key_path, &cached) && ZipCache_keyMatches(&cached, &key) &&
+			stat(game.tmp_path, &st) == 0 && st.st_size == sb.size) {
+			utime(key_path, NULL); // mark as recently used
+			success = 1;
+			break;
+		}
 
-				sum = 0;
-				while (sum != sb.size) {
-					len = zip_fread(zf, buf, 100);
-					if (len < 0) {
-						LOG_error("zip_fread failed\n");
-						close(fd);
-						zip_fclose(zf);
-						return 0;
-					}
-					write(fd, buf, len);
-					sum += len;
-				}
-				close(fd);
-				zip_fclose(zf);
-				return 1;
+		struct zip_file* zf = zip_fopen_index(za, i, 0);
+		if (!zf) {
+			LOG_error("zip_fopen_index failed\n");
+			break;
+		}
+
+		if (to_memory) {
+			game.data = malloc(sb.size ? sb.size : 1);
+			if (game.data && ZipCache_read(zf, game.data, sb.size)) {
+				game.size = sb.size;
+				success = 1;
+			} else {
+				LOG_error("Couldn't extract %s to memory\n", sb.name);
+				free(game.data);
+				game.data = NULL;
 			}
+		} else {
+			// whatever was here came from a different zip or is incomplete
+			unlink(key_path);
+			ZipCache_makeRoom(sb.size, game.tmp_path);
+			if (ZipCache_extract(zf, game.tmp_path, sb.size) && ZipCache_writeKey(key_path, &key))
+				success = 1;
 		}
+		zip_fclose(zf);
+		break;
 	}
 
-	if (zip_close(za) == -1) {
+	if (zip_close(za) == -1)
 		LOG_error("can't close zip archive `%s'\n", game.path);
-		return 0;
-	}
 
-	return 0;
+	return success;
 }
 
 ///////////////////////////////////////
@@ -967,6 +1157,233 @@ static void State_getPath(char* filename) {
 	}
 }
 
+///////////////////////////////
+// Save state writer: State_write only serializes into a pooled buffer, the
+// thread below compresses it into a temp file, fsyncs and renames it over
+// the slot so a half written state never replaces a good one.
+
+#define STATE_WRITE_BUFFERS 2
+
+enum {
+	STATE_JOB_FREE = 0,
+	STATE_JOB_QUEUED,
+	STATE_JOB_WRITING,
+	STATE_JOB_DONE, // waiting for the main thread to report it
+};
+
+typedef struct {
+	uint8_t* data;
+	size_t capacity;
+	size_t size;
+	char path[MAX_PATH];
+	int compress;
+	int notify_slot; // user-facing slot to report on, -1 to stay quiet
+	int status;
+	int success;
+	unsigned int seq;
+} StateWriteJob;
+
+static struct {
+	pthread_t thread;
+	pthread_mutex_t mx;
+	pthread_cond_t cv;
+	pthread_cond_t done_cv;
+	int running;
+	int stop;
+	unsigned int seq;
+	StateWriteJob jobs[STATE_WRITE_BUFFERS];
+} state_writer = {
+	.mx = PTHREAD_MUTEX_INITIALIZER,
+	.cv = PTHREAD_COND_INITIALIZER,
+	.done_cv = PTHREAD_COND_INITIALIZER,
+};
+
+static int State_fsyncPath(const char* path) {
+	int fd = open(path, O_RDONLY);
+	if (fd < 0)
+		return 0;
+	int ok = fsync(fd) == 0;
+	close(fd);
+	return ok;
+}
+
+static int State_writeJob(StateWriteJob* job) {
+	char tmp_path[MAX_PATH + 8];
+	snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", job->path);
+
+#ifdef HAS_SRM
+	if (job->compress) {
+		if (!rzipstream_write_file(tmp_path, job->data, job->size)) {
+			LOG_error("rzipstream: Error writing state data to file: %s\n", tmp_path);
+			goto error;
+		}
+	} else {
+		if (!filestream_write_file(tmp_path, job->data, job->size)) {
+			LOG_error("filestream: Error writing state data to file: %s\n", tmp_path);
+			goto error;
+		}
+	}
+	if (!State_fsyncPath(tmp_path)) {
+		LOG_error("Error syncing state file: %s (%s)\n", tmp_path, strerror(errno));
+		goto error;
+	}
+#else
+	FILE* state_file = fopen(tmp_path, "w");
+	if (!state_file) {
+		LOG_error("Error opening state file: %s (%s)\n", tmp_path, strerror(errno));
+		goto error;
+	}
+	if (job->size != fwrite(job->data, 1, job->size, state_file) || fflush(state_file) != 0 || fsync(fileno(state_file)) != 0) {
+		LOG_error("Error writing state data to file: %s (%s)\n", tmp_path, strerror(errno));
+		fclose(state_file);
+		goto error;
+	}
+	fclose(state_file);
+#endif
+
+	if (rename(tmp_path, job->path) != 0) {
+		LOG_error("Error replacing state file: %s (%s)\n", job->path, strerror(errno));
+		goto error;
+	}
+	sync();
+	return 1;
+
+error:
+	unlink(tmp_path);
+	return 0;
+}
+
+static void* State_writerThread(void* arg) {
+	(void)arg;
+	PWR_pinToCores(CPU_CORE_EFFICIENCY);
+
+	pthread_mutex_lock(&state_writer.mx);
+	while (1) {
+		// oldest queued job first so repeated saves to a slot land in order
+		StateWriteJob* job = NULL;
+		for (int i = 0; i < STATE_WRITE_BUFFERS; i++) {
+			StateWriteJob* j = &state_writer.jobs[i];
+			if (j->status == STATE_JOB_QUEUED && (!job || (int)(j->seq - job->seq) < 0))
+				job = j;
+		}
+		if (!job) {
+			if (state_writer.stop)
+				break;
+			pthread_cond_wait(&state_writer.cv, &state_writer.mx);
+			continue;
+		}
+		job->status = STATE_JOB_WRITING;
+		pthread_mutex_unlock(&state_writer.mx);
+
+		int success = State_writeJob(job);
+
+		pthread_mutex_lock(&state_writer.mx);
+		job->success = success;
+		job->status = STATE_JOB_DONE;
+		pthread_cond_broadcast(&state_writer.done_cv);
+	}
+	pthread_mutex_unlock(&state_writer.mx);
+	return NULL;
+}
+
+static int State_isWritingLocked(const char* path) {
+	for (int i = 0; i < STATE_WRITE_BUFFERS; i++) {
+		StateWriteJob* job = &state_writer.jobs[i];
+		if ((job->status == STATE_JOB_QUEUED || job->status == STATE_JOB_WRITING) && (!path || exactMatch(job->path, path)))
+			return 1;
+	}
+	return 0;
+}
+
+static int State_isWriting(const char* path) {
+	pthread_mutex_lock(&state_writer.mx);
+	int writing = State_isWritingLocked(path);
+	pthread_mutex_unlock(&state_writer.mx);
+	return writing;
+}
+
+// Blocks until path (or every pending state, if NULL) is on disk
+static void State_waitForWrite(const char* path) {
+	pthread_mutex_lock(&state_writer.mx);
+	while (State_isWritingLocked(path)) {
+		pthread_cond_wait(&state_writer.done_cv, &state_writer.mx);
+	}
+	pthread_mutex_unlock(&state_writer.mx);
+}
+
+static void State_reportJob(StateWriteJob* job) {
+	if (job->notify_slot >= 0 && CFG_getNotifyManualSave()) {
+		char msg[NOTIFICATION_MAX_MESSAGE];
+		snprintf(msg, sizeof(msg), job->success ? "State Saved - Slot %d" : "Save Failed - Slot %d", job->notify_slot);
+		Notification_push(NOTIFICATION_SAVE_STATE, msg, NULL);
+	}
+}
+
+// Reports finished writes, called from the main loop since notifications aren't thread safe
+static void State_pollWrites(void) {
+	if (!state_writer.running)
+		return;
+	pthread_mutex_lock(&state_writer.mx);
+	for (int i = 0; i < STATE_WRITE_BUFFERS; i++) {
+		StateWriteJob* job = &state_writer.jobs[i];
+		if (job->status != STATE_JOB_DONE)
+			continue;
+		job->status = STATE_JOB_FREE;
+		pthread_cond_broadcast(&state_writer.done_cv);
+		State_reportJob(job);
+	}
+	pthread_mutex_unlock(&state_writer.mx);
+}
+
+static void State_quitWriter(void) {
+	if (state_writer.running) {
+		pthread_mutex_lock(&state_writer.mx);
+		state_writer.stop = 1;
+		pthread_cond_signal(&state_writer.cv);
+		pthread_mutex_unlock(&state_writer.mx);
+		pthread_join(state_writer.thread, NULL);
+		state_writer.running = 0;
+		state_writer.stop = 0;
+	}
+	for (int i = 0; i < STATE_WRITE_BUFFERS; i++) {
+		StateWriteJob* job = &state_writer.jobs[i];
+		if (job->data)
+			free(job->data);
+		job->data = NULL;
+		job->capacity = 0;
+		job->status = STATE_JOB_FREE;
+	}
+}
+
+// Waits for a buffer the writer isn't using and makes sure it can hold size bytes
+static StateWriteJob* State_acquireJob(size_t size) {
+	pthread_mutex_lock(&state_writer.mx);
+	StateWriteJob* job = NULL;
+	while (!job) {
+		for (int i = 0; i < STATE_WRITE_BUFFERS; i++) {
+			StateWriteJob* j = &state_writer.jobs[i];
+			if (j->status == STATE_JOB_DONE) {
+				j->status = STATE_JOB_FREE;
+				State_reportJob(j);
+			}
+			if (!job && j->status == STATE_JOB_FREE)
+				job = j;
+		}
+		if (!job)
+			pthread_cond_wait(&state_writer.done_cv, &state_writer.mx);
+	}
+	pthread_mutex_unlock(&state_writer.mx);
+
+	if (job->capacity < size) {
+		uint8_t* data = realloc(job->data, size);
+		if (!data)
+			return NULL;
+		job->data = data;
+		job->capacity = size;
+	}
+	return job;
+}
+
 #define RASTATE_HEADER_SIZE 16
 static int State_read(void) { // from picoarch
 	// Block load states in RetroAchievements hardcore mode
@@ -991,6 +1408,7 @@ static int State_read(void) { // from picoarch
 
 	char filename[MAX_PATH];
 	State_getPath(filename);
+	State_waitForWrite(filename);
 
 	uint8_t rastate_header[RASTATE_HEADER_SIZE] = {0};
 
@@ -1076,79 +1494,70 @@ error:
 	return success;
 }
 
-static int State_write(void) { // from picoarch
+// Only the serialize happens here, the file is written in the background.
+// notify_slot is the user-facing slot to report completion for, -1 for none.
+// Returns 0 if the state couldn't be captured.
+static int State_write(int notify_slot) { // from picoarch
 	// Block save states in RetroAchievements hardcore mode
 	if (RA_isHardcoreModeActive()) {
 		Notification_push(NOTIFICATION_ACHIEVEMENT, "Save states disabled in Hardcore mode", NULL);
 		return 0;
 	}
 
-	int success = 0;
 	size_t state_size = core.serialize_size();
 	if (!state_size)
 		return 0;
 
-	int was_ff = fast_forward;
-	fast_forward = 0;
-
-	void* state = calloc(1, state_size);
-	if (!state) {
+	StateWriteJob* job = State_acquireJob(state_size);
+	if (!job) {
 		LOG_error("Couldn't allocate memory for state\n");
-		goto error;
+		return 0;
 	}
 
-	if (!core.serialize(state, state_size)) {
+	int was_ff = fast_forward;
+	fast_forward = 0;
+	memset(job->data, 0, state_size);
+	int serialized = core.serialize(job->data, state_size);
+	fast_forward = was_ff;
+	if (!serialized) {
 		LOG_error("Error serializing save state\n");
-		goto error;
+		return 0;
 	}
 
-	char filename[MAX_PATH];
-	State_getPath(filename);
+	job->size = state_size;
+	job->notify_slot = notify_slot;
+	State_getPath(job->path);
 #ifdef HAS_SRM
-	if (CFG_getStateFormat() == STATE_FORMAT_SRM || CFG_getStateFormat() == STATE_FORMAT_SRM_EXTRADOT) {
-		if (!rzipstream_write_file(filename, state, state_size)) {
-			LOG_error("rzipstream: Error writing state data to file: %s\n", filename);
-			goto error;
-		}
-		success = 1;
-	} else {
-		if (!filestream_write_file(filename, state, state_size)) {
-			LOG_error("filestream: Error writing state data to file: %s\n", filename);
-			goto error;
-		}
-		success = 1;
-	}
-
-error:
-	if (state)
-		free(state);
+	job->compress = CFG_getStateFormat() == STATE_FORMAT_SRM || CFG_getStateFormat() == STATE_FORMAT_SRM_EXTRADOT;
 #else
-	FILE* state_file = fopen(filename, "w");
-	if (!state_file) {
-		LOG_error("Error opening state file: %s (%s)\n", filename, strerror(errno));
-		goto error;
-	}
-	if (state_size != fwrite(state, 1, state_size, state_file)) {
-		LOG_error("Error writing state data to file: %s (%s)\n", filename, strerror(errno));
-		goto error;
-	}
-	success = 1;
-error:
-	if (state)
-		free(state);
-	if (state_file)
-		fclose(state_file);
+	job->compress = 0;
 #endif
 
-	sync();
-	fast_forward = was_ff;
-	return success;
+	pthread_mutex_lock(&state_writer.mx);
+	if (!state_writer.running) {
+		if (pthread_create(&state_writer.thread, NULL, State_writerThread, NULL) == 0) {
+			state_writer.running = 1;
+		} else {
+			LOG_error("Couldn't start state writer thread, writing synchronously\n");
+		}
+	}
+	if (!state_writer.running) {
+		pthread_mutex_unlock(&state_writer.mx);
+		job->success = State_writeJob(job);
+		State_reportJob(job);
+		return job->success;
+	}
+	job->seq = state_writer.seq++;
+	job->status = STATE_JOB_QUEUED;
+	pthread_cond_signal(&state_writer.cv);
+	pthread_mutex_unlock(&state_writer.mx);
+	return 1;
 }
 
 static void State_autosave(void) {
 	int last_state_slot = state_slot;
 	state_slot = AUTO_RESUME_SLOT;
-	State_write();
+	State_write(-1);
 	state_slot = last_state_slot;
 }
 static void Rewind_on_state_change(void);
@@ -1168,35 +1577,12 @@ static void State_resume(void) {
 // Rewind buffer (in-memory, compressed)
 
 typedef struct {
-	size_t offset;
-	size_t size;
-	uint8_t is_keyframe; // 1 if this entry is a full state, 0 if delta-encoded
-} RewindEntry;
-
-typedef struct {
-	uint8_t* buffer;
-	size_t capacity;
-	size_t head;
-	size_t tail;
-
-	RewindEntry* entries;
-	int entry_capacity;
-	int entry_head;
-	int entry_tail;
-	int entry_count;
+	RewindRing ring;
 
 	uint8_t* state_buf;
-	size_t state_size;
 	uint8_t* scratch;
 	size_t scratch_size;
 
-	// Delta compression: store XOR of current vs previous state
-	uint8_t* prev_state_enc; // previous state for delta encoding (compression)
-	uint8_t* prev_state_dec; // previous state for delta decoding (decompression)
-	uint8_t* delta_buf;		 // scratch buffer for XOR result
-	int has_prev_enc;		 // 1 if prev_state_enc is valid
-	int has_prev_dec;		 // 1 if prev_state_dec is valid
-
 	int granularity_frames;
 	int interval_ms;
 	uint32_t last_push_ms;
@@ -1207,7 +1593,6 @@ typedef struct {
 	unsigned int generation;
 	int enabled;
 	int audio;
-	int compress;
 	int lz4_acceleration;
 	int logged_first;
 
@@ -1232,27 +1617,29 @@ typedef struct {
 	int queue_tail;
 	int queue_count;
 	int* queue;
+
+	// block-parallel compression: whoever compresses a state (capture worker
+	// or sync fallback) posts a job and the helpers pick up blocks alongside it
+	int block_bound; // LZ4_compressBound(REWIND_BLOCK_SIZE)
+	int* block_sizes; // compressed size per block of the current job, 0 if unchanged
+	pthread_t helpers[REWIND_COMPRESS_THREADS];
+	int helper_count;
+	pthread_mutex_t job_mx;
+	pthread_cond_t job_cv;
+	pthread_cond_t job_done_cv;
+	unsigned int job_seq;
+	int job_stop;
+	const uint8_t* job_src;
+	const uint8_t* job_prev; // NULL for keyframes
+	int job_next_block;
+	int job_blocks_done;
+	int job_failed;
 } RewindContext;
 
 static RewindContext rewind_ctx = {0};
 static int rewind_warn_empty = 0;
 static int last_rewind_pressed = 0;
 
-typedef enum {
-	REWIND_BUF_EMPTY = 0,
-	REWIND_BUF_HAS_DATA = 1,
-	REWIND_BUF_FULL = 2
-} RewindBufferState;
-
-static RewindBufferState Rewind_buffer_state_locked(void) {
-	if (rewind_ctx.entry_count == 0)
-		return REWIND_BUF_EMPTY;
-	// head == tail with entries means the ring buffer wrapped and is full
-	if (rewind_ctx.head == rewind_ctx.tail)
-		return REWIND_BUF_FULL;
-	return REWIND_BUF_HAS_DATA;
-}
-
 static void* Rewind_worker_thread(void* arg);
 static int Rewind_write_entry_locked(const uint8_t* compressed, size_t dest_len, int is_keyframe);
 static int Rewind_compress_state(const uint8_t* src, size_t* dest_len, int* is_keyframe_out);
@@ -1267,6 +1654,16 @@ static void Rewind_free(void) {
 		pthread_join(rewind_ctx.worker, NULL);
 		rewind_ctx.worker_running = 0;
 	}
+	if (rewind_ctx.helper_count) {
+		pthread_mutex_lock(&rewind_ctx.job_mx);
+		rewind_ctx.job_stop = 1;
+		pthread_cond_broadcast(&rewind_ctx.job_cv);
+		pthread_mutex_unlock(&rewind_ctx.job_mx);
+		for (int i = 0; i < rewind_ctx.helper_count; i++) {
+			pthread_join(rewind_ctx.helpers[i], NULL);
+		}
+		rewind_ctx.helper_count = 0;
+	}
 
 	if (rewind_ctx.capture_pool) {
 		for (int i = 0; i < rewind_ctx.pool_size; i++) {
@@ -1283,24 +1680,31 @@ static void Rewind_free(void) {
 		free(rewind_ctx.free_stack);
 	if (rewind_ctx.queue)
 		free(rewind_ctx.queue);
-	if (rewind_ctx.buffer)
-		free(rewind_ctx.buffer);
-	if (rewind_ctx.entries)
-		free(rewind_ctx.entries);
+	if (rewind_ctx.ring.buffer)
+		free(rewind_ctx.ring.buffer);
+	if (rewind_ctx.ring.entries)
+		free(rewind_ctx.ring.entries);
+	if (rewind_ctx.ring.keyframes)
+		free(rewind_ctx.ring.keyframes);
 	if (rewind_ctx.state_buf)
 		free(rewind_ctx.state_buf);
 	if (rewind_ctx.scratch)
 		free(rewind_ctx.scratch);
-	if (rewind_ctx.prev_state_enc)
-		free(rewind_ctx.prev_state_enc);
-	if (rewind_ctx.prev_state_dec)
-		free(rewind_ctx.prev_state_dec);
-	if (rewind_ctx.delta_buf)
-		free(rewind_ctx.delta_buf);
+	if (rewind_ctx.ring.prev_state_enc)
+		free(rewind_ctx.ring.prev_state_enc);
+	if (rewind_ctx.ring.prev_state_dec)
+		free(rewind_ctx.ring.prev_state_dec);
+	if (rewind_ctx.ring.delta_buf)
+		free(rewind_ctx.ring.delta_buf);
+	if (rewind_ctx.block_sizes)
+		free(rewind_ctx.block_sizes);
 	if (rewind_ctx.locks_ready) {
 		pthread_mutex_destroy(&rewind_ctx.lock);
 		pthread_mutex_destroy(&rewind_ctx.queue_mx);
 		pthread_cond_destroy(&rewind_ctx.queue_cv);
+		pthread_mutex_destroy(&rewind_ctx.job_mx);
+		pthread_cond_destroy(&rewind_ctx.job_cv);
+		pthread_cond_destroy(&rewind_ctx.job_done_cv);
 	}
 	memset(&rewind_ctx, 0, sizeof(rewind_ctx));
 	rewinding = 0;
@@ -1311,10 +1715,7 @@ static void Rewind_reset(void) {
 		return;
 	Rewind_wait_for_worker_idle();
 	pthread_mutex_lock(&rewind_ctx.lock);
-	rewind_ctx.head = rewind_ctx.tail = 0;
-	rewind_ctx.entry_head = rewind_ctx.entry_tail = rewind_ctx.entry_count = 0;
-	rewind_ctx.has_prev_enc = 0;
-	rewind_ctx.has_prev_dec = 0;
+	Rewind_clear(&rewind_ctx.ring);
 	pthread_mutex_unlock(&rewind_ctx.lock);
 	rewind_ctx.frame_counter = 0;
 	rewind_ctx.last_push_ms = 0;
@@ -1346,29 +1747,6 @@ static void Rewind_reset(void) {
 	rewind_warn_empty = 0;
 }
 
-static size_t Rewind_free_space_locked(void) {
-	RewindBufferState state = Rewind_buffer_state_locked();
-	if (state == REWIND_BUF_FULL)
-		return 0;
-	if (state == REWIND_BUF_EMPTY)
-		return rewind_ctx.capacity;
-	if (rewind_ctx.head >= rewind_ctx.tail)
-		return rewind_ctx.capacity - (rewind_ctx.head - rewind_ctx.tail);
-	else
-		return rewind_ctx.tail - rewind_ctx.head;
-}
-static void Rewind_drop_oldest_locked(void) {
-	if (!rewind_ctx.entry_count)
-		return;
-	RewindEntry* e = &rewind_ctx.entries[rewind_ctx.entry_tail];
-	rewind_ctx.tail = (e->offset + e->size) % rewind_ctx.capacity;
-	rewind_ctx.entry_tail = (rewind_ctx.entry_tail + 1) % rewind_ctx.entry_capacity;
-	rewind_ctx.entry_count -= 1;
-	if (rewind_ctx.entry_count == 0) {
-		rewind_ctx.head = rewind_ctx.tail = 0;
-	}
-}
-
 // Block until the worker has drained its queue and is not holding any slots
 static void Rewind_wait_for_worker_idle(void) {
 	if (!rewind_ctx.worker_running || !rewind_ctx.pool_size)
@@ -1383,80 +1761,87 @@ static void Rewind_wait_for_worker_idle(void) {
 	pthread_mutex_unlock(&rewind_ctx.queue_mx);
 }
 
-// Check if an entry overlaps with range [range_start, range_end) in a non-wrapping buffer region
-static int Rewind_entry_overlaps_range(int entry_idx, size_t range_start, size_t range_end) {
-	RewindEntry* e = &rewind_ctx.entries[entry_idx];
-	size_t e_start = e->offset;
-	size_t e_end = e->offset + e->size;
-	// Check for overlap: ranges overlap if start < other_end AND other_start < end
-	return (e_start < range_end) && (range_start < e_end);
-}
-
 static int Rewind_write_entry_locked(const uint8_t* compressed, size_t dest_len, int is_keyframe) {
-	if (dest_len >= rewind_ctx.capacity) {
+	int res = Rewind_write_entry(&rewind_ctx.ring, compressed, dest_len, is_keyframe);
+	if (res == REWIND_WRITE_TOO_BIG) {
 		LOG_error("Rewind: state does not fit in buffer\n");
 		return 0;
 	}
-
-	// If the entry table is full, drop the oldest entry *before* writing so we don't
-	// overwrite its metadata (entry_head == entry_tail when full).
-	if (rewind_ctx.entry_count == rewind_ctx.entry_capacity) {
-		Rewind_drop_oldest_locked();
+	if (res == REWIND_WRITE_NO_ROOM) {
+		LOG_error("Rewind: unable to make room for entry (need %zu, have %zu)\n", dest_len, Rewind_free_space(&rewind_ctx.ring));
+		return 0;
 	}
+	rewind_warn_empty = 0;
+	return 1;
+}
 
-	size_t write_offset = rewind_ctx.head;
+// Encodes one block of the current job into its fixed slot in scratch
+static int Rewind_compress_block(int block) {
+	uint8_t* dst = rewind_ctx.scratch + Rewind_entry_header_size(&rewind_ctx.ring) + (size_t)block * rewind_ctx.block_bound;
+	int accel = rewind_ctx.lz4_acceleration > 0 ? rewind_ctx.lz4_acceleration : MINARCH_DEFAULT_REWIND_LZ4_ACCELERATION;
+	return Rewind_encode_block(&rewind_ctx.ring, block, rewind_ctx.job_src, rewind_ctx.job_prev, dst, rewind_ctx.block_bound, accel);
+}
 
-	// If this write would go past the end of the buffer, wrap to 0
-	if (write_offset + dest_len > rewind_ctx.capacity) {
-		write_offset = 0;
-		rewind_ctx.head = 0;
-		if (rewind_ctx.entry_count == 0) {
-			rewind_ctx.tail = 0;
-		}
-	}
+// Called and returns with job_mx held, drops it while compressing
+static void Rewind_run_blocks_locked(void) {
+	while (rewind_ctx.job_next_block < rewind_ctx.ring.block_count) {
+		int block = rewind_ctx.job_next_block++;
+		pthread_mutex_unlock(&rewind_ctx.job_mx);
+		int res = Rewind_compress_block(block);
+		pthread_mutex_lock(&rewind_ctx.job_mx);
 
-	// Drop any entries that overlap with the region we're about to write: [write_offset, write_offset + dest_len)
-	// We need to check all entries from tail to head and drop any that overlap.
-	// Since entries are stored oldest-to-newest, we drop from oldest while they overlap.
-	while (rewind_ctx.entry_count > 0) {
-		int oldest_idx = rewind_ctx.entry_tail;
-		if (Rewind_entry_overlaps_range(oldest_idx, write_offset, write_offset + dest_len)) {
-			Rewind_drop_oldest_locked();
-		} else {
-			break;
-		}
+		if (res < 0)
+			rewind_ctx.job_failed = 1;
+		else
+			rewind_ctx.block_sizes[block] = res;
+		rewind_ctx.job_blocks_done += 1;
+		if (rewind_ctx.job_blocks_done == rewind_ctx.ring.block_count)
+			pthread_cond_broadcast(&rewind_ctx.job_done_cv);
 	}
+}
 
-	// Still need to make room based on free space calculation
-	while (rewind_ctx.entry_count > 0 && Rewind_free_space_locked() <= dest_len) {
-		Rewind_drop_oldest_locked();
-	}
+static void* Rewind_helper_thread(void* arg) {
+	(void)arg;
+	PWR_pinToCores(CPU_CORE_EFFICIENCY);
 
-	// Safety check: if we still can't fit, there's a logic error
-	if (Rewind_free_space_locked() <= dest_len && rewind_ctx.entry_count > 0) {
-		LOG_error("Rewind: unable to make room for entry (need %zu, have %zu)\n", dest_len, Rewind_free_space_locked());
-		return 0;
+	unsigned int seen = 0;
+	pthread_mutex_lock(&rewind_ctx.job_mx);
+	while (1) {
+		while (!rewind_ctx.job_stop && rewind_ctx.job_seq == seen) {
+			pthread_cond_wait(&rewind_ctx.job_cv, &rewind_ctx.job_mx);
+		}
+		if (rewind_ctx.job_stop)
+			break;
+		seen = rewind_ctx.job_seq;
+		Rewind_run_blocks_locked();
 	}
+	pthread_mutex_unlock(&rewind_ctx.job_mx);
+	return NULL;
+}
 
-	memcpy(rewind_ctx.buffer + write_offset, compressed, dest_len);
-
-	RewindEntry* e = &rewind_ctx.entries[rewind_ctx.entry_head];
-	e->offset = write_offset;
-	e->size = dest_len;
-	e->is_keyframe = is_keyframe ? 1 : 0;
-
-	rewind_ctx.head = write_offset + dest_len;
-	if (rewind_ctx.head >= rewind_ctx.capacity)
-		rewind_ctx.head = 0;
+// Compresses every changed block of src (delta'd against prev if not NULL)
+// using the helpers, then packs the entry at the start of scratch.
+// Returns the packed entry size, or 0 on failure.
+static size_t Rewind_compress_blocks(const uint8_t* src, const uint8_t* prev) {
+	pthread_mutex_lock(&rewind_ctx.job_mx);
+	rewind_ctx.job_src = src;
+	rewind_ctx.job_prev = prev;
+	rewind_ctx.job_next_block = 0;
+	rewind_ctx.job_blocks_done = 0;
+	rewind_ctx.job_failed = 0;
+	rewind_ctx.job_seq += 1;
+	pthread_cond_broadcast(&rewind_ctx.job_cv);
+
+	Rewind_run_blocks_locked();
+	while (rewind_ctx.job_blocks_done < rewind_ctx.ring.block_count) {
+		pthread_cond_wait(&rewind_ctx.job_done_cv, &rewind_ctx.job_mx);
+	}
+	int failed = rewind_ctx.job_failed;
+	pthread_mutex_unlock(&rewind_ctx.job_mx);
+	if (failed)
+		return 0;
 
-	rewind_ctx.entry_head = (rewind_ctx.entry_head + 1) % rewind_ctx.entry_capacity;
-	if (rewind_ctx.entry_count < rewind_ctx.entry_capacity) {
-		rewind_ctx.entry_count += 1;
-	} else {
-		Rewind_drop_oldest_locked();
-	}
-	rewind_warn_empty = 0;
-	return 1;
+	return Rewind_pack_entry(&rewind_ctx.ring, rewind_ctx.scratch, rewind_ctx.block_sizes, rewind_ctx.block_bound);
 }
 
 static int Rewind_compress_state(const uint8_t* src, size_t* dest_len, int* is_keyframe_out) {
@@ -1464,9 +1849,9 @@ static int Rewind_compress_state(const uint8_t* src, size_t* dest_len, int* is_k
 		return -1;
 	if (is_keyframe_out)
 		*is_keyframe_out = 1; // default to keyframe
-	if (!rewind_ctx.compress) {
-		*dest_len = rewind_ctx.state_size;
-		memcpy(rewind_ctx.scratch, src, rewind_ctx.state_size);
+	if (!rewind_ctx.ring.compress) {
+		*dest_len = rewind_ctx.ring.state_size;
+		memcpy(rewind_ctx.scratch, src, rewind_ctx.ring.state_size);
 		if (is_keyframe_out)
 			*is_keyframe_out = 1; // raw snapshots are always keyframes
 		if (!rewind_ctx.logged_first) {
@@ -1475,39 +1860,21 @@ static int Rewind_compress_state(const uint8_t* src, size_t* dest_len, int* is_k
 		return 0;
 	}
 
-	// Delta compression: XOR current state with previous state
-	// The result is mostly zeros for similar consecutive states, which compresses much faster
-	const uint8_t* compress_src = src;
-	int used_delta = 0;
-	if (rewind_ctx.has_prev_enc && rewind_ctx.prev_state_enc && rewind_ctx.delta_buf) {
-		size_t state_size = rewind_ctx.state_size;
-		uint8_t* delta = rewind_ctx.delta_buf;
-		const uint8_t* prev = rewind_ctx.prev_state_enc;
-		// Byte-by-byte XOR to avoid unaligned memory access issues
-		for (size_t i = 0; i < state_size; i++) {
-			delta[i] = src[i] ^ prev[i];
-		}
-		compress_src = delta;
-		used_delta = 1;
-	}
+	// Delta compression: XOR current state with previous state, with a full
+	// keyframe every keyframe_interval captures
+	const uint8_t* prev = Rewind_delta_base(&rewind_ctx.ring);
 
-	int max_dst = (int)rewind_ctx.scratch_size;
-	// acceleration: 1=default speed, higher=faster but slightly lower ratio
-	int accel = rewind_ctx.lz4_acceleration > 0 ? rewind_ctx.lz4_acceleration : MINARCH_DEFAULT_REWIND_LZ4_ACCELERATION;
-	int res = LZ4_compress_fast((const char*)compress_src, (char*)rewind_ctx.scratch, (int)rewind_ctx.state_size, max_dst, accel);
-	if (res <= 0)
+	size_t packed = Rewind_compress_blocks(src, prev);
+	if (!packed)
 		return -1;
-	*dest_len = (size_t)res;
+	*dest_len = packed;
 
 	// Report whether this was a keyframe (full state) or delta
 	if (is_keyframe_out)
-		*is_keyframe_out = used_delta ? 0 : 1;
+		*is_keyframe_out = prev ? 0 : 1;
 
-	// Update prev_state_enc with the current state for next delta
-	if (rewind_ctx.prev_state_enc) {
-		memcpy(rewind_ctx.prev_state_enc, src, rewind_ctx.state_size);
-		rewind_ctx.has_prev_enc = 1;
-	}
+	// src is what the next capture gets delta'd against
+	Rewind_encoded(&rewind_ctx.ring, src, prev);
 
 	return 0;
 }
@@ -1534,12 +1901,12 @@ static int Rewind_init(size_t state_size) {
 		buf_mb = REWIND_MAX_BUFFER_MB;
 	size_t buffer_mb = (size_t)buf_mb;
 
-	rewind_ctx.capacity = buffer_mb * 1024 * 1024;
-	rewind_ctx.compress = compress;
-	if (!rewind_ctx.compress && rewind_ctx.capacity <= state_size) {
+	rewind_ctx.ring.capacity = buffer_mb * 1024 * 1024;
+	rewind_ctx.ring.compress = compress;
+	if (!rewind_ctx.ring.compress && rewind_ctx.ring.capacity <= state_size) {
 		LOG_warn("Rewind: raw snapshots (%zu bytes) do not fit in %zu-byte buffer; falling back to compression\n",
-				 state_size, rewind_ctx.capacity);
-		rewind_ctx.compress = 1;
+				 state_size, rewind_ctx.ring.capacity);
+		rewind_ctx.ring.compress = 1;
 	}
 	int accel = rewind_cfg_lz4_acceleration;
 	if (accel < 1)
@@ -1548,13 +1915,13 @@ static int Rewind_init(size_t state_size) {
 		accel = REWIND_MAX_LZ4_ACCELERATION;
 	rewind_ctx.lz4_acceleration = accel;
 	rewind_ctx.logged_first = 0;
-	rewind_ctx.buffer = calloc(1, rewind_ctx.capacity);
-	if (!rewind_ctx.buffer) {
+	rewind_ctx.ring.buffer = calloc(1, rewind_ctx.ring.capacity);
+	if (!rewind_ctx.ring.buffer) {
 		LOG_error("Rewind: failed to allocate buffer\n");
 		return 0;
 	}
 
-	rewind_ctx.state_size = state_size;
+	rewind_ctx.ring.state_size = state_size;
 	rewind_ctx.state_buf = calloc(1, state_size);
 	if (!rewind_ctx.state_buf) {
 		LOG_error("Rewind: failed to allocate state buffer\n");
@@ -1562,8 +1929,11 @@ static int Rewind_init(size_t state_size) {
 		return 0;
 	}
 
-	rewind_ctx.scratch_size = LZ4_compressBound((int)state_size);
-	if (!rewind_ctx.compress)
+	// room for the block size table plus every block at its worst-case compressed size
+	rewind_ctx.ring.block_count = (int)((state_size + REWIND_BLOCK_SIZE - 1) / REWIND_BLOCK_SIZE);
+	rewind_ctx.block_bound = LZ4_compressBound(REWIND_BLOCK_SIZE);
+	rewind_ctx.scratch_size = Rewind_entry_header_size(&rewind_ctx.ring) + (size_t)rewind_ctx.ring.block_count * rewind_ctx.block_bound;
+	if (!rewind_ctx.ring.compress)
 		rewind_ctx.scratch_size = state_size;
 	rewind_ctx.scratch = calloc(1, rewind_ctx.scratch_size);
 	if (!rewind_ctx.scratch) {
@@ -1573,27 +1943,31 @@ static int Rewind_init(size_t state_size) {
 	}
 
 	// Allocate delta compression buffers (separate for encode/decode to avoid race conditions)
-	rewind_ctx.prev_state_enc = calloc(1, state_size);
-	rewind_ctx.prev_state_dec = calloc(1, state_size);
-	rewind_ctx.delta_buf = calloc(1, state_size);
-	if (!rewind_ctx.prev_state_enc || !rewind_ctx.prev_state_dec || !rewind_ctx.delta_buf) {
+	rewind_ctx.ring.prev_state_enc = calloc(1, state_size);
+	rewind_ctx.ring.prev_state_dec = calloc(1, state_size);
+	rewind_ctx.ring.delta_buf = calloc(1, state_size);
+	rewind_ctx.block_sizes = calloc(rewind_ctx.ring.block_count, sizeof(int));
+	if (!rewind_ctx.ring.prev_state_enc || !rewind_ctx.ring.prev_state_dec || !rewind_ctx.ring.delta_buf || !rewind_ctx.block_sizes) {
 		LOG_error("Rewind: failed to allocate delta buffers\n");
 		Rewind_free();
 		return 0;
 	}
-	rewind_ctx.has_prev_enc = 0;
-	rewind_ctx.has_prev_dec = 0;
+	rewind_ctx.ring.has_prev_enc = 0;
+	rewind_ctx.ring.dec_slot = -1;
 
-	int entry_cap = rewind_ctx.capacity / REWIND_ENTRY_SIZE_HINT;
+	int entry_cap = rewind_ctx.ring.capacity / REWIND_ENTRY_SIZE_HINT;
 	if (entry_cap < REWIND_MIN_ENTRIES)
 		entry_cap = REWIND_MIN_ENTRIES;
-	rewind_ctx.entry_capacity = entry_cap;
-	rewind_ctx.entries = calloc(entry_cap, sizeof(RewindEntry));
-	if (!rewind_ctx.entries) {
+	rewind_ctx.ring.entry_capacity = entry_cap;
+	rewind_ctx.ring.entries = calloc(entry_cap, sizeof(RewindEntry));
+	rewind_ctx.ring.keyframes = calloc(entry_cap, sizeof(int));
+	if (!rewind_ctx.ring.entries || !rewind_ctx.ring.keyframes) {
 		LOG_error("Rewind: failed to allocate entry table\n");
 		Rewind_free();
 		return 0;
 	}
+	rewind_ctx.ring.keyframe_interval = rewind_cfg_keyframe_interval < 1 ? 1 : rewind_cfg_keyframe_interval;
+	rewind_ctx.ring.since_keyframe = 0;
 
 	rewind_ctx.granularity_frames = 1;
 	rewind_ctx.interval_ms = gran < 1 ? 1 : gran; // treat granularity as milliseconds always
@@ -1621,8 +1995,23 @@ static int Rewind_init(size_t state_size) {
 	pthread_mutex_init(&rewind_ctx.lock, NULL);
 	pthread_mutex_init(&rewind_ctx.queue_mx, NULL);
 	pthread_cond_init(&rewind_ctx.queue_cv, NULL);
+	pthread_mutex_init(&rewind_ctx.job_mx, NULL);
+	pthread_cond_init(&rewind_ctx.job_cv, NULL);
+	pthread_cond_init(&rewind_ctx.job_done_cv, NULL);
 	rewind_ctx.locks_ready = 1;
 
+	// no point in helpers when the whole state fits in a block or two
+	if (rewind_ctx.ring.compress && rewind_ctx.ring.block_count > 1) {
+		int helpers = MIN(REWIND_COMPRESS_THREADS, rewind_ctx.ring.block_count - 1);
+		for (int i = 0; i < helpers; i++) {
+			if (pthread_create(&rewind_ctx.helpers[i], NULL, Rewind_helper_thread, NULL) != 0) {
+				LOG_warn("Rewind: failed to start compression helper %i\n", i);
+				break;
+			}
+			rewind_ctx.helper_count += 1;
+		}
+	}
+
 	// set up async capture buffers
 	// Larger states need a deeper pool to avoid drops; cap to a modest size to limit RAM
 	rewind_ctx.pool_size = (state_size > REWIND_LARGE_STATE_THRESHOLD) ? REWIND_POOL_SIZE_LARGE : REWIND_POOL_SIZE_SMALL;
@@ -1664,6 +2053,7 @@ static int Rewind_init(size_t state_size) {
 
 static void* Rewind_worker_thread(void* arg) {
 	(void)arg;
+	PWR_pinToCores(CPU_CORE_EFFICIENCY);
 
 	while (1) {
 		pthread_mutex_lock(&rewind_ctx.queue_mx);
@@ -1716,7 +2106,7 @@ static void* Rewind_worker_thread(void* arg) {
 static void Rewind_push(int force) {
 	if (!rewind_ctx.enabled)
 		return;
-	if (!rewind_ctx.buffer || !rewind_ctx.state_buf)
+	if (!rewind_ctx.ring.buffer || !rewind_ctx.state_buf)
 		return;
 
 	uint32_t now_ms = SDL_GetTicks();
@@ -1783,7 +2173,7 @@ static void Rewind_push(int force) {
 
 		if (slot < 0) {
 			// worker is busy; fall back to synchronous capture so we don't miss cadence
-			if (!core.serialize(rewind_ctx.state_buf, rewind_ctx.state_size)) {
+			if (!core.serialize(rewind_ctx.state_buf, rewind_ctx.ring.state_size)) {
 				LOG_error("Rewind: serialize failed (sync fallback)\n");
 				return;
 			}
@@ -1804,7 +2194,7 @@ static void Rewind_push(int force) {
 		}
 
 		uint8_t* buf = rewind_ctx.capture_pool[slot];
-		if (!core.serialize(buf, rewind_ctx.state_size)) {
+		if (!core.serialize(buf, rewind_ctx.ring.state_size)) {
 			LOG_error("Rewind: serialize failed\n");
 			pthread_mutex_lock(&rewind_ctx.queue_mx);
 			rewind_ctx.capture_busy[slot] = 0;
@@ -1825,7 +2215,7 @@ static void Rewind_push(int force) {
 	}
 
 	// synchronous fallback (thread not available)
-	if (!core.serialize(rewind_ctx.state_buf, rewind_ctx.state_size)) {
+	if (!core.serialize(rewind_ctx.state_buf, rewind_ctx.ring.state_size)) {
 		LOG_error("Rewind: serialize failed\n");
 		return;
 	}
@@ -1862,21 +2252,16 @@ static int Rewind_step_back(void) {
 	// On first rewind step, we need to:
 	// 1. Wait for any pending compression to finish (so entry indices are stable)
 	// 2. Copy the last compressed state as our delta reference
-	if (!rewinding && rewind_ctx.compress && rewind_ctx.prev_state_dec) {
+	if (!rewinding && rewind_ctx.ring.compress && rewind_ctx.ring.prev_state_dec) {
 		// Wait for worker to finish all pending compressions
 		Rewind_wait_for_worker_idle();
 		pthread_mutex_lock(&rewind_ctx.lock);
-		if (rewind_ctx.has_prev_enc && rewind_ctx.prev_state_enc) {
-			memcpy(rewind_ctx.prev_state_dec, rewind_ctx.prev_state_enc, rewind_ctx.state_size);
-			rewind_ctx.has_prev_dec = 1;
-		} else {
-			rewind_ctx.has_prev_dec = 0;
-		}
+		Rewind_begin_decode(&rewind_ctx.ring);
 		pthread_mutex_unlock(&rewind_ctx.lock);
 	}
 
 	pthread_mutex_lock(&rewind_ctx.lock);
-	RewindBufferState state = Rewind_buffer_state_locked();
+	RewindBufferState state = Rewind_buffer_state(&rewind_ctx.ring);
 	if (state == REWIND_BUF_EMPTY) {
 		pthread_mutex_unlock(&rewind_ctx.lock);
 		if (!rewind_warn_empty) {
@@ -1885,84 +2270,32 @@ static int Rewind_step_back(void) {
 		return REWIND_STEP_EMPTY;
 	}
 
-	int idx = rewind_ctx.entry_head - 1;
-	if (idx < 0)
-		idx += rewind_ctx.entry_capacity;
-	RewindEntry* e = &rewind_ctx.entries[idx];
-
-	int decode_ok = 1;
-	if (rewind_ctx.compress) {
-		// Decompress into delta_buf first (it may contain XOR delta or full state)
-		int res = LZ4_decompress_safe((const char*)rewind_ctx.buffer + e->offset,
-									  (char*)rewind_ctx.delta_buf, (int)e->size, (int)rewind_ctx.state_size);
-		if (res < (int)rewind_ctx.state_size) {
-			LOG_error("Rewind: decompress failed (res=%i, want=%zu, compressed=%zu, offset=%zu, idx=%d head=%d tail=%d count=%d buf_head=%zu buf_tail=%zu)\n",
-					  res, rewind_ctx.state_size, e->size, e->offset, idx, rewind_ctx.entry_head, rewind_ctx.entry_tail, rewind_ctx.entry_count, rewind_ctx.head, rewind_ctx.tail);
-			decode_ok = 0;
-		} else if (e->is_keyframe) {
-			// This is a keyframe (full state), just copy it directly
-			memcpy(rewind_ctx.state_buf, rewind_ctx.delta_buf, rewind_ctx.state_size);
-			if (rewind_ctx.prev_state_dec) {
-				memcpy(rewind_ctx.prev_state_dec, rewind_ctx.state_buf, rewind_ctx.state_size);
-				rewind_ctx.has_prev_dec = 1;
-			}
-		} else if (rewind_ctx.has_prev_dec && rewind_ctx.prev_state_dec) {
-			// Delta decompression: XOR the delta with prev_state_dec to recover the actual state
-			// prev_state_dec holds the current state (state N), delta = state_N XOR state_(N-1)
-			// So: state_(N-1) = delta XOR state_N = delta XOR prev_state_dec
-			size_t state_size = rewind_ctx.state_size;
-			uint8_t* result = rewind_ctx.state_buf;
-			const uint8_t* delta = rewind_ctx.delta_buf;
-			const uint8_t* prev = rewind_ctx.prev_state_dec;
-			// Byte-by-byte XOR to avoid unaligned memory access issues
-			for (size_t i = 0; i < state_size; i++) {
-				result[i] = delta[i] ^ prev[i];
-			}
-			// Update prev_state_dec to the state we just recovered (for next rewind step)
-			memcpy(rewind_ctx.prev_state_dec, result, state_size);
-		} else {
+	int decoded = Rewind_decode_step(&rewind_ctx.ring, rewind_ctx.state_buf);
+	if (decoded != REWIND_DECODE_OK) {
+		RewindEntry* e = &rewind_ctx.ring.entries[Rewind_entry_slot(&rewind_ctx.ring, rewind_ctx.ring.entry_count - 1)];
+		if (decoded == REWIND_DECODE_ORPHAN) {
 			// Delta frame but no previous state - this shouldn't happen with proper keyframe tracking
-			// Fall back to treating it as a full state (may produce incorrect results)
-			LOG_warn("Rewind: delta frame without previous state, results may be incorrect\n");
-			memcpy(rewind_ctx.state_buf, rewind_ctx.delta_buf, rewind_ctx.state_size);
-			if (rewind_ctx.prev_state_dec) {
-				memcpy(rewind_ctx.prev_state_dec, rewind_ctx.state_buf, rewind_ctx.state_size);
-				rewind_ctx.has_prev_dec = 1;
-			}
-		}
-	} else {
-		if (e->size != rewind_ctx.state_size) {
-			LOG_error("Rewind: raw snapshot size mismatch (got=%zu, want=%zu, offset=%zu)\n",
-					  e->size, rewind_ctx.state_size, e->offset);
-			decode_ok = 0;
+			LOG_warn("Rewind: delta frame without previous state, dropping it\n");
 		} else {
-			memcpy(rewind_ctx.state_buf, rewind_ctx.buffer + e->offset, rewind_ctx.state_size);
+			LOG_error("Rewind: decode failed (want=%zu, stored=%zu, offset=%zu, head=%d tail=%d count=%d buf_head=%zu buf_tail=%zu)\n",
+					  rewind_ctx.ring.state_size, e->size, e->offset, rewind_ctx.ring.entry_head, rewind_ctx.ring.entry_tail,
+					  rewind_ctx.ring.entry_count, rewind_ctx.ring.head, rewind_ctx.ring.tail);
 		}
-	}
-	if (!decode_ok) {
 		// On decode failure, drop the corrupted newest entry instead of oldest
-		rewind_ctx.entry_head = idx;
-		rewind_ctx.entry_count -= 1;
-		if (rewind_ctx.entry_count == 0) {
-			rewind_ctx.head = rewind_ctx.tail = 0;
-		}
+		Rewind_drop_newest(&rewind_ctx.ring);
 		pthread_mutex_unlock(&rewind_ctx.lock);
 		return REWIND_STEP_EMPTY;
 	}
 
-	if (!core.unserialize(rewind_ctx.state_buf, rewind_ctx.state_size)) {
+	if (!core.unserialize(rewind_ctx.state_buf, rewind_ctx.ring.state_size)) {
 		LOG_error("Rewind: unserialize failed\n");
-		Rewind_drop_oldest_locked();
+		Rewind_drop_oldest_group(&rewind_ctx.ring);
 		pthread_mutex_unlock(&rewind_ctx.lock);
 		return REWIND_STEP_EMPTY;
 	}
 
 	// pop newest
-	rewind_ctx.entry_head = idx;
-	rewind_ctx.entry_count -= 1;
-	if (rewind_ctx.entry_count == 0) {
-		rewind_ctx.head = rewind_ctx.tail = 0;
-	}
+	Rewind_drop_newest(&rewind_ctx.ring);
 	pthread_mutex_unlock(&rewind_ctx.lock);
 
 	rewinding = 1;
@@ -1973,7 +2306,7 @@ static int Rewind_step_back(void) {
 // Call this when rewind ends to sync the encode buffer with the last decoded state
 // Also clears old entries that were compressed with a different delta chain
 static void Rewind_sync_encode_state(void) {
-	if (!rewind_ctx.enabled || !rewind_ctx.compress)
+	if (!rewind_ctx.enabled || !rewind_ctx.ring.compress)
 		return;
 	if (!rewinding)
 		return; // Only sync if we were actually rewinding
@@ -1983,14 +2316,49 @@ static void Rewind_sync_encode_state(void) {
 	// The decoder's prev_state_dec contains the state we rewound to.
 	// Use it as the new reference for future compressions so the existing
 	// rewind history remains valid and we can continue rewinding further back.
-	if (rewind_ctx.has_prev_dec && rewind_ctx.prev_state_dec && rewind_ctx.prev_state_enc) {
-		memcpy(rewind_ctx.prev_state_enc, rewind_ctx.prev_state_dec, rewind_ctx.state_size);
-		rewind_ctx.has_prev_enc = 1;
-	} else {
-		rewind_ctx.has_prev_enc = 0;
+	Rewind_continue_from_decoded(&rewind_ctx.ring);
+
+	pthread_mutex_unlock(&rewind_ctx.lock);
+}
+
+// Seconds of history that can be jumped back to from the newest entry
+static int Rewind_seconds_available(void) {
+	if (!rewind_ctx.enabled)
+		return 0;
+	Rewind_wait_for_worker_idle();
+	pthread_mutex_lock(&rewind_ctx.lock);
+	int entries = rewind_ctx.ring.entry_count - 1 - Rewind_oldest_seekable(&rewind_ctx.ring);
+	pthread_mutex_unlock(&rewind_ctx.lock);
+	return entries > 0 ? entries * rewind_ctx.playback_interval_ms / 1000 : 0;
+}
+
+// Restores the state from about seconds ago and discards everything newer,
+// capture then carries on from there. Returns 1 if the core was rewound.
+static int Rewind_jump_back(int seconds) {
+	if (!rewind_ctx.enabled || seconds < 1)
+		return 0;
+	Rewind_wait_for_worker_idle();
+	pthread_mutex_lock(&rewind_ctx.lock);
+	if (!rewind_ctx.ring.entry_count) {
+		pthread_mutex_unlock(&rewind_ctx.lock);
+		return 0;
 	}
 
+	int back = seconds * 1000 / (rewind_ctx.playback_interval_ms > 0 ? rewind_ctx.playback_interval_ms : 1);
+	int pos = Rewind_jump_target(&rewind_ctx.ring, back);
+	if (!Rewind_load(&rewind_ctx.ring, pos, rewind_ctx.state_buf) || !core.unserialize(rewind_ctx.state_buf, rewind_ctx.ring.state_size)) {
+		LOG_error("Rewind: jump back %is failed\n", seconds);
+		pthread_mutex_unlock(&rewind_ctx.lock);
+		return 0;
+	}
+
+	Rewind_truncate(&rewind_ctx.ring, pos);
 	pthread_mutex_unlock(&rewind_ctx.lock);
+
+	rewind_ctx.last_push_ms = SDL_GetTicks();
+	rewind_ctx.last_step_ms = 0;
+	rewind_warn_empty = 0;
+	return 1;
 }
 
 static void Rewind_on_state_change(void) {
@@ -2048,6 +2416,7 @@ static char* resample_labels[] = {
 	"Medium",
 	"High",
 	"Max",
+	"Low Power",
 	NULL};
 static char* rewind_enable_labels[] = {
 	"Off",
@@ -2103,6 +2472,20 @@ static char* rewind_compression_accel_labels[] = {
 	"8 (faster)",
 	"12 (fastest)",
 	NULL};
+static char* rewind_keyframe_interval_values[] = {
+	"15",
+	"30",
+	"60",
+	"120",
+	"240",
+	NULL};
+static char* rewind_keyframe_interval_labels[] = {
+	"15 snapshots",
+	"30 snapshots",
+	"60 snapshots",
+	"120 snapshots",
+	"240 snapshots",
+	NULL};
 static char* ambient_labels[] = {
 	"Off",
 	"All",
@@ -2325,6 +2708,7 @@ enum {
 	FE_OPT_REWIND_GRANULARITY,
 	FE_OPT_REWIND_COMPRESSION,
 	FE_OPT_REWIND_COMPRESSION_ACCEL,
+	FE_OPT_REWIND_KEYFRAME_INTERVAL,
 	FE_OPT_REWIND_AUDIO,
 	FE_OPT_COUNT,
 };
@@ -2340,6 +2724,7 @@ enum {
 	SHORTCUT_HOLD_FF,
 	SHORTCUT_TOGGLE_REWIND,
 	SHORTCUT_HOLD_REWIND,
+	SHORTCUT_JUMP_BACK,
 	SHORTCUT_GAMESWITCHER,
 	SHORTCUT_SCREENSHOT,
 	// Trimui only
@@ -2563,10 +2948,10 @@ static struct Config {
 					 [FE_OPT_RESAMPLING] = {
 						 .key = "minarch__resampling_quality",
 						 .name = "Audio Resampling Quality",
-						 .desc = "Resampling quality higher takes more CPU",
+						 .desc = "Resampling quality higher takes more CPU.\n\"Low Power\" uses a built-in\nfixed-point resampler.",
 						 .default_value = 2,
 						 .value = 2,
-						 .count = 4,
+						 .count = 5,
 						 .values = resample_labels,
 						 .labels = resample_labels,
 					 },
@@ -2731,6 +3116,16 @@ static struct Config {
 						 .values = rewind_compression_accel_values,
 						 .labels = rewind_compression_accel_labels,
 					 },
+					 [FE_OPT_REWIND_KEYFRAME_INTERVAL] = {
+						 .key = "minarch_rewind_keyframe_interval",
+						 .name = "Rewind Keyframe Interval",
+						 .desc = "Snapshots between full keyframes.\nShorter intervals make Jump Back faster\nbut use more memory.",
+						 .default_value = 2, // 60
+						 .value = 2,
+						 .count = 5,
+						 .values = rewind_keyframe_interval_values,
+						 .labels = rewind_keyframe_interval_labels,
+					 },
 					 [FE_OPT_REWIND_AUDIO] = {
 						 .key = "minarch_rewind_audio",
 						 .name = "Rewind audio",
@@ -2942,7 +3337,7 @@ static struct Config {
 		.options = NULL,
 	}},
 	.controls = default_button_mapping,
-	.shortcuts = (ButtonMapping[]){[SHORTCUT_SAVE_STATE] = {"Save State", -1, BTN_ID_NONE, 0}, [SHORTCUT_LOAD_STATE] = {"Load State", -1, BTN_ID_NONE, 0}, [SHORTCUT_RESET_GAME] = {"Reset Game", -1, BTN_ID_NONE, 0}, [SHORTCUT_SAVE_QUIT] = {"Save & Quit", -1, BTN_ID_NONE, 0}, [SHORTCUT_CYCLE_SCALE] = {"Cycle Scaling", -1, BTN_ID_NONE, 0}, [SHORTCUT_CYCLE_EFFECT] = {"Cycle Effect", -1, BTN_ID_NONE, 0}, [SHORTCUT_TOGGLE_FF] = {"Toggle FF", -1, BTN_ID_NONE, 0}, [SHORTCUT_HOLD_FF] = {"Hold FF", -1, BTN_ID_NONE, 0}, [SHORTCUT_TOGGLE_REWIND] = {"Toggle Rewind", -1, BTN_ID_NONE, 0}, [SHORTCUT_HOLD_REWIND] = {"Hold Rewind", -1, BTN_ID_NONE, 0}, [SHORTCUT_GAMESWITCHER] = {"Game Switcher", -1, BTN_ID_NONE, 0}, [SHORTCUT_SCREENSHOT] = {"Screenshot", -1, BTN_ID_NONE, 0},
+	.shortcuts = (ButtonMapping[]){[SHORTCUT_SAVE_STATE] = {"Save State", -1, BTN_ID_NONE, 0}, [SHORTCUT_LOAD_STATE] = {"Load State", -1, BTN_ID_NONE, 0}, [SHORTCUT_RESET_GAME] = {"Reset Game", -1, BTN_ID_NONE, 0}, [SHORTCUT_SAVE_QUIT] = {"Save & Quit", -1, BTN_ID_NONE, 0}, [SHORTCUT_CYCLE_SCALE] = {"Cycle Scaling", -1, BTN_ID_NONE, 0}, [SHORTCUT_CYCLE_EFFECT] = {"Cycle Effect", -1, BTN_ID_NONE, 0}, [SHORTCUT_TOGGLE_FF] = {"Toggle FF", -1, BTN_ID_NONE, 0}, [SHORTCUT_HOLD_FF] = {"Hold FF", -1, BTN_ID_NONE, 0}, [SHORTCUT_TOGGLE_REWIND] = {"Toggle Rewind", -1, BTN_ID_NONE, 0}, [SHORTCUT_HOLD_REWIND] = {"Hold Rewind", -1, BTN_ID_NONE, 0}, [SHORTCUT_JUMP_BACK] = {"Jump Back", -1, BTN_ID_NONE, 0}, [SHORTCUT_GAMESWITCHER] = {"Game Switcher", -1, BTN_ID_NONE, 0}, [SHORTCUT_SCREENSHOT] = {"Screenshot", -1, BTN_ID_NONE, 0},
 								   // Trimui only
 								   [SHORTCUT_TOGGLE_TURBO_A] = {"Toggle Turbo A", -1, BTN_ID_NONE, 0},
 								   [SHORTCUT_TOGGLE_TURBO_B] = {"Toggle Turbo B", -1, BTN_ID_NONE, 0},
@@ -3070,12 +3465,14 @@ static void Config_syncFrontend(char* key, int value) {
 		i = FE_OPT_REWIND_COMPRESSION;
 	} else if (exactMatch(key, config.frontend.options[FE_OPT_REWIND_COMPRESSION_ACCEL].key)) {
 		i = FE_OPT_REWIND_COMPRESSION_ACCEL;
+	} else if (exactMatch(key, config.frontend.options[FE_OPT_REWIND_KEYFRAME_INTERVAL].key)) {
+		i = FE_OPT_REWIND_KEYFRAME_INTERVAL;
 	}
 	if (i == -1)
 		return;
 	Option* option = &config.frontend.options[i];
 	option->value = value;
-	if (i == FE_OPT_REWIND_ENABLE || i == FE_OPT_REWIND_BUFFER || i == FE_OPT_REWIND_GRANULARITY || i == FE_OPT_REWIND_AUDIO || i == FE_OPT_REWIND_COMPRESSION || i == FE_OPT_REWIND_COMPRESSION_ACCEL) {
+	if (i == FE_OPT_REWIND_ENABLE || i == FE_OPT_REWIND_BUFFER || i == FE_OPT_REWIND_GRANULARITY || i == FE_OPT_REWIND_AUDIO || i == FE_OPT_REWIND_COMPRESSION || i == FE_OPT_REWIND_COMPRESSION_ACCEL || i == FE_OPT_REWIND_KEYFRAME_INTERVAL) {
 		const char* sval = option->values && option->values[value] ? option->values[value] : "0";
 		int parsed = 0;
 		if (i == FE_OPT_REWIND_ENABLE || i == FE_OPT_REWIND_AUDIO || i == FE_OPT_REWIND_COMPRESSION) {
@@ -3103,6 +3500,9 @@ static void Config_syncFrontend(char* key, int value) {
 		case FE_OPT_REWIND_COMPRESSION_ACCEL:
 			rewind_cfg_lz4_acceleration = parsed;
 			break;
+		case FE_OPT_REWIND_KEYFRAME_INTERVAL:
+			rewind_cfg_keyframe_interval = parsed;
+			break;
 		}
 		// Only call Rewind_init if core is initialized; early config reads happen before
 		// the core is ready and will be followed by an explicit Rewind_init later
@@ -4327,6 +4727,10 @@ static void input_poll_callback(void) {
 				case SHORTCUT_LOAD_STATE:
 					Menu_loadState();
 					break;
+				case SHORTCUT_JUMP_BACK:
+					if (!rewinding)
+						Rewind_jump_back(REWIND_JUMP_SECONDS);
+					break;
 				case SHORTCUT_SCREENSHOT:
 					Menu_screenshot();
 					break;
@@ -5670,20 +6074,11 @@ static void drawDebugHud(const void* data, unsigned width, unsigned height, size
 	}
 }
 
+static uint32_t last_flip_time = 0;
+
 static void video_refresh_callback_main(const void* data, unsigned width, unsigned height, size_t pitch) {
 	// return;
 
-	Special_render();
-
-	static uint32_t last_flip_time = 0;
-
-	// 10 seems to be the sweet spot that allows 2x in NES and SNES and 8x in GB at 60fps
-	// 14 will let GB hit 10x but NES and SNES will drop to 1.5x at 30fps (not sure why)
-	// but 10 hurts PS...
-	// TODO: 10 was based on rg35xx, probably different results on other supported platforms
-	if (fast_forward && SDL_GetTicks() - last_flip_time < 10)
-		return;
-
 	// FFVII menus
 	// 16: 30/200
 	// 15: 30/180
@@ -5729,156 +6124,6 @@ const void* lastframe = NULL;
 static Uint32* rgbaData = NULL;
 static size_t rgbaDataSize = 0;
 
-// ARM NEON SIMD optimization for pixel format conversion
-#if defined(__ARM_NEON) || defined(__aarch64__)
-#include <arm_neon.h>
-
-// Convert 8 RGB565 pixels to RGBA using NEON (processes 16 bytes → 32 bytes)
-static inline void convert_rgb565_to_rgba_neon(const uint16_t* __restrict src, uint32_t* __restrict dst) {
-	// Load 8 RGB565 pixels (128 bits)
-	uint16x8_t rgb565 = vld1q_u16(src);
-
-	// Extract RGB components using bit manipulation
-	// R: bits 11-15 (5 bits) → scale to 8 bits
-	// G: bits 5-10 (6 bits) → scale to 8 bits
-	// B: bits 0-4 (5 bits) → scale to 8 bits
-
-	uint8x8_t r5 = vmovn_u16(vshrq_n_u16(vandq_u16(rgb565, vdupq_n_u16(0xF800)), 11));
-	uint8x8_t g6 = vmovn_u16(vshrq_n_u16(vandq_u16(rgb565, vdupq_n_u16(0x07E0)), 5));
-	uint8x8_t b5 = vmovn_u16(vandq_u16(rgb565, vdupq_n_u16(0x001F)));
-
-	// Scale 5-bit to 8-bit: (val * 255) / 31 ≈ (val << 3) | (val >> 2)
-	// Scale 6-bit to 8-bit: (val * 255) / 63 ≈ (val << 2) | (val >> 4)
-	uint8x8_t r8 = vorr_u8(vshl_n_u8(r5, 3), vshr_n_u8(r5, 2));
-	uint8x8_t g8 = vorr_u8(vshl_n_u8(g6, 2), vshr_n_u8(g6, 4));
-	uint8x8_t b8 = vorr_u8(vshl_n_u8(b5, 3), vshr_n_u8(b5, 2));
-	uint8x8_t a8 = vdup_n_u8(0xFF);
-
-	// Interleave RGBA
-	uint8x8x4_t rgba;
-	rgba.val[0] = r8;
-	rgba.val[1] = g8;
-	rgba.val[2] = b8;
-	rgba.val[3] = a8;
-
-	// Store as RGBA (32 bytes)
-	vst4_u8((uint8_t*)dst, rgba);
-}
-
-// Convert 4 XRGB8888 pixels to RGBA using NEON (processes 16 bytes → 16 bytes)
-static inline void convert_xrgb8888_to_rgba_neon(const uint32_t* __restrict src, uint32_t* __restrict dst) {
-	// Load 4 XRGB8888 pixels
-	uint32x4_t xrgb = vld1q_u32(src);
-
-	// XRGB8888: 0xXXRRGGBB → RGBA: 0xAABBGGRR
-	// Extract components
-	uint32x4_t r = vandq_u32(vshrq_n_u32(xrgb, 16), vdupq_n_u32(0xFF));
-	uint32x4_t g = vandq_u32(vshrq_n_u32(xrgb, 8), vdupq_n_u32(0xFF));
-	uint32x4_t b = vandq_u32(xrgb, vdupq_n_u32(0xFF));
-	uint32x4_t a = vdupq_n_u32(0xFF);
-
-	// Reconstruct as RGBA
-	uint32x4_t rgba = vorrq_u32(vorrq_u32(r, vshlq_n_u32(g, 8)), vorrq_u32(vshlq_n_u32(b, 16), vshlq_n_u32(a, 24)));
-
-	vst1q_u32(dst, rgba);
-}
-#endif
-
-// Convert XRGB8888 to RGBA format (handles pitch correctly)
-static void convert_xrgb8888_to_rgba(const void* src, uint32_t* dst, unsigned width, unsigned height, size_t pitch) {
-	const uint32_t* srcData = (const uint32_t*)src;
-	unsigned srcPitchInPixels = pitch / sizeof(uint32_t);
-
-	for (unsigned y = 0; y < height; y++) {
-		const uint32_t* srcRow = srcData + y * srcPitchInPixels;
-		uint32_t* dstRow = dst + y * width;
-		unsigned x = 0;
-
-#if defined(__ARM_NEON) || defined(__aarch64__)
-		// NEON: process 4 pixels at a time
-		for (; x + 3 < width; x += 4) {
-			convert_xrgb8888_to_rgba_neon(srcRow + x, dstRow + x);
-		}
-#else
-		// Scalar: process 4 pixels at a time for better cache utilization
-		for (; x + 3 < width; x += 4) {
-			uint32_t p0 = srcRow[x], p1 = srcRow[x + 1], p2 = srcRow[x + 2], p3 = srcRow[x + 3];
-
-			// Swizzle: XRGB -> RGBA (swap R and B, set A=0xFF)
-			dstRow[x] = (p0 & 0x0000FF00) | ((p0 & 0x00FF0000) >> 16) | ((p0 & 0x000000FF) << 16) | 0xFF000000;
-			dstRow[x + 1] = (p1 & 0x0000FF00) | ((p1 & 0x00FF0000) >> 16) | ((p1 & 0x000000FF) << 16) | 0xFF000000;
-			dstRow[x + 2] = (p2 & 0x0000FF00) | ((p2 & 0x00FF0000) >> 16) | ((p2 & 0x000000FF) << 16) | 0xFF000000;
-			dstRow[x + 3] = (p3 & 0x0000FF00) | ((p3 & 0x00FF0000) >> 16) | ((p3 & 0x000000FF) << 16) | 0xFF000000;
-		}
-#endif
-		// Handle remaining pixels in the row
-		for (; x < width; x++) {
-			uint32_t pixel = srcRow[x];
-			dstRow[x] = (pixel & 0x0000FF00) | ((pixel & 0x00FF0000) >> 16) | ((pixel & 0x000000FF) << 16) | 0xFF000000;
-		}
-	}
-}
-
-// Convert RGB565 to RGBA format (handles pitch correctly)
-static void convert_rgb565_to_rgba(const void* src, uint32_t* dst, unsigned width, unsigned height, size_t pitch) {
-	const uint16_t* srcData = (const uint16_t*)src;
-	unsigned srcPitchInPixels = pitch / sizeof(uint16_t);
-
-	for (unsigned y = 0; y < height; y++) {
-		const uint16_t* srcRow = srcData + y * srcPitchInPixels;
-		uint32_t* dstRow = dst + y * width;
-		unsigned x = 0;
-
-#if defined(__ARM_NEON) || defined(__aarch64__)
-		// NEON: process 8 pixels at a time
-		for (; x + 7 < width; x += 8) {
-			convert_rgb565_to_rgba_neon(srcRow + x, dstRow + x);
-		}
-#else
-		// Scalar: process 4 pixels at a time
-		for (; x + 3 < width; x += 4) {
-			uint16_t p0 = srcRow[x], p1 = srcRow[x + 1], p2 = srcRow[x + 2], p3 = srcRow[x + 3];
-
-			uint8_t r0 = (p0 >> 11) & 0x1F, g0 = (p0 >> 5) & 0x3F, b0 = p0 & 0x1F;
-			uint8_t r1 = (p1 >> 11) & 0x1F, g1 = (p1 >> 5) & 0x3F, b1 = p1 & 0x1F;
-			uint8_t r2 = (p2 >> 11) & 0x1F, g2 = (p2 >> 5) & 0x3F, b2 = p2 & 0x1F;
-			uint8_t r3 = (p3 >> 11) & 0x1F, g3 = (p3 >> 5) & 0x3F, b3 = p3 & 0x1F;
-
-			r0 = (r0 << 3) | (r0 >> 2);
-			g0 = (g0 << 2) | (g0 >> 4);
-			b0 = (b0 << 3) | (b0 >> 2);
-			r1 = (r1 << 3) | (r1 >> 2);
-			g1 = (g1 << 2) | (g1 >> 4);
-			b1 = (b1 << 3) | (b1 >> 2);
-			r2 = (r2 << 3) | (r2 >> 2);
-			g2 = (g2 << 2) | (g2 >> 4);
-			b2 = (b2 << 3) | (b2 >> 2);
-			r3 = (r3 << 3) | (r3 >> 2);
-			g3 = (g3 << 2) | (g3 >> 4);
-			b3 = (b3 << 3) | (b3 >> 2);
-
-			dstRow[x] = (0xFF << 24) | (b0 << 16) | (g0 << 8) | r0;
-			dstRow[x + 1] = (0xFF << 24) | (b1 << 16) | (g1 << 8) | r1;
-			dstRow[x + 2] = (0xFF << 24) | (b2 << 16) | (g2 << 8) | r2;
-			dstRow[x + 3] = (0xFF << 24) | (b3 << 16) | (g3 << 8) | r3;
-		}
-#endif
-		// Handle remaining pixels in the row
-		for (; x < width; x++) {
-			uint16_t pixel = srcRow[x];
-			uint8_t r = (pixel >> 11) & 0x1F;
-			uint8_t g = (pixel >> 5) & 0x3F;
-			uint8_t b = pixel & 0x1F;
-
-			r = (r << 3) | (r >> 2);
-			g = (g << 2) | (g >> 4);
-			b = (b << 3) | (b >> 2);
-
-			dstRow[x] = (0xFF << 24) | (b << 16) | (g << 8) | r;
-		}
-	}
-}
-
 static void video_refresh_callback(const void* data, unsigned width, unsigned height, size_t pitch) {
 	// Log NEON availability once on first call
 	static int neon_logged = 0;
@@ -5895,6 +6140,16 @@ static void video_refresh_callback(const void* data, unsigned width, unsigned he
 	if (quit)
 		return;
 
+	Special_render();
+
+	// drop fast forward frames before converting them, most never get shown
+	// 10 seems to be the sweet spot that allows 2x in NES and SNES and 8x in GB at 60fps
+	// 14 will let GB hit 10x but NES and SNES will drop to 1.5x at 30fps (not sure why)
+	// but 10 hurts PS...
+	// TODO: 10 was based on rg35xx, probably different results on other supported platforms
+	if (fast_forward && SDL_GetTicks() - last_flip_time < 10)
+		return;
+
 	// Allocate RGBA buffer if needed
 	if (!rgbaData || rgbaDataSize != width * height) {
 		if (rgbaData)
@@ -6229,6 +6484,8 @@ void Menu_beforeSleep() {
 	SRAM_write();
 	RTC_write();
 	State_autosave();
+	// the device may be about to power off
+	State_waitForWrite(NULL);
 	putFile(AUTO_RESUME_PATH, game.path + strlen(SDCARD_PATH));
 
 	PWR_setCPUSpeed(CPU_SPEED_MENU);
@@ -8201,7 +8458,7 @@ static void Menu_updateState(void) {
 	sprintf(menu.bmp_path, "%s/%s.%d.bmp", menu.minui_dir, game.name, menu.slot);
 	sprintf(menu.txt_path, "%s/%s.%d.txt", menu.minui_dir, game.name, menu.slot);
 
-	menu.save_exists = exists(save_path);
+	menu.save_exists = exists(save_path) || State_isWriting(save_path); // a new slot may still be on its way to disk
 	menu.preview_exists = menu.save_exists && exists(menu.bmp_path);
 }
 
@@ -8291,13 +8548,10 @@ static void Menu_saveState(void) {
 
 	state_slot = menu.slot;
 	putInt(menu.slot_path, menu.slot);
-	int success = State_write();
-
-	// Show notification if enabled
-	if (CFG_getNotifyManualSave()) {
+	// User-facing slots are 1-8 (internal 0-7), notified once the write finishes
+	if (!State_write(menu.slot + 1) && CFG_getNotifyManualSave()) {
 		char msg[NOTIFICATION_MAX_MESSAGE];
-		// User-facing slots are 1-8 (internal 0-7)
-		snprintf(msg, sizeof(msg), success ? "State Saved - Slot %d" : "Save Failed - Slot %d", menu.slot + 1);
+		snprintf(msg, sizeof(msg), "Save Failed - Slot %d", menu.slot + 1);
 		Notification_push(NOTIFICATION_SAVE_STATE, msg, NULL);
 	}
 }
@@ -8395,6 +8649,11 @@ static void Menu_loop(void) {
 	int selected = 0; // resets every launch
 	Menu_initState();
 
+	// with a single disc, left/right on Continue scrubs back through the rewind buffer
+	int rewind_max = menu.total_discs > 1 ? 0 : Rewind_seconds_available();
+	int rewind_seconds = 0;
+	char rewind_name[16];
+
 	int status = STATUS_CONT; // TODO: no longer used?
 	IndicatorType show_setting = INDICATOR_NONE;
 	bool dirty = true;
@@ -8427,6 +8686,10 @@ static void Menu_loop(void) {
 					menu.disc += menu.total_discs;
 				dirty = true;
 				sprintf(disc_name, "Disc %i", menu.disc + 1);
+			} else if (rewind_max && selected == ITEM_CONT) {
+				if (rewind_seconds < rewind_max)
+					rewind_seconds += 1;
+				dirty = true;
 			} else if (selected == ITEM_SAVE || selected == ITEM_LOAD) {
 				menu.slot -= 1;
 				if (menu.slot < 0)
@@ -8440,6 +8703,10 @@ static void Menu_loop(void) {
 					menu.disc -= menu.total_discs;
 				dirty = true;
 				sprintf(disc_name, "Disc %i", menu.disc + 1);
+			} else if (rewind_max && selected == ITEM_CONT) {
+				if (rewind_seconds > 0)
+					rewind_seconds -= 1;
+				dirty = true;
 			} else if (selected == ITEM_SAVE || selected == ITEM_LOAD) {
 				menu.slot += 1;
 				if (menu.slot >= MENU_SLOT_COUNT)
@@ -8463,6 +8730,8 @@ static void Menu_loop(void) {
 					char* disc_path = menu.disc_paths[menu.disc];
 					Game_changeDisc(disc_path);
 				} else {
+					if (rewind_seconds)
+						Rewind_jump_back(rewind_seconds);
 					status = STATUS_CONT;
 				}
 				show_menu = 0;
@@ -8550,6 +8819,15 @@ static void Menu_loop(void) {
 						SDL_FreeSurface(text);
 					}
 
+					// rewind scrub
+					if (rewind_seconds && i == ITEM_CONT) {
+						sprintf(rewind_name, "-%is", rewind_seconds);
+						GFX_blitPillDark(ASSET_WHITE_PILL, screen, &(SDL_Rect){SCALE1(PADDING), SCALE1(oy + PADDING), screen->w - SCALE1(PADDING * 2), SCALE1(PILL_SIZE)});
+						text = TTF_RenderUTF8_Blended(font.large, rewind_name, text_color);
+						SDL_BlitSurface(text, NULL, screen, &(SDL_Rect){screen->w - SCALE1(PADDING + BUTTON_PADDING) - text->w, SCALE1(oy + PADDING + 4)});
+						SDL_FreeSurface(text);
+					}
+
 					TTF_SizeUTF8(font.large, item, &ow, NULL);
 					ow += SCALE1(BUTTON_PADDING * 2);
 
@@ -8653,8 +8931,10 @@ static void Menu_loop(void) {
 
 		if (!HAS_POWER_BUTTON)
 			PWR_disableSleep();
-	} else if (exists(NOUI_PATH))
+	} else if (exists(NOUI_PATH)) {
+		State_waitForWrite(NULL);
 		PWR_powerOff(0); // TODO: won't work with threaded core, only check this once per launch
+	}
 
 
 	SDL_FreeSurface(backing);
@@ -8931,6 +9211,8 @@ int main(int argc, char* argv[]) {
 		// Process RetroAchievements for this frame
 		RA_doFrame();
 
+		State_pollWrites();
+
 		// Update and render notifications overlay
 		Notification_update(SDL_GetTicks());
 
@@ -9024,6 +9306,7 @@ finish:
 	RA_unloadGame();
 	RA_quit();
 
+	State_quitWriter();
 	Game_close();
 	Rewind_free();
 	Core_unload();
@@ -0,0 +1,601 @@
+#ifndef __REWIND_RING_H__
+#define __REWIND_RING_H__
+
+/**
+ * The rewind history behind minarch's rewind: a byte ring of captured
+ * states plus a ring of entries describing where each one lives in it.
+ *
+ * Compressed captures are split into REWIND_BLOCK_SIZE blocks that are
+ * LZ4 compressed independently. Every keyframe_interval captures a full
+ * state (keyframe) is stored, the ones in between only keep the blocks
+ * that changed, XOR'd against the capture before. Any entry can be
+ * rebuilt from the keyframe at or before it, so eviction always drops a
+ * whole keyframe group. Raw captures are stored as is and are all
+ * keyframes.
+ *
+ * Nothing in here locks or talks to the core: minarch.c serializes the
+ * states, runs Rewind_encode_block on its helper threads and holds
+ * rewind_ctx.lock around everything else. Kept free of SDL so
+ * tests/rewind_test.c can fill, wrap and scrub it with made up states.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <lz4.h>
+
+#define REWIND_BLOCK_SIZE (16 * 1024) // states are delta'd and compressed in independent blocks of this size
+
+typedef struct {
+	size_t offset;
+	size_t size;
+	uint8_t is_keyframe; // 1 if this entry is a full state, 0 if delta-encoded
+} RewindEntry;
+
+typedef enum {
+	REWIND_BUF_EMPTY = 0,
+	REWIND_BUF_HAS_DATA = 1,
+	REWIND_BUF_FULL = 2
+} RewindBufferState;
+
+typedef struct RewindRing {
+	uint8_t* buffer;
+	size_t capacity;
+	size_t head;
+	size_t tail;
+
+	RewindEntry* entries;
+	int entry_capacity;
+	int entry_head;
+	int entry_tail;
+	int entry_count;
+
+	size_t state_size;
+	int block_count; // of REWIND_BLOCK_SIZE, the last one can be short
+	int compress;	 // 0 stores raw snapshots
+
+	// Delta compression: store XOR of current vs previous state
+	uint8_t* prev_state_enc; // previous state for delta encoding (compression)
+	uint8_t* prev_state_dec; // previous state for delta decoding (decompression)
+	uint8_t* delta_buf;		 // scratch buffer for XOR result
+	int has_prev_enc;		 // 1 if prev_state_enc is valid
+	int dec_slot;			 // entry whose state prev_state_dec holds, -1 if none
+
+	// Every keyframe_interval captures a full state is stored so any entry can be
+	// rebuilt from the keyframe before it. keyframes is a ring of the entry slots
+	// holding keyframes, oldest first, and eviction drops whole keyframe groups.
+	int* keyframes;
+	int keyframe_head;
+	int keyframe_tail;
+	int keyframe_count;
+	int keyframe_interval;
+	int since_keyframe; // captures since the last keyframe, including it
+} RewindRing;
+
+///////////////////////////////
+
+static inline RewindBufferState Rewind_buffer_state(RewindRing* ring) {
+	if (ring->entry_count == 0)
+		return REWIND_BUF_EMPTY;
+	// head == tail with entries means the ring buffer wrapped and is full
+	if (ring->head == ring->tail)
+		return REWIND_BUF_FULL;
+	return REWIND_BUF_HAS_DATA;
+}
+
+static inline size_t Rewind_free_space(RewindRing* ring) {
+	RewindBufferState state = Rewind_buffer_state(ring);
+	if (state == REWIND_BUF_FULL)
+		return 0;
+	if (state == REWIND_BUF_EMPTY)
+		return ring->capacity;
+	if (ring->head >= ring->tail)
+		return ring->capacity - (ring->head - ring->tail);
+	else
+		return ring->tail - ring->head;
+}
+
+// Position of an entry slot counted from the oldest entry
+static inline int Rewind_entry_pos(RewindRing* ring, int slot) {
+	int pos = slot - ring->entry_tail;
+	if (pos < 0)
+		pos += ring->entry_capacity;
+	return pos;
+}
+static inline int Rewind_entry_slot(RewindRing* ring, int pos) {
+	return (ring->entry_tail + pos) % ring->entry_capacity;
+}
+
+// Position of the newest keyframe at or before pos, -1 if there is none
+static inline int Rewind_keyframe_before(RewindRing* ring, int pos) {
+	int lo = 0;
+	int hi = ring->keyframe_count - 1;
+	int found = -1;
+	while (lo <= hi) {
+		int mid = (lo + hi) / 2;
+		int key_pos = Rewind_entry_pos(ring, ring->keyframes[(ring->keyframe_tail + mid) % ring->entry_capacity]);
+		if (key_pos <= pos) {
+			found = key_pos;
+			lo = mid + 1;
+		} else {
+			hi = mid - 1;
+		}
+	}
+	return found;
+}
+
+// Forgets every entry, the buffers stay allocated
+static inline void Rewind_clear(RewindRing* ring) {
+	ring->head = ring->tail = 0;
+	ring->entry_head = ring->entry_tail = ring->entry_count = 0;
+	ring->keyframe_head = ring->keyframe_tail = ring->keyframe_count = 0;
+	ring->since_keyframe = 0;
+	ring->has_prev_enc = 0;
+	ring->dec_slot = -1;
+}
+
+static inline void Rewind_drop_oldest(RewindRing* ring) {
+	if (!ring->entry_count)
+		return;
+	if (ring->keyframe_count && ring->keyframes[ring->keyframe_tail] == ring->entry_tail) {
+		ring->keyframe_tail = (ring->keyframe_tail + 1) % ring->entry_capacity;
+		ring->keyframe_count -= 1;
+	}
+	if (ring->dec_slot == ring->entry_tail)
+		ring->dec_slot = -1;
+	RewindEntry* e = &ring->entries[ring->entry_tail];
+	ring->tail = (e->offset + e->size) % ring->capacity;
+	ring->entry_tail = (ring->entry_tail + 1) % ring->entry_capacity;
+	ring->entry_count -= 1;
+	if (ring->entry_count == 0) {
+		ring->head = ring->tail = 0;
+	}
+}
+
+// Drops the oldest keyframe group so the ring always starts on a keyframe.
+// When only one group is left, entries go one at a time instead: the deltas
+// left behind can't be sought to but still step back fine from the newest state.
+static inline void Rewind_drop_oldest_group(RewindRing* ring) {
+	Rewind_drop_oldest(ring);
+	if (ring->keyframe_count == 0)
+		return;
+	while (ring->entry_count && ring->entry_tail != ring->keyframes[ring->keyframe_tail]) {
+		Rewind_drop_oldest(ring);
+	}
+}
+
+static inline void Rewind_drop_newest(RewindRing* ring) {
+	if (!ring->entry_count)
+		return;
+	int idx = ring->entry_head - 1;
+	if (idx < 0)
+		idx += ring->entry_capacity;
+	if (ring->keyframe_count) {
+		int key = ring->keyframe_head - 1;
+		if (key < 0)
+			key += ring->entry_capacity;
+		if (ring->keyframes[key] == idx) {
+			ring->keyframe_head = key;
+			ring->keyframe_count -= 1;
+		}
+	}
+	if (ring->dec_slot == idx)
+		ring->dec_slot = -1;
+	ring->entry_head = idx;
+	ring->entry_count -= 1;
+	if (ring->entry_count == 0) {
+		ring->head = ring->tail = 0;
+	} else {
+		// let the next write reuse the space
+		ring->head = ring->entries[idx].offset;
+	}
+}
+
+// Check if an entry overlaps with range [range_start, range_end) in a non-wrapping buffer region
+static inline int Rewind_entry_overlaps_range(RewindRing* ring, int entry_idx, size_t range_start, size_t range_end) {
+	RewindEntry* e = &ring->entries[entry_idx];
+	size_t e_start = e->offset;
+	size_t e_end = e->offset + e->size;
+	// Check for overlap: ranges overlap if start < other_end AND other_start < end
+	return (e_start < range_end) && (range_start < e_end);
+}
+
+enum {
+	REWIND_WRITE_NO_ROOM = -1,	// couldn't evict enough, shouldn't happen
+	REWIND_WRITE_TOO_BIG = 0,	// the entry is larger than the whole buffer
+	REWIND_WRITE_OK = 1,
+};
+
+// Appends an entry, evicting the oldest keyframe groups to make room. On
+// failure the next capture has to be a keyframe, its delta would reference
+// a state that isn't in the ring.
+static inline int Rewind_write_entry(RewindRing* ring, const uint8_t* compressed, size_t dest_len, int is_keyframe) {
+	if (dest_len >= ring->capacity) {
+		ring->has_prev_enc = 0;
+		return REWIND_WRITE_TOO_BIG;
+	}
+
+	// If the entry table is full, drop the oldest group *before* writing so we don't
+	// overwrite its metadata (entry_head == entry_tail when full).
+	if (ring->entry_count == ring->entry_capacity) {
+		Rewind_drop_oldest_group(ring);
+	}
+
+	size_t write_offset = ring->head;
+
+	// If this write would go past the end of the buffer, wrap to 0
+	if (write_offset + dest_len > ring->capacity) {
+		write_offset = 0;
+		ring->head = 0;
+		if (ring->entry_count == 0) {
+			ring->tail = 0;
+		}
+	}
+
+	// Drop any entries that overlap with the region we're about to write: [write_offset, write_offset + dest_len)
+	// We need to check all entries from tail to head and drop any that overlap.
+	// Since entries are stored oldest-to-newest, we drop from oldest while they overlap.
+	while (ring->entry_count > 0) {
+		int oldest_idx = ring->entry_tail;
+		if (Rewind_entry_overlaps_range(ring, oldest_idx, write_offset, write_offset + dest_len)) {
+			Rewind_drop_oldest_group(ring);
+		} else {
+			break;
+		}
+	}
+
+	// Still need to make room based on free space calculation
+	while (ring->entry_count > 0 && Rewind_free_space(ring) <= dest_len) {
+		Rewind_drop_oldest_group(ring);
+	}
+
+	// Safety check: if we still can't fit, there's a logic error
+	if (Rewind_free_space(ring) <= dest_len && ring->entry_count > 0) {
+		ring->has_prev_enc = 0;
+		return REWIND_WRITE_NO_ROOM;
+	}
+
+	memcpy(ring->buffer + write_offset, compressed, dest_len);
+
+	RewindEntry* e = &ring->entries[ring->entry_head];
+	e->offset = write_offset;
+	e->size = dest_len;
+	e->is_keyframe = is_keyframe ? 1 : 0;
+	if (e->is_keyframe) {
+		ring->keyframes[ring->keyframe_head] = ring->entry_head;
+		ring->keyframe_head = (ring->keyframe_head + 1) % ring->entry_capacity;
+		ring->keyframe_count += 1;
+	} else if (ring->entry_count == 0) {
+		// everything it was based on got evicted, start a new group right away
+		ring->since_keyframe = ring->keyframe_interval;
+	}
+
+	ring->head = write_offset + dest_len;
+	if (ring->head >= ring->capacity)
+		ring->head = 0;
+
+	ring->entry_head = (ring->entry_head + 1) % ring->entry_capacity;
+	if (ring->entry_count < ring->entry_capacity) {
+		ring->entry_count += 1;
+	} else {
+		Rewind_drop_oldest(ring);
+	}
+	return REWIND_WRITE_OK;
+}
+
+///////////////////////////////
+
+#if defined(__ARM_NEON) || defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+// dst = a ^ b, 16 bytes at a time with NEON, a word at a time otherwise
+static inline void Rewind_xor_block(uint8_t* dst, const uint8_t* a, const uint8_t* b, size_t len) {
+	size_t i = 0;
+#if defined(__ARM_NEON) || defined(__aarch64__)
+	for (; i + 16 <= len; i += 16) {
+		vst1q_u8(dst + i, veorq_u8(vld1q_u8(a + i), vld1q_u8(b + i)));
+	}
+#else
+	for (; i + sizeof(uint64_t) <= len; i += sizeof(uint64_t)) {
+		uint64_t x, y;
+		memcpy(&x, a + i, sizeof(x));
+		memcpy(&y, b + i, sizeof(y));
+		x ^= y;
+		memcpy(dst + i, &x, sizeof(x));
+	}
+#endif
+	for (; i < len; i++) {
+		dst[i] = a[i] ^ b[i];
+	}
+}
+
+static inline size_t Rewind_block_len(RewindRing* ring, int block) {
+	size_t offset = (size_t)block * REWIND_BLOCK_SIZE;
+	size_t remaining = ring->state_size - offset;
+	return remaining < REWIND_BLOCK_SIZE ? remaining : REWIND_BLOCK_SIZE;
+}
+
+// Compressed entries start with a bitmap of the blocks that changed since
+// the previous state, then a uint16 compressed size per changed block,
+// then the changed blocks themselves, in order. Keyframes mark every block
+// as changed. A frame where nothing changed is just the (zeroed) bitmap.
+static inline size_t Rewind_entry_bitmap_size(RewindRing* ring) {
+	return (ring->block_count + 7) / 8;
+}
+
+// worst case, with every block changed
+static inline size_t Rewind_entry_header_size(RewindRing* ring) {
+	return Rewind_entry_bitmap_size(ring) + ring->block_count * sizeof(uint16_t);
+}
+
+// The state the next capture gets delta'd against, NULL when it has to be a keyframe
+static inline const uint8_t* Rewind_delta_base(RewindRing* ring) {
+	if (ring->has_prev_enc && ring->prev_state_enc && ring->delta_buf &&
+		ring->since_keyframe < ring->keyframe_interval)
+		return ring->prev_state_enc;
+	return NULL;
+}
+
+// XOR-deltas src against prev (unless it's a keyframe, prev NULL) and
+// compresses one block of it into dst. Returns the compressed size, 0 if
+// the block is unchanged, or -1 on failure. Different blocks can be
+// encoded at the same time, each only touches its own part of delta_buf.
+static inline int Rewind_encode_block(RewindRing* ring, int block, const uint8_t* src, const uint8_t* prev,
+									  uint8_t* dst, int dst_size, int acceleration) {
+	size_t offset = (size_t)block * REWIND_BLOCK_SIZE;
+	size_t len = Rewind_block_len(ring, block);
+	src += offset;
+	if (prev) {
+		// most of the state is untouched from frame to frame on 8/16-bit cores
+		if (memcmp(src, prev + offset, len) == 0)
+			return 0;
+		// The result is mostly zeros for similar consecutive states, which compresses much faster
+		Rewind_xor_block(ring->delta_buf + offset, src, prev + offset, len);
+		src = ring->delta_buf + offset;
+	}
+	// acceleration: 1=default speed, higher=faster but slightly lower ratio
+	int res = LZ4_compress_fast((const char*)src, (char*)dst, (int)len, dst_size, acceleration);
+	return res > 0 ? res : -1;
+}
+
+// Packs an entry at the start of scratch from blocks encoded into fixed
+// slots of slot_size bytes after the worst case header, block_sizes being
+// what Rewind_encode_block returned for each. Returns the entry size.
+static inline size_t Rewind_pack_entry(RewindRing* ring, uint8_t* scratch, const int* block_sizes, int slot_size) {
+	// the packed header is never longer than the worst case the block slots start after
+	uint8_t* bitmap = scratch;
+	size_t bitmap_size = Rewind_entry_bitmap_size(ring);
+	memset(bitmap, 0, bitmap_size);
+	size_t packed = bitmap_size;
+	for (int i = 0; i < ring->block_count; i++) {
+		if (!block_sizes[i])
+			continue;
+		bitmap[i >> 3] |= 1 << (i & 7);
+		uint16_t size = (uint16_t)block_sizes[i];
+		memcpy(scratch + packed, &size, sizeof(size));
+		packed += sizeof(size);
+	}
+
+	// close the gaps between the fixed block slots, always moving data towards the start
+	size_t header_size = Rewind_entry_header_size(ring);
+	for (int i = 0; i < ring->block_count; i++) {
+		int size = block_sizes[i];
+		if (!size)
+			continue;
+		uint8_t* slot = scratch + header_size + (size_t)i * slot_size;
+		if (slot != scratch + packed)
+			memmove(scratch + packed, slot, size);
+		packed += size;
+	}
+	return packed;
+}
+
+// Once src has been encoded against base (NULL for a keyframe) it becomes
+// the base of the next capture
+static inline void Rewind_encoded(RewindRing* ring, const uint8_t* src, const uint8_t* base) {
+	ring->since_keyframe = base ? ring->since_keyframe + 1 : 1;
+	if (ring->prev_state_enc) {
+		memcpy(ring->prev_state_enc, src, ring->state_size);
+		ring->has_prev_enc = 1;
+	}
+}
+
+// Applies an entry on top of state: keyframe blocks replace it, changed
+// delta blocks are XOR'd into it and unchanged blocks are left alone.
+// state is left partially updated on failure.
+static inline int Rewind_apply_entry(RewindRing* ring, const uint8_t* entry, size_t entry_size, int is_keyframe, uint8_t* state) {
+	size_t bitmap_size = Rewind_entry_bitmap_size(ring);
+	if (entry_size < bitmap_size)
+		return 0;
+
+	const uint8_t* bitmap = entry;
+	int changed = 0;
+	for (int i = 0; i < ring->block_count; i++) {
+		if (bitmap[i >> 3] & (1 << (i & 7)))
+			changed += 1;
+	}
+
+	size_t sizes_pos = bitmap_size;
+	size_t pos = bitmap_size + changed * sizeof(uint16_t);
+	if (pos > entry_size)
+		return 0;
+
+	for (int i = 0; i < ring->block_count; i++) {
+		if (!(bitmap[i >> 3] & (1 << (i & 7))))
+			continue;
+
+		uint16_t size;
+		memcpy(&size, entry + sizes_pos, sizeof(size)); // entries aren't aligned in the ring
+		sizes_pos += sizeof(size);
+		if (pos + size > entry_size)
+			return 0;
+
+		size_t offset = (size_t)i * REWIND_BLOCK_SIZE;
+		size_t len = Rewind_block_len(ring, i);
+		uint8_t* dst = is_keyframe ? state + offset : ring->delta_buf + offset;
+		int res = LZ4_decompress_safe((const char*)entry + pos, (char*)dst, size, (int)len);
+		if (res != (int)len)
+			return 0;
+		if (!is_keyframe)
+			Rewind_xor_block(state + offset, state + offset, dst, len);
+		pos += size;
+	}
+	return 1;
+}
+
+///////////////////////////////
+
+// Rebuilds the state of the entry at pos into prev_state_dec. One entry back
+// from the state already decoded is a single delta applied in place, anything
+// else replays forward from the keyframe at or before pos (or from the decoded
+// state when that's closer), so the cost is bounded by the keyframe interval.
+static inline int Rewind_seek(RewindRing* ring, int pos) {
+	if (pos < 0 || pos >= ring->entry_count)
+		return 0;
+	int dec_pos = ring->dec_slot >= 0 ? Rewind_entry_pos(ring, ring->dec_slot) : -1;
+	if (dec_pos == pos)
+		return 1;
+
+	if (dec_pos == pos + 1 && !ring->entries[ring->dec_slot].is_keyframe) {
+		RewindEntry* e = &ring->entries[ring->dec_slot];
+		ring->dec_slot = -1; // half applied on failure
+		if (!Rewind_apply_entry(ring, ring->buffer + e->offset, e->size, 0, ring->prev_state_dec))
+			return 0;
+		ring->dec_slot = Rewind_entry_slot(ring, pos);
+		return 1;
+	}
+
+	int from = Rewind_keyframe_before(ring, pos);
+	if (from < 0)
+		return 0;
+	if (dec_pos >= from && dec_pos < pos)
+		from = dec_pos + 1;
+
+	ring->dec_slot = -1;
+	for (int i = from; i <= pos; i++) {
+		RewindEntry* e = &ring->entries[Rewind_entry_slot(ring, i)];
+		if (!Rewind_apply_entry(ring, ring->buffer + e->offset, e->size, e->is_keyframe, ring->prev_state_dec))
+			return 0;
+	}
+	ring->dec_slot = Rewind_entry_slot(ring, pos);
+	return 1;
+}
+
+// Starts decoding from the newest entry, whose state prev_state_enc
+// still holds. Everything encoded has to be written before this.
+static inline void Rewind_begin_decode(RewindRing* ring) {
+	if (ring->has_prev_enc && ring->prev_state_enc && ring->entry_count) {
+		memcpy(ring->prev_state_dec, ring->prev_state_enc, ring->state_size);
+		ring->dec_slot = Rewind_entry_slot(ring, ring->entry_count - 1);
+	} else {
+		ring->dec_slot = -1;
+	}
+}
+
+enum {
+	REWIND_DECODE_FAILED = -1, // corrupt entry or a failed seek
+	REWIND_DECODE_ORPHAN = 0,  // the newest entry is a delta with nothing to apply it to
+	REWIND_DECODE_OK = 1,
+};
+
+// Decodes the state one step back restores into out. Compressed, that is
+// the entry before the newest one: prev_state_dec holds state N and delta
+// N = state_N XOR state_(N-1), so usually one delta applied in place; when
+// entry N starts a keyframe group, state_(N-1) is replayed from the
+// previous keyframe instead. The oldest entry has nothing before it in the
+// ring: a keyframe just shows itself and a delta still recovers the state
+// it was based on. Raw, it's the newest snapshot itself. Either way the
+// caller drops the newest entry next.
+static inline int Rewind_decode_step(RewindRing* ring, uint8_t* out) {
+	if (!ring->entry_count)
+		return REWIND_DECODE_FAILED;
+	int pos = ring->entry_count - 1;
+	int idx = Rewind_entry_slot(ring, pos);
+	RewindEntry* e = &ring->entries[idx];
+
+	if (!ring->compress) {
+		if (e->size != ring->state_size)
+			return REWIND_DECODE_FAILED;
+		memcpy(out, ring->buffer + e->offset, ring->state_size);
+		return REWIND_DECODE_OK;
+	}
+
+	if (pos > 0 && Rewind_seek(ring, pos - 1)) {
+		// prev_state_dec now holds the entry that becomes the newest
+	} else if (!e->is_keyframe && ring->dec_slot != idx) {
+		return REWIND_DECODE_ORPHAN;
+	} else {
+		int ok;
+		if (e->is_keyframe) {
+			ok = Rewind_seek(ring, pos);
+		} else {
+			ring->dec_slot = -1;
+			ok = Rewind_apply_entry(ring, ring->buffer + e->offset, e->size, 0, ring->prev_state_dec);
+		}
+		if (!ok)
+			return REWIND_DECODE_FAILED;
+	}
+	memcpy(out, ring->prev_state_dec, ring->state_size);
+	return REWIND_DECODE_OK;
+}
+
+// Makes the decoded state the reference for the next capture, which then
+// continues the keyframe group that state belongs to
+static inline void Rewind_continue_from_decoded(RewindRing* ring) {
+	int pos = ring->dec_slot >= 0 ? Rewind_entry_pos(ring, ring->dec_slot) : -1;
+	if (pos < 0 || pos != ring->entry_count - 1 || !ring->prev_state_enc) {
+		ring->has_prev_enc = 0;
+		return;
+	}
+	memcpy(ring->prev_state_enc, ring->prev_state_dec, ring->state_size);
+	ring->has_prev_enc = 1;
+	int key = Rewind_keyframe_before(ring, pos);
+	ring->since_keyframe = key >= 0 ? pos - key + 1 : ring->keyframe_interval;
+}
+
+// Oldest position that can be restored: compressed history can only be
+// sought to from the oldest keyframe on. entry_count if nothing can.
+static inline int Rewind_oldest_seekable(RewindRing* ring) {
+	if (!ring->compress)
+		return 0;
+	return ring->keyframe_count ? Rewind_entry_pos(ring, ring->keyframes[ring->keyframe_tail]) : ring->entry_count;
+}
+
+// Position of the entry back entries before the newest one, clamped to
+// what can be restored
+static inline int Rewind_jump_target(RewindRing* ring, int back) {
+	int pos = ring->entry_count - 1 - back;
+	int oldest = Rewind_oldest_seekable(ring);
+	return pos < oldest ? oldest : pos;
+}
+
+// Restores the state of the entry at pos into out
+static inline int Rewind_load(RewindRing* ring, int pos, uint8_t* out) {
+	if (pos < 0 || pos >= ring->entry_count)
+		return 0;
+	if (ring->compress) {
+		if (!Rewind_seek(ring, pos))
+			return 0;
+		memcpy(out, ring->prev_state_dec, ring->state_size);
+		return 1;
+	}
+	RewindEntry* e = &ring->entries[Rewind_entry_slot(ring, pos)];
+	if (e->size != ring->state_size)
+		return 0;
+	memcpy(out, ring->buffer + e->offset, ring->state_size);
+	return 1;
+}
+
+// Discards everything newer than the entry at pos, which was just loaded,
+// so capture carries on from there
+static inline void Rewind_truncate(RewindRing* ring, int pos) {
+	while (ring->entry_count - 1 > pos) {
+		Rewind_drop_newest(ring);
+	}
+	if (ring->compress)
+		Rewind_continue_from_decoded(ring);
+}
+
+#endif // __REWIND_RING_H__
@@ -0,0 +1,373 @@
+// checks rewind_ring.h with made up states: fills the ring until it wraps
+// and evicts, seeks to every entry (the ones right at the wrap included),
+// scrubs back through it the way Rewind_step_back does, carries on
+// capturing from the state it scrubbed to, and jumps back the way the
+// Jump Back shortcut and the menu do. Every restored state is compared to
+// the one that was captured. Raw snapshots get the same treatment.
+//
+//	make rewind_test && ./rewind_test
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "rewind_ring.h"
+
+// three blocks, the last one short
+#define STATE_SIZE (2 * REWIND_BLOCK_SIZE + 5000)
+#define NOISE_OFFSET (2 * REWIND_BLOCK_SIZE + 16)
+#define NOISE_MAX 3100
+
+#define KEYFRAME_INTERVAL 8
+#define CAPTURES 600
+
+static int failures = 0;
+
+#define CHECK(cond, ...)         \
+	do {                         \
+		if (!(cond)) {           \
+			printf("  FAIL: ");  \
+			printf(__VA_ARGS__); \
+			printf("\n");        \
+			if (++failures > 20) \
+				exit(1);         \
+		}                        \
+	} while (0)
+
+///////////////////////////////
+
+// The state of capture id, computable from id alone so any entry can be
+// checked: a counter that changes every capture, a block that only
+// changes every tenth one and a patch of noise that compresses badly and
+// varies in length, so entries come in all sizes and the ring wraps at a
+// different spot every time round.
+static void makeState(int id, uint8_t* state) {
+	for (int k = 0; k < STATE_SIZE; k++)
+		state[k] = (uint8_t)(k * 131 + (k >> 8));
+	for (int k = 0; k < 256; k++)
+		state[k] ^= (uint8_t)(id + k);
+	for (int k = REWIND_BLOCK_SIZE; k < REWIND_BLOCK_SIZE + 64; k++)
+		state[k] ^= (uint8_t)(id / 10 * 7);
+	uint32_t seed = (uint32_t)id * 2654435761u;
+	int len = 100 + (id * 97) % (NOISE_MAX - 100);
+	for (int k = NOISE_OFFSET; k < NOISE_OFFSET + len; k++) {
+		seed = seed * 1103515245u + 12345u;
+		state[k] = seed >> 24;
+	}
+}
+
+typedef struct Harness {
+	RewindRing ring;
+	int* ids; // capture id per entry slot
+	uint8_t* scratch;
+	int* block_sizes;
+	int block_bound;
+	uint8_t* state;
+	uint8_t* expected;
+	int next_id;
+	int wraps;
+	int evictions; // writes that dropped a group
+} Harness;
+
+static void setup(Harness* h, size_t capacity, int entry_capacity, int compress) {
+	memset(h, 0, sizeof(Harness));
+	RewindRing* ring = &h->ring;
+	ring->capacity = capacity;
+	ring->buffer = calloc(1, capacity);
+	ring->entry_capacity = entry_capacity;
+	ring->entries = calloc(entry_capacity, sizeof(RewindEntry));
+	ring->keyframes = calloc(entry_capacity, sizeof(int));
+	ring->state_size = STATE_SIZE;
+	ring->block_count = (STATE_SIZE + REWIND_BLOCK_SIZE - 1) / REWIND_BLOCK_SIZE;
+	ring->compress = compress;
+	ring->prev_state_enc = calloc(1, STATE_SIZE);
+	ring->prev_state_dec = calloc(1, STATE_SIZE);
+	ring->delta_buf = calloc(1, STATE_SIZE);
+	ring->keyframe_interval = compress ? KEYFRAME_INTERVAL : 1;
+	Rewind_clear(ring);
+
+	h->ids = calloc(entry_capacity, sizeof(int));
+	h->block_bound = LZ4_compressBound(REWIND_BLOCK_SIZE);
+	h->scratch = calloc(1, Rewind_entry_header_size(ring) + (size_t)ring->block_count * h->block_bound + STATE_SIZE);
+	h->block_sizes = calloc(ring->block_count, sizeof(int));
+	h->state = calloc(1, STATE_SIZE);
+	h->expected = calloc(1, STATE_SIZE);
+}
+
+static void teardown(Harness* h) {
+	RewindRing* ring = &h->ring;
+	free(ring->buffer);
+	free(ring->entries);
+	free(ring->keyframes);
+	free(ring->prev_state_enc);
+	free(ring->prev_state_dec);
+	free(ring->delta_buf);
+	free(h->ids);
+	free(h->scratch);
+	free(h->block_sizes);
+	free(h->state);
+	free(h->expected);
+}
+
+// what Rewind_compress_state and the worker do, minus the threads
+static void capture(Harness* h) {
+	RewindRing* ring = &h->ring;
+	int id = h->next_id++;
+	makeState(id, h->state);
+
+	size_t size;
+	int is_keyframe = 1;
+	if (ring->compress) {
+		const uint8_t* base = Rewind_delta_base(ring);
+		uint8_t* slots = h->scratch + Rewind_entry_header_size(ring);
+		for (int i = 0; i < ring->block_count; i++) {
+			h->block_sizes[i] = Rewind_encode_block(ring, i, h->state, base, slots + (size_t)i * h->block_bound, h->block_bound, 2);
+			CHECK(h->block_sizes[i] >= 0, "capture %i: block %i failed to compress", id, i);
+		}
+		size = Rewind_pack_entry(ring, h->scratch, h->block_sizes, h->block_bound);
+		Rewind_encoded(ring, h->state, base);
+		is_keyframe = !base;
+	} else {
+		memcpy(h->scratch, h->state, STATE_SIZE);
+		size = STATE_SIZE;
+	}
+
+	size_t old_head = ring->head;
+	int old_count = ring->entry_count;
+	int slot = ring->entry_head;
+	int res = Rewind_write_entry(ring, h->scratch, size, is_keyframe);
+	CHECK(res == REWIND_WRITE_OK, "capture %i: write failed (%i)", id, res);
+	if (res != REWIND_WRITE_OK)
+		return;
+	h->ids[slot] = id;
+	if (ring->entries[slot].offset < old_head)
+		h->wraps += 1;
+	if (ring->entry_count <= old_count)
+		h->evictions += 1;
+}
+
+static int idAt(Harness* h, int pos) {
+	return h->ids[Rewind_entry_slot(&h->ring, pos)];
+}
+
+// the bookkeeping has to agree with the entries themselves
+static void checkInvariants(Harness* h, const char* when) {
+	RewindRing* ring = &h->ring;
+	int keyframes = 0;
+	int group = 0;
+	for (int pos = 0; pos < ring->entry_count; pos++) {
+		RewindEntry* e = &ring->entries[Rewind_entry_slot(ring, pos)];
+		CHECK(e->offset + e->size <= ring->capacity, "%s: entry %i runs past the end of the buffer", when, pos);
+		group = e->is_keyframe ? 1 : group + 1;
+		CHECK(group <= ring->keyframe_interval, "%s: entry %i is %i into its keyframe group", when, pos, group);
+		if (e->is_keyframe) {
+			int listed = ring->keyframes[(ring->keyframe_tail + keyframes) % ring->entry_capacity];
+			CHECK(listed == Rewind_entry_slot(ring, pos), "%s: keyframe %i is entry %i, the ring lists slot %i", when, keyframes, pos, listed);
+			keyframes += 1;
+		}
+		if (pos)
+			CHECK(idAt(h, pos) > idAt(h, pos - 1), "%s: entry %i (capture %i) after capture %i", when, pos, idAt(h, pos), idAt(h, pos - 1));
+		for (int other = 0; other < pos; other++) {
+			RewindEntry* o = &ring->entries[Rewind_entry_slot(ring, other)];
+			CHECK(e->offset >= o->offset + o->size || o->offset >= e->offset + e->size,
+				  "%s: entries %i and %i overlap in the buffer", when, other, pos);
+		}
+	}
+	CHECK(keyframes == ring->keyframe_count, "%s: %i keyframes, keyframe_count %i", when, keyframes, ring->keyframe_count);
+	// eviction drops whole groups, so the ring starts on a keyframe as long as there is one
+	CHECK(!ring->keyframe_count || ring->entries[ring->entry_tail].is_keyframe, "%s: oldest entry is a delta", when);
+}
+
+static void checkLoad(Harness* h, int pos, const char* when) {
+	int id = idAt(h, pos);
+	makeState(id, h->expected);
+	memset(h->state, 0xAA, STATE_SIZE);
+	int ok = Rewind_load(&h->ring, pos, h->state);
+	CHECK(ok, "%s: loading entry %i (capture %i) failed", when, pos, id);
+	CHECK(!ok || memcmp(h->state, h->expected, STATE_SIZE) == 0, "%s: entry %i isn't capture %i", when, pos, id);
+}
+
+///////////////////////////////
+
+// Fills a ring much smaller than the history so it wraps and evicts many
+// times over, checking the bookkeeping after every write
+static void checkFill(Harness* h, int captures, const char* name) {
+	for (int i = 0; i < captures; i++) {
+		capture(h);
+		checkInvariants(h, name);
+	}
+	CHECK(h->wraps >= 3, "%s: the buffer only wrapped %i times", name, h->wraps);
+	CHECK(h->evictions > 0, "%s: nothing was evicted", name);
+	printf("%s: %i captures, %i entries left (%i keyframes), wrapped %i times\n",
+		   name, captures, h->ring.entry_count, h->ring.keyframe_count, h->wraps);
+}
+
+// Every seekable entry, oldest to newest, newest to oldest and in a
+// scattered order so every path through Rewind_seek gets used: replay
+// from a keyframe, continuing forward from the decoded state and one
+// delta back in place
+static void checkSeekAll(Harness* h, const char* name) {
+	RewindRing* ring = &h->ring;
+	int oldest = Rewind_oldest_seekable(ring);
+	int count = ring->entry_count;
+	CHECK(oldest < count, "%s: nothing can be sought to", name);
+	for (int pos = oldest; pos < count; pos++)
+		checkLoad(h, pos, name);
+	for (int pos = count - 1; pos >= oldest; pos--)
+		checkLoad(h, pos, name);
+	for (int i = 0; i < count; i++)
+		checkLoad(h, oldest + (i * 7) % (count - oldest), name);
+}
+
+// Position of the first entry written back at the start of the buffer
+// after the one before it, -1 if the ring doesn't wrap right now
+static int wrapPos(Harness* h) {
+	RewindRing* ring = &h->ring;
+	for (int pos = Rewind_oldest_seekable(ring) + 1; pos < ring->entry_count; pos++) {
+		RewindEntry* e = &ring->entries[Rewind_entry_slot(ring, pos)];
+		RewindEntry* before = &ring->entries[Rewind_entry_slot(ring, pos - 1)];
+		if (e->offset < before->offset)
+			return pos;
+	}
+	return -1;
+}
+
+// The entry at the start of the buffer and the one before it at the end,
+// reached by a replay that crosses the wrap, one delta back across it and
+// stepping forward over it again
+static void checkSeekWrap(Harness* h, const char* name) {
+	// keep capturing until the wrap is somewhere in the middle
+	for (int i = 0; i < 1000 && wrapPos(h) < 0; i++) {
+		capture(h);
+		checkInvariants(h, name);
+	}
+	int pos = wrapPos(h);
+	CHECK(pos > 0, "%s: the ring never held a wrap", name);
+	if (pos <= 0)
+		return;
+
+	h->ring.dec_slot = -1;
+	checkLoad(h, pos, name);
+	checkLoad(h, pos - 1, name);
+	checkLoad(h, pos, name);
+	if (pos + 1 < h->ring.entry_count) {
+		checkLoad(h, pos + 1, name);
+		checkLoad(h, pos, name);
+	}
+}
+
+// Steps back the way Rewind_step_back does: each step restores the entry
+// before the newest one and then drops the newest
+static void checkScrub(Harness* h, int steps, const char* name) {
+	RewindRing* ring = &h->ring;
+	Rewind_begin_decode(ring);
+	for (int i = 0; i < steps && ring->entry_count > 1; i++) {
+		int count = ring->entry_count;
+		int restores = ring->compress ? count - 2 : count - 1;
+		int id = idAt(h, restores);
+		int res = Rewind_decode_step(ring, h->state);
+		CHECK(res == REWIND_DECODE_OK, "%s: step %i from %i entries failed (%i)", name, i, count, res);
+		makeState(id, h->expected);
+		CHECK(res != REWIND_DECODE_OK || memcmp(h->state, h->expected, STATE_SIZE) == 0,
+			  "%s: step %i from %i entries isn't capture %i", name, i, count, id);
+		RewindEntry* e = &ring->entries[Rewind_entry_slot(ring, count - 1)];
+		size_t size = e->size;
+		size_t free_space = Rewind_free_space(ring);
+		Rewind_drop_newest(ring);
+		// the next capture goes where the dropped one was
+		CHECK(Rewind_free_space(ring) >= free_space + size, "%s: step %i: dropping %zu bytes only freed %zu",
+			  name, i, size, Rewind_free_space(ring) - free_space);
+		checkInvariants(h, name);
+	}
+}
+
+// what Rewind_sync_encode_state does when the rewind button is let go
+// Captures on top of the state the ring was just rewound to, the first
+// of them is delta'd against it
+static void checkCarryOn(Harness* h, int captures, const char* name) {
+	RewindRing* ring = &h->ring;
+	int first = ring->entry_count;
+	CHECK(!ring->compress || ring->has_prev_enc, "%s: rewound state not picked up for the next capture", name);
+	for (int i = 0; i < captures; i++) {
+		capture(h);
+		checkInvariants(h, name);
+	}
+	int oldest = Rewind_oldest_seekable(ring);
+	for (int pos = first > oldest ? first - 1 : oldest; pos < ring->entry_count; pos++)
+		checkLoad(h, pos, name);
+}
+
+static void checkContinue(Harness* h, int captures, const char* name) {
+	if (h->ring.compress)
+		Rewind_continue_from_decoded(&h->ring);
+	checkCarryOn(h, captures, name);
+}
+
+// Rewind_jump_back: load, drop everything newer, carry on from there
+static void checkJump(Harness* h, int back, const char* name) {
+	RewindRing* ring = &h->ring;
+	int pos = Rewind_jump_target(ring, back);
+	CHECK(pos >= Rewind_oldest_seekable(ring) && pos < ring->entry_count, "%s: jump target %i out of range", name, pos);
+	int id = idAt(h, pos);
+	checkLoad(h, pos, name);
+	Rewind_truncate(ring, pos);
+	CHECK(ring->entry_count == pos + 1 && idAt(h, pos) == id, "%s: jump left %i entries, expected %i", name, ring->entry_count, pos + 1);
+	checkInvariants(h, name);
+	checkCarryOn(h, KEYFRAME_INTERVAL * 2 + 3, name);
+}
+
+// Drops the oldest groups until one is left, that one then goes an entry
+// at a time and only what's left of it can be scrubbed, never sought to
+static void checkLastGroup(Harness* h, const char* name) {
+	RewindRing* ring = &h->ring;
+	while (ring->keyframe_count > 1)
+		Rewind_drop_oldest_group(ring);
+	checkInvariants(h, name);
+	CHECK(ring->entries[ring->entry_tail].is_keyframe, "%s: last group doesn't start on a keyframe", name);
+	Rewind_drop_oldest_group(ring);
+	CHECK(ring->keyframe_count == 0, "%s: last keyframe still listed", name);
+	CHECK(Rewind_oldest_seekable(ring) == ring->entry_count, "%s: deltas without a keyframe are seekable", name);
+	if (ring->entry_count > 1) {
+		Rewind_begin_decode(ring);
+		checkScrub(h, ring->entry_count - 1, name);
+	}
+}
+
+static void run(const char* name, size_t capacity, int entry_capacity, int compress) {
+	Harness h;
+	setup(&h, capacity, entry_capacity, compress);
+	checkFill(&h, compress ? CAPTURES : CAPTURES / 10, name);
+	checkSeekAll(&h, name);
+	checkSeekWrap(&h, name);
+	checkScrub(&h, h.ring.entry_count / 2, name);
+	checkContinue(&h, KEYFRAME_INTERVAL * 3 + 5, name);
+	checkSeekAll(&h, name);
+	checkJump(&h, KEYFRAME_INTERVAL + 3, name);
+	checkJump(&h, 1000, name); // clamped to the oldest keyframe
+	checkSeekAll(&h, name);
+	if (compress)
+		checkLastGroup(&h, name);
+
+	// a reset drops it all, capture starts over with a keyframe
+	Rewind_clear(&h.ring);
+	CHECK(Rewind_buffer_state(&h.ring) == REWIND_BUF_EMPTY, "%s: not empty after a clear", name);
+	capture(&h);
+	CHECK(h.ring.entries[Rewind_entry_slot(&h.ring, 0)].is_keyframe, "%s: first capture after a clear is a delta", name);
+	checkLoad(&h, 0, name);
+	teardown(&h);
+}
+
+int main(void) {
+	// byte ring the limit, a few keyframe groups fit
+	run("compressed", 64 * 1024, 1024, 1);
+	// entry table the limit, full before the bytes are
+	run("compressed, small table", 256 * 1024, 3 * KEYFRAME_INTERVAL + 5, 1);
+	run("raw", STATE_SIZE * 5 + STATE_SIZE / 2, 64, 0);
+
+	if (failures) {
+		printf("%i failures\n", failures);
+		return 1;
+	}
+	printf("ok\n");
+	return 0;
+}
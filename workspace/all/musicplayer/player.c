@@ -13,6 +13,7 @@
 #include <samplerate.h>
 #include <SDL2/SDL_image.h>
 #include "api.h"
+#include "audio_convert.h"
 #include "msettings.h"
 
 // Include dr_libs for audio decoding (header-only libraries)
@@ -1134,15 +1135,12 @@ static size_t resample_chunk(int16_t* input, size_t input_frames,
 	// Convert leftover frames to float first
 	size_t float_idx = 0;
 	if (leftover_count > 0 && player.resample_leftover) {
-		for (size_t i = 0; i < leftover_count * AUDIO_CHANNELS; i++) {
-			float_in[float_idx++] = player.resample_leftover[i] / 32768.0f;
-		}
+		AUDIO_s16ToFloat(player.resample_leftover, float_in, leftover_count * AUDIO_CHANNELS);
+		float_idx = leftover_count * AUDIO_CHANNELS;
 	}
 
 	// Convert new input frames to float
-	for (size_t i = 0; i < input_frames * AUDIO_CHANNELS; i++) {
-		float_in[float_idx++] = input[i] / 32768.0f;
-	}
+	AUDIO_s16ToFloat(input, float_in + float_idx, input_frames * AUDIO_CHANNELS);
 
 	// Setup conversion
 	SRC_DATA src_data;
@@ -1163,14 +1161,7 @@ static size_t resample_chunk(int16_t* input, size_t input_frames,
 
 	// Convert output back to int16
 	size_t output_frames = src_data.output_frames_gen;
-	for (size_t i = 0; i < output_frames * AUDIO_CHANNELS; i++) {
-		float sample = float_out[i] * 32767.0f;
-		if (sample > 32767.0f)
-			sample = 32767.0f;
-		if (sample < -32768.0f)
-			sample = -32768.0f;
-		output[i] = (int16_t)sample;
-	}
+	AUDIO_floatToS16(float_out, output, output_frames * AUDIO_CHANNELS);
 
 	// Store unconsumed input frames for next call
 	size_t frames_used = src_data.input_frames_used;
@@ -1,14 +1,19 @@
 #include <dirent.h>
 #include <ctype.h>
 #include <unistd.h>
+#include <pthread.h>
+#include <sys/stat.h>
 #include "content.h"
+#include "romindex.h"
+#include "searchindex.h"
+#include "imgloader.h"
 #include "shortcuts.h"
 #include "api.h"
 #include "config.h"
 
 static bool _simple_mode = false;
 
-// EMULIST_CACHE_PATH and ROMINDEX_CACHE_PATH defined in defines.h
+// ROMINDEX_CACHE_PATH defined in defines.h
 
 void Content_setSimpleMode(bool mode) {
 	_simple_mode = mode;
@@ -25,6 +30,30 @@ int getIndexChar(char* str) {
 	return i;
 }
 
+static time_t getMtime(const char* path) {
+	struct stat st;
+	if (stat(path, &st) != 0)
+		return 0;
+	return st.st_mtime;
+}
+
+// trusts d_type when the filesystem fills it in, otherwise falls back to stat
+static int isDirEntry(struct dirent* dp, const char* full_path) {
+	if (dp->d_type != DT_UNKNOWN)
+		return dp->d_type == DT_DIR;
+	struct stat st;
+	return stat(full_path, &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+// console folders collate with their siblings, eg. `GB (GB)` and `GB (GAMBATTE)`
+static void getCollatedPath(char* path, char* collated_path) {
+	strncpy(collated_path, path, MAX_PATH - 1);
+	collated_path[MAX_PATH - 1] = '\0';
+	char* tmp = strrchr(collated_path, '(');
+	if (tmp)
+		tmp[1] = '\0';
+}
+
 void getUniqueName(Entry* entry, char* out_name) {
 	char* slash = strrchr(entry->path, '/');
 	if (!slash)
@@ -46,26 +75,8 @@ void Directory_index(Directory* self) {
 	snprintf(map_path, sizeof(map_path), "%s/map.txt", is_collection ? COLLECTIONS_PATH : self->path);
 
 	if (exists(map_path)) {
-		FILE* file = fopen(map_path, "r");
-		if (file) {
-			map = Hash_new();
-			char line[MAX_PATH];
-			while (fgets(line, sizeof(line), file) != NULL) {
-				normalizeNewline(line);
-				trimTrailingNewlines(line);
-				if (strlen(line) == 0)
-					continue; // skip empty lines
-
-				char* tmp = strchr(line, '\t');
-				if (tmp) {
-					tmp[0] = '\0';
-					char* key = line;
-					char* value = tmp + 1;
-					Hash_set(map, key, value);
-				}
-			}
-			fclose(file);
-
+		map = Hash_new();
+		if (Hash_loadMap(map, map_path) > 0) {
 			bool resort = false;
 			bool filter = false;
 			for (int i = 0; i < self->entries->count; i++) {
@@ -76,8 +87,7 @@ void Directory_index(Directory* self) {
 				char* filename = slash + 1;
 				char* alias = Hash_get(map, filename);
 				if (alias) {
-					free(entry->name);
-					entry->name = strdup(alias);
+					Entry_setName(entry, alias);
 					resort = true;
 					if (!filter && hide(entry->name))
 						filter = true;
@@ -109,10 +119,8 @@ void Directory_index(Directory* self) {
 		Entry* entry = self->entries->items[i];
 
 		if (prior != NULL && exactMatch(prior->name, entry->name)) {
-			free(prior->unique);
-			free(entry->unique);
-			prior->unique = NULL;
-			entry->unique = NULL;
+			Entry_setUnique(prior, NULL);
+			Entry_setUnique(entry, NULL);
 
 			char* prior_slash = strrchr(prior->path, '/');
 			char* entry_slash = strrchr(entry->path, '/');
@@ -125,17 +133,17 @@ void Directory_index(Directory* self) {
 					getUniqueName(prior, prior_unique);
 					getUniqueName(entry, entry_unique);
 
-					prior->unique = strdup(prior_unique);
-					entry->unique = strdup(entry_unique);
+					Entry_setUnique(prior, prior_unique);
+					Entry_setUnique(entry, entry_unique);
 				} else {
-					prior->unique = strdup(prior_filename);
-					entry->unique = strdup(entry_filename);
+					Entry_setUnique(prior, prior_filename);
+					Entry_setUnique(entry, entry_filename);
 				}
 			}
 		}
 
 		if (!skip_index) {
-			int a = getIndexChar(entry->name);
+			int a = Entry_indexChar(entry);
 			if (a != alpha) {
 				index = self->alphas.count;
 				IntArray_push(&self->alphas, i);
@@ -151,35 +159,206 @@ void Directory_index(Directory* self) {
 		Hash_free(map);
 }
 
+///////////////////////////////////////
+// Directory snapshots
+//
+// Plain folders are expensive to build (readdir, display names, sort,
+// map.txt, unique names, alphas) and don't change while we're running,
+// so the last few are kept fully built and copied back out on reopen.
+// A snapshot is keyed by the mtimes of every folder that fed into it.
+
+#define DIRECTORY_SNAPSHOT_COUNT 8
+
+typedef struct DirectorySnapshot {
+	char* path;
+	uint64_t stamp;
+	Array* entries;
+	IntArray alphas;
+	unsigned long last_used;
+} DirectorySnapshot;
+
+static DirectorySnapshot snapshots[DIRECTORY_SNAPSHOT_COUNT];
+static unsigned long snapshot_clock = 0;
+
+static uint64_t mixStamp(uint64_t stamp, time_t mtime) {
+	return (stamp ^ (uint64_t)mtime) * 1099511628211ull;
+}
+
+// 0 means don't cache
+static uint64_t getDirectoryStamp(char* path) {
+	time_t mtime = getMtime(path);
+	// FAT only has 2 second resolution, a folder that changed just now
+	// might change again without its mtime moving
+	if (!mtime || time(NULL) - mtime < 2)
+		return 0;
+
+	char map_path[MAX_PATH];
+	snprintf(map_path, sizeof(map_path), "%s/map.txt", prefixMatch(COLLECTIONS_PATH, path) ? COLLECTIONS_PATH : path);
+	uint64_t stamp = mixStamp(mixStamp(14695981039346656037ull, mtime), getMtime(map_path));
+
+	if (isConsoleDir(path)) { // collated siblings count too, in any order
+		char collated_path[MAX_PATH];
+		getCollatedPath(path, collated_path);
+		stamp = mixStamp(stamp, getMtime(ROMS_PATH));
+
+		uint64_t siblings = 0; // a sum so readdir order doesn't matter
+		DIR* dh = opendir(ROMS_PATH);
+		if (dh) {
+			struct dirent* dp;
+			char full_path[MAX_PATH];
+			while ((dp = readdir(dh)) != NULL) {
+				if (hide(dp->d_name))
+					continue;
+				snprintf(full_path, sizeof(full_path), "%s/%s", ROMS_PATH, dp->d_name);
+				if (!exactMatch(full_path, path) && prefixMatch(collated_path, full_path))
+					siblings += mixStamp(14695981039346656037ull, getMtime(full_path));
+			}
+			closedir(dh);
+		}
+		stamp = mixStamp(stamp, siblings);
+	}
+	return stamp ? stamp : 1;
+}
+
+static void DirectorySnapshot_clear(DirectorySnapshot* snapshot) {
+	if (!snapshot->path)
+		return;
+	free(snapshot->path);
+	EntryArray_free(snapshot->entries);
+	memset(snapshot, 0, sizeof(DirectorySnapshot));
+}
+
+static Array* copyEntries(Array* entries) {
+	Array* copy = Array_new();
+	for (int i = 0; i < entries->count; i++)
+		Array_push(copy, Entry_copy(entries->items[i]));
+	return copy;
+}
+
+static int restoreSnapshot(Directory* self, uint64_t stamp) {
+	for (int i = 0; i < DIRECTORY_SNAPSHOT_COUNT; i++) {
+		DirectorySnapshot* snapshot = &snapshots[i];
+		if (!snapshot->path || !exactMatch(snapshot->path, self->path))
+			continue;
+		if (snapshot->stamp != stamp) {
+			DirectorySnapshot_clear(snapshot);
+			return 0;
+		}
+		self->entries = copyEntries(snapshot->entries);
+		self->alphas = snapshot->alphas;
+		snapshot->last_used = ++snapshot_clock;
+		return 1;
+	}
+	return 0;
+}
+
+static void storeSnapshot(Directory* self, uint64_t stamp) {
+	DirectorySnapshot* slot = &snapshots[0];
+	for (int i = 0; i < DIRECTORY_SNAPSHOT_COUNT; i++) {
+		DirectorySnapshot* snapshot = &snapshots[i];
+		if (!snapshot->path || exactMatch(snapshot->path, self->path)) {
+			slot = snapshot;
+			break;
+		}
+		if (snapshot->last_used < slot->last_used)
+			slot = snapshot;
+	}
+	DirectorySnapshot_clear(slot);
+	slot->path = strdup(self->path);
+	slot->stamp = stamp;
+	slot->entries = copyEntries(self->entries);
+	slot->alphas = self->alphas;
+	slot->last_used = ++snapshot_clock;
+}
+
+static void clearSnapshots(void) {
+	for (int i = 0; i < DIRECTORY_SNAPSHOT_COUNT; i++)
+		DirectorySnapshot_clear(&snapshots[i]);
+}
+
 ///////////////////////////////////////
 // Directory construction
 
-Directory* Directory_new(char* path, int selected) {
-	char display_name[MAX_PATH];
-	getDisplayName(path, display_name);
+// only folders that go through getEntries are snapshotted, the rest are
+// either generated or cheap
+static int isSnapshotPath(char* path) {
+	return !exactMatch(path, SDCARD_PATH) &&
+		   !exactMatch(path, FAUX_RECENT_PATH) &&
+		   !exactMatch(path, ROMS_PATH) &&
+		   !(!exactMatch(path, COLLECTIONS_PATH) && prefixMatch(COLLECTIONS_PATH, path) && suffixMatch(".txt", path)) &&
+		   !suffixMatch(".m3u", path);
+}
 
-	Directory* self = malloc(sizeof(Directory));
-	self->path = strdup(path);
-	self->name = strdup(display_name);
+static Array* getDirectoryEntries(char* path) {
 	if (exactMatch(path, SDCARD_PATH)) {
-		self->entries = getRoot(_simple_mode);
+		return getRoot(_simple_mode);
 	} else if (exactMatch(path, FAUX_RECENT_PATH)) {
-		self->entries = Recents_getEntries();
+		return Recents_getEntries();
 	} else if (exactMatch(path, ROMS_PATH)) {
-		self->entries = getRoms();
+		return getRoms();
 	} else if (!exactMatch(path, COLLECTIONS_PATH) && prefixMatch(COLLECTIONS_PATH, path) && suffixMatch(".txt", path)) {
-		self->entries = getCollection(path);
+		return getCollection(path);
 	} else if (suffixMatch(".m3u", path)) {
-		self->entries = getDiscs(path);
+		return getDiscs(path);
 	} else {
-		self->entries = getEntries(path);
+		return getEntries(path);
 	}
-	IntArray_init(&self->alphas);
+}
+
+Directory* Directory_new(char* path, int selected) {
+	char display_name[MAX_PATH];
+	getDisplayName(path, display_name);
+
+	Directory* self = malloc(sizeof(Directory));
+	self->path = strdup(path);
+	self->name = strdup(display_name);
 	self->selected = selected;
+	self->arena = EntryArena_new();
+
+	// snapshots must stay malloc'd, so the arena is only current while
+	// this directory's own entries are made
+	uint64_t stamp = isSnapshotPath(path) ? getDirectoryStamp(path) : 0;
+	EntryArena* previous = EntryArena_use(self->arena);
+	int restored = stamp && restoreSnapshot(self, stamp);
+	if (!restored)
+		self->entries = getDirectoryEntries(path);
+	EntryArena_use(previous);
+	if (restored)
+		return self;
+
+	IntArray_init(&self->alphas);
 	Directory_index(self);
+	if (stamp)
+		storeSnapshot(self, stamp);
 	return self;
 }
 
+void Directory_reload(Directory* self) {
+	char selected_path[MAX_PATH] = {0};
+	if (self->selected < self->entries->count) {
+		Entry* entry = self->entries->items[self->selected];
+		strncpy(selected_path, entry->path, MAX_PATH - 1);
+	}
+
+	EntryArena* arena = EntryArena_new();
+	EntryArena* previous = EntryArena_use(arena);
+	Array* entries = getDirectoryEntries(self->path);
+	EntryArena_use(previous);
+
+	EntryArray_free(self->entries);
+	EntryArena_free(self->arena);
+	self->entries = entries;
+	self->arena = arena;
+	IntArray_init(&self->alphas);
+	Directory_index(self);
+
+	// stay on the same entry if it's still there, otherwise keep the row in bounds
+	int selected = EntryArray_indexOf(self->entries, selected_path);
+	if (selected < 0)
+		selected = self->selected < self->entries->count ? self->selected : self->entries->count - 1;
+	self->selected = selected < 0 ? 0 : selected;
+}
+
 ///////////////////////////////////////
 // Content query helpers
 
@@ -333,252 +512,510 @@ int isConsoleDir(char* path) {
 	return exactMatch(parent_dir, ROMS_PATH);
 }
 
-///////////////////////////////////////
-// Content retrieval
+void getThumbPath(Entry* entry, char* out, size_t size) {
+	// <folder>/.media/<file name without extension>.png
+	char rompath[MAX_PATH];
+	strncpy(rompath, entry->path, sizeof(rompath) - 1);
+	rompath[sizeof(rompath) - 1] = '\0';
+	char* res_name = strrchr(rompath, '/');
+	if (!res_name) {
+		snprintf(out, size, "./.media/%s", entry->path);
+	} else {
+		*res_name++ = '\0';
+		snprintf(out, size, "%s/.media/%s", rompath, res_name);
+	}
+	char* dot = strrchr(out, '.');
+	if (dot && dot > strrchr(out, '/'))
+		*dot = '\0';
+	strncat(out, ".png", size - strlen(out) - 1);
+}
 
-static void writeRomsCache(Array* entries) {
-	FILE* file = fopen(EMULIST_CACHE_PATH, "w");
-	if (!file)
-		return;
-	for (int i = 0; i < entries->count; i++) {
-		Entry* entry = entries->items[i];
-		fputs(entry->path, file);
-		fputc('\t', file);
-		fputs(entry->name, file);
-		fputc('\n', file);
+#define THUMB_PREFETCH_AHEAD 4
+#define THUMB_PREFETCH_BEHIND 1
+
+void prefetchEntryThumbs(Array* entries, int selected) {
+	// guess the scroll direction from the last call on the same list,
+	// a jump of more than half the list is a wrap around the end
+	static Array* last_entries = NULL;
+	static int last_selected = 0;
+	static int direction = 1;
+	if (entries == last_entries && selected != last_selected) {
+		int delta = selected - last_selected;
+		if (delta > entries->count / 2 || -delta > entries->count / 2)
+			delta = -delta;
+		direction = delta > 0 ? 1 : -1;
+	}
+	last_entries = entries;
+	last_selected = selected;
+
+	char paths[THUMB_PREFETCH_AHEAD + THUMB_PREFETCH_BEHIND][MAX_PATH];
+	const char* queued[THUMB_PREFETCH_AHEAD + THUMB_PREFETCH_BEHIND];
+	int count = 0;
+	for (int i = 1; i <= THUMB_PREFETCH_AHEAD + THUMB_PREFETCH_BEHIND; i++) {
+		int step = i <= THUMB_PREFETCH_AHEAD ? i * direction : -(i - THUMB_PREFETCH_AHEAD) * direction;
+		int index = selected + step;
+		if (index < 0 || index >= entries->count)
+			continue;
+		getThumbPath(entries->items[index], paths[count], MAX_PATH);
+		queued[count] = paths[count];
+		count += 1;
 	}
-	fclose(file);
+	prefetchThumbs(queued, count);
 }
 
-static Array* readRomsCache(void) {
-	FILE* file = fopen(EMULIST_CACHE_PATH, "r");
-	if (!file)
-		return NULL;
+///////////////////////////////////////
+// Content retrieval
 
-	Array* entries = Array_new();
-	char line[MAX_PATH];
-	while (fgets(line, sizeof(line), file) != NULL) {
-		normalizeNewline(line);
-		trimTrailingNewlines(line);
-		if (strlen(line) == 0)
-			continue;
+static RomIndex* rom_index = NULL; // ROMINDEX_CACHE_PATH mapped, or a fresh build if it couldn't be saved
+static SearchIndex* search_index = NULL; // built from rom_index on first search
 
-		char* tab = strchr(line, '\t');
-		if (!tab) {
-			EntryArray_free(entries);
-			fclose(file);
-			return NULL; // malformed cache, force rescan
-		}
-		*tab = '\0';
-		char* path = line;
-		char* name = tab + 1;
-		Array_push(entries, Entry_newNamed(path, ENTRY_DIR, name));
+///////////////////////////////////////
+// Rom index building
+//
+// Console folders are walked in parallel, one task per folder, so sd card
+// latency overlaps across cores. Each task probes for an emu, then lists
+// the roms unless the previous index already has them.
+
+#define INDEX_MAX_WORKERS 4
+
+typedef struct ConsoleScan {
+	char path[MAX_PATH];
+	char name[MAX_PATH];  // display name, used for deduplication
+	char alias[MAX_PATH]; // name after map.txt
+	time_t mtime;
+	bool has_roms;
+	int reused;	 // console in the previous index whose rows are kept, or -1
+	Array* roms; // StringArray of path, name pairs
+} ConsoleScan;
+
+typedef struct IndexBuild {
+	ConsoleScan* scans;
+	int count;
+	int next; // next task to claim, protected by mutex
+	pthread_mutex_t mutex;
+	Hash* map;
+	RomIndex* previous;
+	bool publish; // show consoles in the ui as soon as they're found
+} IndexBuild;
+
+// consoles found so far by a cold build, for getRoms while there's no index yet
+static pthread_mutex_t published_mutex = PTHREAD_MUTEX_INITIALIZER;
+static Array* published = NULL; // Entries, protected by published_mutex
+static int published_generation = 0; // protected by published_mutex
+
+static void publishConsole(ConsoleScan* scan) {
+	pthread_mutex_lock(&published_mutex);
+	if (!published)
+		published = Array_new();
+	Array_push(published, Entry_newNamed(scan->path, ENTRY_DIR, scan->alias));
+	published_generation += 1;
+	pthread_mutex_unlock(&published_mutex);
+	setNeedDraw(1); // wake the main loop to pick it up
+}
+
+static void clearPublished(void) {
+	pthread_mutex_lock(&published_mutex);
+	if (published) {
+		EntryArray_free(published);
+		published = NULL;
 	}
-	fclose(file);
-	return entries;
+	pthread_mutex_unlock(&published_mutex);
 }
 
-static void writeRomIndexCache(Array* entries) {
-	FILE* file = fopen(ROMINDEX_CACHE_PATH, "w");
-	if (!file)
+static void scanConsole(IndexBuild* build, ConsoleScan* scan) {
+	char* dir_name = strrchr(scan->path, '/') + 1;
+
+	scan->mtime = getMtime(scan->path); // before reading, so a change mid-scan marks it stale
+	scan->has_roms = hasRoms(dir_name);
+	if (!scan->has_roms)
 		return;
-	for (int i = 0; i < entries->count; i++) {
-		Entry* entry = entries->items[i];
-		fputs(entry->path, file);
-		fputc('\t', file);
-		fputs(entry->name, file);
-		fputc('\n', file);
+
+	getDisplayName(scan->path, scan->name);
+	char* alias = build->map ? Hash_get(build->map, dir_name) : NULL;
+	strncpy(scan->alias, alias ? alias : scan->name, MAX_PATH - 1);
+
+	if (build->publish)
+		publishConsole(scan);
+
+	RomIndex* previous = build->previous;
+	if (previous) {
+		for (uint32_t i = 0; i < previous->header->console_count; i++) {
+			const RomIndexConsole* console = &previous->consoles[i];
+			if (!exactMatch((char*)RomIndex_string(previous, console->path), scan->path))
+				continue;
+			if (console->mtime == scan->mtime && exactMatch((char*)RomIndex_string(previous, console->name), scan->alias)) {
+				scan->reused = i;
+				return;
+			}
+			break;
+		}
 	}
-	fclose(file);
-}
 
-static Array* readRomIndexCache(void) {
-	FILE* file = fopen(ROMINDEX_CACHE_PATH, "r");
-	if (!file)
-		return NULL;
+	DIR* rom_dh = opendir(scan->path);
+	if (!rom_dh)
+		return;
 
-	Array* entries = Array_new();
-	char line[MAX_PATH * 2];
-	while (fgets(line, sizeof(line), file) != NULL) {
-		normalizeNewline(line);
-		trimTrailingNewlines(line);
-		if (strlen(line) == 0)
+	scan->roms = Array_new();
+	struct dirent* rom_dp;
+	char rom_path[MAX_PATH];
+	while ((rom_dp = readdir(rom_dh)) != NULL) {
+		if (hide(rom_dp->d_name))
+			continue;
+		snprintf(rom_path, sizeof(rom_path), "%s/%s",
+				 scan->path, rom_dp->d_name);
+		if (isDirEntry(rom_dp, rom_path))
 			continue;
 
-		char* tab = strchr(line, '\t');
-		if (!tab) {
-			EntryArray_free(entries);
-			fclose(file);
-			return NULL;
-		}
-		*tab = '\0';
-		char* path = line;
-		char* name = tab + 1;
-		Array_push(entries, Entry_newNamed(path, ENTRY_ROM, name));
+		char display_name[MAX_PATH];
+		getDisplayName(rom_path, display_name);
+		char full_display[MAX_PATH];
+		snprintf(full_display, sizeof(full_display), "%s (%s)",
+				 display_name, scan->alias);
+
+		Array_push(scan->roms, strdup(rom_path));
+		Array_push(scan->roms, strdup(full_display));
 	}
-	fclose(file);
-	return entries;
+	closedir(rom_dh);
 }
 
-void Content_invalidateEmulist(void) {
-	unlink(EMULIST_CACHE_PATH);
-	unlink(ROMINDEX_CACHE_PATH);
+static void* scanThread(void* arg) {
+	IndexBuild* build = arg;
+	while (1) {
+		pthread_mutex_lock(&build->mutex);
+		int i = build->next++;
+		pthread_mutex_unlock(&build->mutex);
+		if (i >= build->count)
+			break;
+		scanConsole(build, &build->scans[i]);
+	}
+	return NULL;
 }
 
-Array* Content_searchRoms(const char* query) {
-	Array* all_roms = readRomIndexCache();
-	if (!all_roms) {
-		// Force a build by calling getRoms() (which populates both caches)
-		Array* consoles = getRoms();
-		EntryArray_free(consoles);
-		all_roms = readRomIndexCache();
-		if (!all_roms)
-			return Array_new();
-	}
+static Hash* loadMap(char* map_path) {
+	if (!exists(map_path))
+		return NULL;
+	Hash* map = Hash_new();
+	Hash_loadMap(map, map_path);
+	return map;
+}
 
-	if (!query || strlen(query) == 0)
-		return all_roms;
+static int sortScanName(const void* a, const void* b) {
+	ConsoleScan* item1 = *(ConsoleScan**)a;
+	ConsoleScan* item2 = *(ConsoleScan**)b;
+	return strcasecmp(item1->name, item2->name);
+}
 
-	Array* results = Array_new();
-	for (int i = 0; i < all_roms->count; i++) {
-		Entry* entry = all_roms->items[i];
-		if (containsString(entry->name, (char*)query)) {
-			Array_push(results, entry);
-		} else {
-			Entry_free(entry);
-		}
-	}
-	Array_free(all_roms);
-	return results;
+static int sortScanAlias(const void* a, const void* b) {
+	ConsoleScan* item1 = *(ConsoleScan**)a;
+	ConsoleScan* item2 = *(ConsoleScan**)b;
+	return strcasecmp(item1->alias, item2->alias);
 }
 
-Array* getRoms(void) {
-	// Try loading from cache first
-	Array* entries = readRomsCache();
-	if (entries)
-		return entries;
+// Builds a fresh index. Consoles whose folder mtime and name match previous
+// keep their rows as-is, everything else is read from disk again. Pass NULL
+// for a full scan.
+static RomIndex* buildRomIndex(RomIndex* previous, bool publish) {
+	char map_path[MAX_PATH];
+	snprintf(map_path, sizeof(map_path), "%s/map.txt", ROMS_PATH);
+
+	// stat before reading so anything added mid-scan marks the index stale
+	time_t roms_mtime = getMtime(ROMS_PATH);
+	time_t map_mtime = getMtime(map_path);
+	uint64_t folders_stamp = RomIndex_foldersStamp();
 
-	// Cache miss: full filesystem scan
-	entries = Array_new();
+	IndexBuild build = {0};
+	build.previous = previous;
+	build.publish = publish;
+	build.map = loadMap(map_path);
+	pthread_mutex_init(&build.mutex, NULL);
+
+	// consoles are always rediscovered: adding the first rom to an empty
+	// console folder doesn't touch the mtime of ROMS_PATH
+	int capacity = 0;
 	DIR* dh = opendir(ROMS_PATH);
 	if (dh) {
 		struct dirent* dp;
-		char full_path[MAX_PATH];
-		snprintf(full_path, sizeof(full_path), "%s/", ROMS_PATH);
-		char* tmp = full_path + strlen(full_path);
-
-		Array* emus = Array_new();
-		size_t remaining = sizeof(full_path) - (tmp - full_path);
 		while ((dp = readdir(dh)) != NULL) {
 			if (hide(dp->d_name))
 				continue;
-			if (hasRoms(dp->d_name)) {
-				strncpy(tmp, dp->d_name, remaining - 1);
-				full_path[MAX_PATH - 1] = '\0';
-				Array_push(emus, Entry_new(full_path, ENTRY_DIR));
+			if (build.count == capacity) {
+				capacity = capacity ? capacity * 2 : 32;
+				ConsoleScan* tmp = realloc(build.scans, sizeof(ConsoleScan) * capacity);
+				if (!tmp)
+					break;
+				build.scans = tmp;
 			}
+			ConsoleScan* scan = &build.scans[build.count++];
+			memset(scan, 0, sizeof(ConsoleScan));
+			snprintf(scan->path, sizeof(scan->path), "%s/%s", ROMS_PATH, dp->d_name);
+			scan->reused = -1;
 		}
 		closedir(dh);
+	}
 
-		EntryArray_sort(emus);
-		Entry* prev_entry = NULL;
-		for (int i = 0; i < emus->count; i++) {
-			Entry* entry = emus->items[i];
-			if (prev_entry && exactMatch(prev_entry->name, entry->name)) {
-				Entry_free(entry);
+	int worker_count = sysconf(_SC_NPROCESSORS_ONLN);
+	if (worker_count > INDEX_MAX_WORKERS)
+		worker_count = INDEX_MAX_WORKERS;
+	if (worker_count > build.count)
+		worker_count = build.count;
+	pthread_t workers[INDEX_MAX_WORKERS];
+	int started = 0;
+	for (int i = 1; i < worker_count; i++) {
+		if (pthread_create(&workers[started], NULL, scanThread, &build) == 0)
+			started += 1;
+	}
+	scanThread(&build); // this thread takes tasks too
+	for (int i = 0; i < started; i++)
+		pthread_join(workers[i], NULL);
+	pthread_mutex_destroy(&build.mutex);
+	if (build.map)
+		Hash_free(build.map);
+
+	// same rules as before: dedupe by display name, then order by alias
+	Array* consoles = Array_new();
+	for (int i = 0; i < build.count; i++) {
+		if (build.scans[i].has_roms)
+			Array_push(consoles, &build.scans[i]);
+	}
+	qsort(consoles->items, consoles->count, sizeof(void*), sortScanName);
+	Array* unique = Array_new();
+	ConsoleScan* prev_scan = NULL;
+	for (int i = 0; i < consoles->count; i++) {
+		ConsoleScan* scan = consoles->items[i];
+		if (prev_scan && exactMatch(prev_scan->name, scan->name))
+			continue;
+		Array_push(unique, scan);
+		prev_scan = scan;
+	}
+	Array_free(consoles);
+	qsort(unique->items, unique->count, sizeof(void*), sortScanAlias);
+
+	RomIndexWriter* writer = RomIndexWriter_new();
+	int* reused = NULL; // previous console index -> new console index, or -1
+	if (previous) {
+		int count = previous->header->console_count;
+		reused = malloc(sizeof(int) * (count ? count : 1));
+		for (int i = 0; reused && i < count; i++)
+			reused[i] = -1;
+	}
+
+	RomIndex* index = NULL;
+	if (writer && (!previous || reused)) {
+		int rescanned = 0;
+		for (int i = 0; i < unique->count; i++) {
+			ConsoleScan* scan = unique->items[i];
+			int console = RomIndexWriter_addConsole(writer, scan->path, scan->alias, scan->mtime);
+			if (console < 0)
+				continue;
+			if (scan->reused >= 0) {
+				reused[scan->reused] = console;
 				continue;
 			}
-			Array_push(entries, entry);
-			prev_entry = entry;
+			rescanned += 1;
+			for (int j = 0; scan->roms && j + 1 < scan->roms->count; j += 2)
+				RomIndexWriter_addRom(writer, console, scan->roms->items[j], scan->roms->items[j + 1]);
 		}
-		Array_free(emus);
+
+		// carry over the rows of unchanged consoles straight from the pool
+		if (previous) {
+			for (uint32_t i = 0; i < previous->header->rom_count; i++) {
+				const RomIndexRom* rom = &previous->roms[i];
+				int console = reused[rom->console];
+				if (console >= 0)
+					RomIndexWriter_addRom(writer, console, RomIndex_string(previous, rom->path), RomIndex_string(previous, rom->name));
+			}
+			LOG_info("buildRomIndex: rescanned %i of %i consoles\n", rescanned, unique->count);
+		}
+
+		index = RomIndexWriter_finish(writer, roms_mtime, map_mtime, folders_stamp);
+	} else {
+		RomIndexWriter_free(writer);
 	}
 
-	// Handle mapping logic
-	char map_path[MAX_PATH];
-	snprintf(map_path, sizeof(map_path), "%s/map.txt", ROMS_PATH);
-	if (entries->count > 0 && exists(map_path)) {
-		FILE* file = fopen(map_path, "r");
-		if (file) {
-			Hash* map = Hash_new();
-			char line[MAX_PATH];
-
-			while (fgets(line, sizeof(line), file)) {
-				normalizeNewline(line);
-				trimTrailingNewlines(line);
-				if (strlen(line) == 0)
-					continue;
+	free(reused);
+	Array_free(unique);
+	for (int i = 0; i < build.count; i++) {
+		if (build.scans[i].roms)
+			StringArray_free(build.scans[i].roms);
+	}
+	free(build.scans);
+	return index;
+}
 
-				char* tmp = strchr(line, '\t');
-				if (tmp) {
-					*tmp = '\0';
-					char* key = line;
-					char* value = tmp + 1;
-					Hash_set(map, key, value);
-				}
-			}
-			fclose(file);
+///////////////////////////////////////
+// Background indexing
+//
+// A cached index is trusted immediately and validated against the sd card
+// on a worker; if any console changed, the worker builds a patched index
+// that the main loop swaps in via Content_pollRomIndex. Without a cache the
+// same worker does the full build, publishing consoles as it goes.
+
+static pthread_t rescan_thread;
+static bool rescan_running = false; // main thread only
+static bool rescan_failed = false;	// main thread only, a cold build came back empty handed, don't retry
+static int rescan_generation = 0;	// main thread only, last published_generation seen
+static pthread_mutex_t rescan_mutex = PTHREAD_MUTEX_INITIALIZER;
+static bool rescan_done = false;	 // protected by rescan_mutex
+static RomIndex* rescan_result = NULL; // protected by rescan_mutex, NULL if still fresh
+
+static void* rescanThread(void* arg) {
+	RomIndex* previous = arg; // read-only here, the main thread keeps it alive until joined
+	RomIndex* index = NULL;
+	if (!previous || !RomIndex_isFresh(previous))
+		index = buildRomIndex(previous, !previous);
+
+	pthread_mutex_lock(&rescan_mutex);
+	rescan_result = index;
+	rescan_done = true;
+	pthread_mutex_unlock(&rescan_mutex);
+	setNeedDraw(1);
+	return NULL;
+}
 
-			bool resort = false;
-			for (int i = 0; i < entries->count; i++) {
-				Entry* entry = entries->items[i];
-				char* slash = strrchr(entry->path, '/');
-				if (!slash)
-					continue;
-				char* filename = slash + 1;
-				char* alias = Hash_get(map, filename);
-				if (alias) {
-					free(entry->name);
-					entry->name = strdup(alias);
-					resort = true;
-				}
-			}
-			if (resort)
-				EntryArray_sort(entries);
-			Hash_free(map);
-		}
+static void startRescan(void) {
+	if (rescan_running)
+		return;
+	rescan_done = false;
+	rescan_result = NULL;
+	if (pthread_create(&rescan_thread, NULL, rescanThread, rom_index) != 0) {
+		LOG_warn("startRescan: unable to start rescan thread\n");
+		return;
 	}
+	rescan_running = true;
+}
 
-	// Build ROM index: scan all console dirs for individual ROMs
-	{
-		Array* rom_index = Array_new();
-		for (int i = 0; i < entries->count; i++) {
-			Entry* console_entry = entries->items[i];
-			char* console_name = console_entry->name;
+// joins the worker and returns its result (NULL if nothing changed)
+static RomIndex* finishRescan(void) {
+	if (!rescan_running)
+		return NULL;
+	pthread_join(rescan_thread, NULL);
+	rescan_running = false;
+	RomIndex* index = rescan_result;
+	rescan_result = NULL;
+	clearPublished();
+	return index;
+}
 
-			DIR* rom_dh = opendir(console_entry->path);
-			if (!rom_dh)
-				continue;
+static RomIndex* getRomIndex(void) {
+	if (rom_index || rescan_running || rescan_failed)
+		return rom_index;
 
-			struct dirent* rom_dp;
-			char rom_path[MAX_PATH];
-			while ((rom_dp = readdir(rom_dh)) != NULL) {
-				if (hide(rom_dp->d_name))
-					continue;
-				if (rom_dp->d_type == DT_DIR)
-					continue;
+	// Try loading from cache first, validated in the background.
+	// Cache miss: full filesystem scan in the background, saved for next launch
+	rom_index = RomIndex_open(ROMINDEX_CACHE_PATH);
+	startRescan();
+
+	if (!rom_index && !rescan_running) { // no worker, do it the slow way
+		rom_index = buildRomIndex(NULL, false);
+		rescan_failed = !rom_index;
+		if (rom_index && !RomIndex_save(rom_index, ROMINDEX_CACHE_PATH))
+			LOG_warn("getRomIndex: unable to save %s\n", ROMINDEX_CACHE_PATH);
+	}
+	return rom_index;
+}
+
+int Content_isIndexing(void) {
+	return rescan_running && !rom_index;
+}
+
+int Content_pollRomIndex(void) {
+	if (!rescan_running)
+		return 0;
+
+	pthread_mutex_lock(&rescan_mutex);
+	bool done = rescan_done;
+	pthread_mutex_unlock(&rescan_mutex);
+	if (!done) {
+		pthread_mutex_lock(&published_mutex);
+		int generation = published_generation;
+		pthread_mutex_unlock(&published_mutex);
+		if (generation == rescan_generation)
+			return 0;
+		rescan_generation = generation;
+		return 1;
+	}
 
-				snprintf(rom_path, sizeof(rom_path), "%s/%s",
-						 console_entry->path, rom_dp->d_name);
+	bool cold = !rom_index;
+	RomIndex* index = finishRescan();
+	if (!index) {
+		rescan_failed = cold;
+		return cold; // drop whatever was published
+	}
+
+	if (!RomIndex_save(index, ROMINDEX_CACHE_PATH))
+		LOG_warn("Content_pollRomIndex: unable to save %s\n", ROMINDEX_CACHE_PATH);
+
+	int changed = cold || !RomIndex_sameConsoles(rom_index, index);
+	SearchIndex_free(search_index);
+	search_index = NULL;
+	RomIndex_free(rom_index);
+	rom_index = index;
+	return changed;
+}
+
+void Content_invalidateEmulist(void) {
+	clearSnapshots();
+	RomIndex_free(finishRescan());
+	unlink(ROMINDEX_CACHE_PATH);
+	SearchIndex_free(search_index);
+	search_index = NULL;
+	RomIndex_free(rom_index);
+	rom_index = NULL;
+	rescan_failed = false;
+}
+
+Array* Content_searchRoms(const char* query) {
+	Array* results = Array_new();
+	RomIndex* index = getRomIndex();
+	if (!index)
+		return results;
+	if (!search_index)
+		search_index = SearchIndex_new(index);
+	if (!search_index)
+		return results;
+
+	// only allocate Entries for hits
+	const int* rows;
+	int count = SearchIndex_query(search_index, query, &rows);
+	for (int i = 0; i < count; i++) {
+		const RomIndexRom* rom = &index->roms[rows[i]];
+		Array_push(results, Entry_newNamed(RomIndex_string(index, rom->path), ENTRY_ROM, RomIndex_string(index, rom->name)));
+	}
+	return results;
+}
 
-				char display_name[MAX_PATH];
-				getDisplayName(rom_path, display_name);
-				char full_display[MAX_PATH];
-				snprintf(full_display, sizeof(full_display), "%s (%s)",
-						 display_name, console_name);
+Array* getRoms(void) {
+	Array* entries = Array_new();
+	RomIndex* index = getRomIndex();
+	if (!index) {
+		// still indexing, show what the worker found so far
+		pthread_mutex_lock(&published_mutex);
+		for (int i = 0; published && i < published->count; i++) {
+			Entry* entry = published->items[i];
+			Array_push(entries, Entry_newNamed(entry->path, ENTRY_DIR, entry->name));
+		}
+		pthread_mutex_unlock(&published_mutex);
 
-				Array_push(rom_index, Entry_newNamed(rom_path, ENTRY_ROM, full_display));
+		EntryArray_sort(entries);
+		Array* unique = Array_new();
+		Entry* prev_entry = NULL;
+		for (int i = 0; i < entries->count; i++) {
+			Entry* entry = entries->items[i];
+			if (prev_entry && exactMatch(prev_entry->name, entry->name)) {
+				Entry_free(entry);
+				continue;
 			}
-			closedir(rom_dh);
+			Array_push(unique, entry);
+			prev_entry = entry;
 		}
-		EntryArray_sort(rom_index);
-		writeRomIndexCache(rom_index);
-		EntryArray_free(rom_index);
+		Array_free(entries);
+		return unique;
 	}
 
-	// Write cache for next launch
-	writeRomsCache(entries);
-
+	for (uint32_t i = 0; i < index->header->console_count; i++) {
+		const RomIndexConsole* console = &index->consoles[i];
+		Array_push(entries, Entry_newNamed(RomIndex_string(index, console->path), ENTRY_DIR, RomIndex_string(index, console->name)));
+	}
 	return entries;
 }
 
@@ -615,7 +1052,7 @@ Array* getRoot(int simple_mode) {
 
 	// Handle collections
 	if (hasCollections() && CFG_getShowCollections()) {
-		if (entries->count) {
+		if (entries->count || Content_isIndexing()) { // don't promote collections just because consoles aren't in yet
 			Array_push(root, Entry_new(COLLECTIONS_PATH, ENTRY_DIR));
 		} else { // No visible systems, promote collections to root
 			Array* collections = getCollections();
@@ -647,10 +1084,8 @@ Array* getRoot(int simple_mode) {
 			}
 
 			Entry* entry = Entry_new(sd_path, type);
-			if (name) {
-				free(entry->name);
-				entry->name = strdup(name);
-			}
+			if (name)
+				Entry_setName(entry, name);
 			Array_push(root, entry);
 		}
 	}
@@ -720,10 +1155,9 @@ Array* getDiscs(char* path) {
 			if (exists(disc_path)) {
 				disc += 1;
 				Entry* entry = Entry_new(disc_path, ENTRY_ROM);
-				free(entry->name);
 				char name[16];
 				sprintf(name, "Disc %i", disc);
-				entry->name = strdup(name);
+				Entry_setName(entry, name);
 				Array_push(entries, entry);
 			}
 		}
@@ -778,7 +1212,7 @@ void addEntries(Array* entries, char* path) {
 				continue;
 			strncpy(tmp, dp->d_name, remaining - 1);
 			full_path[MAX_PATH - 1] = '\0';
-			int is_dir = dp->d_type == DT_DIR;
+			int is_dir = isDirEntry(dp, full_path);
 			int type;
 			if (is_dir) {
 				if (suffixMatch(".pak", dp->d_name)) {
@@ -804,26 +1238,22 @@ Array* getEntries(char* path) {
 
 	if (isConsoleDir(path)) { // top-level console folder, might collate
 		char collated_path[MAX_PATH];
-		strncpy(collated_path, path, MAX_PATH - 1);
-		collated_path[MAX_PATH - 1] = '\0';
-		char* tmp = strrchr(collated_path, '(');
-		if (tmp)
-			tmp[1] = '\0';
+		getCollatedPath(path, collated_path);
 
 		DIR* dh = opendir(ROMS_PATH);
 		if (dh != NULL) {
 			struct dirent* dp;
 			char full_path[MAX_PATH];
 			snprintf(full_path, sizeof(full_path), "%s/", ROMS_PATH);
-			tmp = full_path + strlen(full_path);
+			char* tmp = full_path + strlen(full_path);
 			size_t remaining = sizeof(full_path) - (tmp - full_path);
 			while ((dp = readdir(dh)) != NULL) {
 				if (hide(dp->d_name))
 					continue;
-				if (dp->d_type != DT_DIR)
-					continue;
 				strncpy(tmp, dp->d_name, remaining - 1);
 				full_path[MAX_PATH - 1] = '\0';
+				if (!isDirEntry(dp, full_path))
+					continue;
 
 				if (!prefixMatch(collated_path, full_path))
 					continue;
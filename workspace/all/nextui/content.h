@@ -10,6 +10,7 @@ void Content_setSimpleMode(bool mode);
 // Directory construction
 Directory* Directory_new(char* path, int selected);
 void Directory_index(Directory* self);
+void Directory_reload(Directory* self); // re-reads entries, keeping the selection on the same path
 
 // Content query helpers
 int getIndexChar(char* str);
@@ -22,10 +23,14 @@ int hasRoms(char* dir_name);
 int hasTools(void);
 int canPinEntry(Entry* entry);
 int isConsoleDir(char* path);
+void getThumbPath(Entry* entry, char* out, size_t size); // <folder>/.media/<name>.png
+void prefetchEntryThumbs(Array* entries, int selected); // queues art for the rows the user is scrolling towards
 
 // Content retrieval
 Entry* entryFromPakName(char* pak_name);
 void Content_invalidateEmulist(void);
+int Content_isIndexing(void); // a cold rom index build is running, getRoms is partial
+int Content_pollRomIndex(void); // picks up background indexing results, returns 1 if the console list changed
 Array* getRoms(void);
 Array* getCollections(void);
 Array* getRoot(int simple_mode);
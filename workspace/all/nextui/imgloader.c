@@ -3,6 +3,11 @@
 #include <string.h>
 #include <limits.h>
 #include <stdbool.h>
+#include <time.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/time.h>
 #include "defines.h"
 #include "api.h"
 #include "utils.h"
@@ -57,20 +62,37 @@ static int cachedScreenH = 0;
 ///////////////////////////////////////
 // Thumbnail cache
 
-#define THUMB_CACHE_SIZE 8
+#define THUMB_CACHE_BYTES (24 * 1024 * 1024) // display-sized thumbs are ~1MB each on the larger screens
+#define THUMB_CACHE_BUCKETS 256
 
-typedef struct {
+// paths without art are cached too (surface NULL) so they aren't retried
+// every time the selection passes over them
+typedef struct ThumbCacheEntry {
 	char path[MAX_PATH];
+	uint32_t hash;
 	SDL_Surface* surface;
-	int lru_counter;
-	bool occupied;
+	size_t bytes;
+	struct ThumbCacheEntry* next_in_bucket;
+	struct ThumbCacheEntry* newer; // LRU list, most recently used at thumb_lru_head
+	struct ThumbCacheEntry* older;
 } ThumbCacheEntry;
 
-static ThumbCacheEntry thumb_cache[THUMB_CACHE_SIZE];
-static int thumb_lru_counter = 0;
+static ThumbCacheEntry* thumb_buckets[THUMB_CACHE_BUCKETS];
+static ThumbCacheEntry* thumb_lru_head = NULL;
+static ThumbCacheEntry* thumb_lru_tail = NULL;
+static size_t thumb_cache_bytes = 0;
 static char desiredThumbPath[MAX_PATH] = {0};
 static SDL_atomic_t thumbAsyncLoaded;
 
+///////////////////////////////////////
+// Thumbnail prefetch (protected by thumbQueue.mutex)
+
+// neighbours of the selection, replaced wholesale on every selection so
+// requests for rows the user has already scrolled past are simply dropped
+static char thumb_prefetch[THUMB_PREFETCH_MAX][MAX_PATH];
+static int thumb_prefetch_count = 0;
+static int thumb_prefetch_next = 0;
+
 ///////////////////////////////////////
 // Shared state (non-static, externed in imgloader.h)
 
@@ -186,133 +208,417 @@ int loadWorker(void* arg) {
 ///////////////////////////////////////
 // Thumbnail cache helpers (must be called under thumbMutex)
 
+static uint32_t thumbCacheHash(const char* path) { // FNV-1a
+	uint32_t hash = 2166136261u;
+	while (*path) {
+		hash ^= (uint8_t)*path++;
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+static void thumbCacheUnlink(ThumbCacheEntry* entry) {
+	if (entry->newer)
+		entry->newer->older = entry->older;
+	else
+		thumb_lru_head = entry->older;
+	if (entry->older)
+		entry->older->newer = entry->newer;
+	else
+		thumb_lru_tail = entry->newer;
+	entry->newer = entry->older = NULL;
+}
+
+static void thumbCacheTouch(ThumbCacheEntry* entry) {
+	if (thumb_lru_head == entry)
+		return;
+	if (entry->newer || entry->older || thumb_lru_tail == entry)
+		thumbCacheUnlink(entry);
+	entry->older = thumb_lru_head;
+	if (thumb_lru_head)
+		thumb_lru_head->newer = entry;
+	thumb_lru_head = entry;
+	if (!thumb_lru_tail)
+		thumb_lru_tail = entry;
+}
+
+static ThumbCacheEntry* thumbCacheFind(const char* path) {
+	uint32_t hash = thumbCacheHash(path);
+	ThumbCacheEntry* entry = thumb_buckets[hash % THUMB_CACHE_BUCKETS];
+	while (entry) {
+		if (entry->hash == hash && strcmp(entry->path, path) == 0)
+			return entry;
+		entry = entry->next_in_bucket;
+	}
+	return NULL;
+}
+
+static void thumbCacheRemove(ThumbCacheEntry* entry) {
+	ThumbCacheEntry** link = &thumb_buckets[entry->hash % THUMB_CACHE_BUCKETS];
+	while (*link != entry)
+		link = &(*link)->next_in_bucket;
+	*link = entry->next_in_bucket;
+	thumbCacheUnlink(entry);
+	thumb_cache_bytes -= entry->bytes;
+	if (entry->surface)
+		SDL_FreeSurface(entry->surface);
+	free(entry);
+}
+
+// takes ownership of surface, which may be NULL for a path without art
 static void thumbCacheInsert(const char* path, SDL_Surface* surface) {
-	int target = -1;
-	int min_lru = INT_MAX;
-
-	// Check if already cached (update in place)
-	for (int i = 0; i < THUMB_CACHE_SIZE; i++) {
-		if (thumb_cache[i].occupied && strcmp(thumb_cache[i].path, path) == 0) {
-			SDL_FreeSurface(thumb_cache[i].surface);
-			thumb_cache[i].surface = surface;
-			thumb_cache[i].lru_counter = ++thumb_lru_counter;
+	size_t bytes = sizeof(ThumbCacheEntry);
+	if (surface)
+		bytes += (size_t)surface->pitch * surface->h;
+
+	ThumbCacheEntry* entry = thumbCacheFind(path);
+	if (entry) {
+		// update in place
+		if (entry->surface)
+			SDL_FreeSurface(entry->surface);
+		thumb_cache_bytes -= entry->bytes;
+	} else {
+		entry = calloc(1, sizeof(ThumbCacheEntry));
+		if (!entry) {
+			if (surface)
+				SDL_FreeSurface(surface);
 			return;
 		}
+		strncpy(entry->path, path, sizeof(entry->path) - 1);
+		entry->hash = thumbCacheHash(entry->path);
+		ThumbCacheEntry** bucket = &thumb_buckets[entry->hash % THUMB_CACHE_BUCKETS];
+		entry->next_in_bucket = *bucket;
+		*bucket = entry;
 	}
+	entry->surface = surface;
+	entry->bytes = bytes;
+	thumb_cache_bytes += bytes;
+	thumbCacheTouch(entry);
+
+	// evict least recently used until back under budget, always keeping the newest
+	while (thumb_cache_bytes > THUMB_CACHE_BYTES && thumb_lru_tail && thumb_lru_tail != entry)
+		thumbCacheRemove(thumb_lru_tail);
+}
 
-	// Find empty slot
-	for (int i = 0; i < THUMB_CACHE_SIZE; i++) {
-		if (!thumb_cache[i].occupied) {
-			target = i;
-			break;
-		}
+///////////////////////////////////////
+// Thumbnail disk cache
+//
+// One file per source image under THUMB_CACHE_PATH, named by a hash of
+// its path: a header, the source path, then the finished surface's
+// pixels exactly as they're drawn. A header that doesn't match the
+// source's mtime and size, the display box or the corner radius is a
+// miss, and the file is overwritten with the new result, so changing
+// the game art settings invalidates everything without leaving stale
+// files behind. Art that goes away leaves its file though, so the folder
+// is held to THUMB_DISK_BYTES by dropping the least recently shown files
+// when the worker starts, see thumbDiskPrune.
+
+#define THUMB_DISK_MAGIC 0x4D485454 // "TTHM"
+#define THUMB_DISK_VERSION 1
+#define THUMB_DISK_BYTES (256 * 1024 * 1024)
+#define THUMB_DISK_TOUCH_SECS (24 * 60 * 60) // hits refresh a file's mtime at most this often
+
+typedef struct ThumbDiskHeader {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t format; // SDL pixel format
+	int32_t width;
+	int32_t height;
+	int32_t pitch;
+	int32_t max_w; // display box the thumb was fitted to
+	int32_t max_h;
+	int32_t radius;
+	uint32_t path_len; // source path follows the header, without a NUL
+	int64_t mtime;	   // of the source image
+	int64_t size;
+} ThumbDiskHeader;
+
+static uint64_t thumbDiskHash(const char* path) { // FNV-1a
+	uint64_t hash = 14695981039346656037ull;
+	while (*path) {
+		hash ^= (uint8_t)*path++;
+		hash *= 1099511628211ull;
 	}
+	return hash;
+}
+
+static void thumbDiskPath(const char* path, char* out, size_t size) {
+	snprintf(out, size, THUMB_CACHE_PATH "/%016llx.thumb", (unsigned long long)thumbDiskHash(path));
+}
+
+static void thumbDiskKey(ThumbDiskHeader* key, const char* path, struct stat* st, int max_w, int max_h, int radius) {
+	memset(key, 0, sizeof(ThumbDiskHeader));
+	key->magic = THUMB_DISK_MAGIC;
+	key->version = THUMB_DISK_VERSION;
+	key->format = cachedScreenFormat;
+	key->max_w = max_w;
+	key->max_h = max_h;
+	key->radius = radius;
+	key->path_len = strlen(path);
+	key->mtime = (int64_t)st->st_mtime;
+	key->size = (int64_t)st->st_size;
+}
 
-	// No empty slot - evict LRU
-	if (target < 0) {
-		for (int i = 0; i < THUMB_CACHE_SIZE; i++) {
-			if (thumb_cache[i].lru_counter < min_lru) {
-				min_lru = thumb_cache[i].lru_counter;
-				target = i;
+static SDL_Surface* thumbDiskLoad(const char* path, ThumbDiskHeader* key) {
+	char cache_path[MAX_PATH];
+	thumbDiskPath(path, cache_path, sizeof(cache_path));
+	FILE* file = fopen(cache_path, "rb");
+	if (!file)
+		return NULL;
+
+	ThumbDiskHeader header;
+	char stored_path[MAX_PATH];
+	SDL_Surface* surface = NULL;
+	if (fread(&header, sizeof(header), 1, file) == 1 &&
+		header.magic == key->magic && header.version == key->version &&
+		header.format == key->format && header.max_w == key->max_w && header.max_h == key->max_h &&
+		header.radius == key->radius && header.mtime == key->mtime && header.size == key->size &&
+		header.path_len == key->path_len && header.path_len < sizeof(stored_path) &&
+		header.width > 0 && header.height > 0 && header.width <= 8192 && header.height <= 8192 &&
+		fread(stored_path, 1, header.path_len, file) == header.path_len &&
+		memcmp(stored_path, path, header.path_len) == 0) {
+		surface = SDL_CreateRGBSurfaceWithFormat(0, header.width, header.height, cachedScreenBitsPerPixel, cachedScreenFormat);
+		if (surface && surface->pitch == header.pitch) {
+			if (fread(surface->pixels, header.pitch, header.height, file) != (size_t)header.height) {
+				SDL_FreeSurface(surface);
+				surface = NULL;
 			}
+		} else if (surface) {
+			SDL_FreeSurface(surface);
+			surface = NULL;
 		}
-		if (thumb_cache[target].surface)
-			SDL_FreeSurface(thumb_cache[target].surface);
 	}
 
-	strncpy(thumb_cache[target].path, path, sizeof(thumb_cache[target].path) - 1);
-	thumb_cache[target].path[sizeof(thumb_cache[target].path) - 1] = '\0';
-	thumb_cache[target].surface = surface;
-	thumb_cache[target].lru_counter = ++thumb_lru_counter;
-	thumb_cache[target].occupied = true;
+	// mtime doubles as last shown for thumbDiskPrune, but only bump it
+	// now and then so browsing doesn't turn every hit into a write
+	struct stat st;
+	if (surface && fstat(fileno(file), &st) == 0 && time(NULL) - st.st_mtime > THUMB_DISK_TOUCH_SECS)
+		utimes(cache_path, NULL);
+	fclose(file);
+	return surface;
+}
+
+static void thumbDiskSave(const char* path, ThumbDiskHeader* key, SDL_Surface* surface) {
+	char cache_path[MAX_PATH];
+	char tmp_path[MAX_PATH];
+	thumbDiskPath(path, cache_path, sizeof(cache_path));
+	snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", cache_path);
+
+	FILE* file = fopen(tmp_path, "wb");
+	if (!file)
+		return;
+	ThumbDiskHeader header = *key;
+	header.width = surface->w;
+	header.height = surface->h;
+	header.pitch = surface->pitch;
+	int ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+			 fwrite(path, 1, header.path_len, file) == header.path_len &&
+			 fwrite(surface->pixels, surface->pitch, surface->h, file) == (size_t)surface->h;
+	if (fclose(file) != 0)
+		ok = 0;
+	// rename so a half-written file is never picked up
+	if (!ok || rename(tmp_path, cache_path) != 0)
+		unlink(tmp_path);
+}
+
+typedef struct ThumbDiskFile {
+	char name[32]; // %016llx.thumb
+	int64_t mtime;
+	int64_t size;
+} ThumbDiskFile;
+
+static int thumbDiskOldestFirst(const void* a, const void* b) {
+	const ThumbDiskFile* file1 = a;
+	const ThumbDiskFile* file2 = b;
+	return (file1->mtime > file2->mtime) - (file1->mtime < file2->mtime);
+}
+
+// deletes the least recently shown thumbs until the folder fits in
+// THUMB_DISK_BYTES, and any temp file a crash left behind. Only called
+// from the thumb worker, the one thread that writes here.
+static void thumbDiskPrune(void) {
+	DIR* dh = opendir(THUMB_CACHE_PATH);
+	if (!dh)
+		return;
+
+	ThumbDiskFile* files = NULL;
+	int count = 0;
+	int capacity = 0;
+	int64_t total = 0;
+	char file_path[MAX_PATH];
+	struct dirent* dp;
+	while ((dp = readdir(dh)) != NULL) {
+		if (dp->d_name[0] == '.')
+			continue;
+		snprintf(file_path, sizeof(file_path), "%s/%s", THUMB_CACHE_PATH, dp->d_name);
+		if (suffixMatch(".tmp", dp->d_name)) {
+			unlink(file_path);
+			continue;
+		}
+		struct stat st;
+		size_t len = strlen(dp->d_name);
+		if (!suffixMatch(".thumb", dp->d_name) || len >= sizeof(files->name) || stat(file_path, &st) != 0)
+			continue;
+
+		if (count == capacity) {
+			int new_capacity = capacity ? capacity * 2 : 256;
+			ThumbDiskFile* tmp = realloc(files, new_capacity * sizeof(ThumbDiskFile));
+			if (!tmp)
+				break;
+			files = tmp;
+			capacity = new_capacity;
+		}
+		ThumbDiskFile* file = &files[count++];
+		memcpy(file->name, dp->d_name, len + 1);
+		file->mtime = (int64_t)st.st_mtime;
+		file->size = (int64_t)st.st_size;
+		total += file->size;
+	}
+	closedir(dh);
+
+	if (total > THUMB_DISK_BYTES) {
+		qsort(files, count, sizeof(ThumbDiskFile), thumbDiskOldestFirst);
+		int removed = 0;
+		for (int i = 0; i < count && total > THUMB_DISK_BYTES; i++) {
+			snprintf(file_path, sizeof(file_path), "%s/%s", THUMB_CACHE_PATH, files[i].name);
+			if (unlink(file_path) == 0) {
+				total -= files[i].size;
+				removed += 1;
+			}
+		}
+		LOG_info("thumbDiskPrune: removed %i thumbs, %lli bytes left\n", removed, (long long)total);
+	}
+	free(files);
 }
 
 ///////////////////////////////////////
 // Dedicated thumbnail worker thread
 
+// loads path scaled to display size with rounded corners, NULL if there's no art
+static SDL_Surface* thumbLoad(const char* path) {
+	struct stat st;
+	if (stat(path, &st) != 0)
+		return NULL;
+
+	int max_w = (int)(cachedScreenW * CFG_getGameArtWidth());
+	int max_h = (int)(cachedScreenH * 0.6);
+	int radius = SCALE1(CFG_getThumbnailRadius());
+	ThumbDiskHeader key;
+	thumbDiskKey(&key, path, &st, max_w, max_h, radius);
+	if (key.path_len >= MAX_PATH)
+		return NULL;
+
+	SDL_Surface* cached = thumbDiskLoad(path, &key);
+	if (cached)
+		return cached;
+
+	SDL_Surface* image = IMG_Load(path);
+	if (!image)
+		return NULL;
+	SDL_Surface* imageRGBA =
+		SDL_ConvertSurfaceFormat(image, cachedScreenFormat, 0);
+	SDL_FreeSurface(image);
+	if (!imageRGBA)
+		return NULL;
+
+	// Downscale to display dimensions before processing
+	int img_w = imageRGBA->w;
+	int img_h = imageRGBA->h;
+	double aspect_ratio = (double)img_h / img_w;
+	int new_w = max_w;
+	int new_h = (int)(new_w * aspect_ratio);
+	if (new_h > max_h) {
+		new_h = max_h;
+		new_w = (int)(new_h / aspect_ratio);
+	}
+
+	if (new_w > 0 && new_h > 0 &&
+		(new_w < img_w || new_h < img_h)) {
+		SDL_Surface* downscaled = SDL_CreateRGBSurfaceWithFormat(
+			0, new_w, new_h,
+			imageRGBA->format->BitsPerPixel,
+			imageRGBA->format->format);
+		if (downscaled) {
+			SDL_BlitScaled(imageRGBA, NULL, downscaled, NULL);
+			SDL_FreeSurface(imageRGBA);
+			imageRGBA = downscaled;
+		}
+	}
+
+	// Apply rounded corners at display resolution (much faster)
+	GFX_ApplyRoundedCorners_8888(
+		imageRGBA,
+		&(SDL_Rect){0, 0, imageRGBA->w, imageRGBA->h},
+		radius);
+
+	thumbDiskSave(path, &key, imageRGBA);
+	return imageRGBA;
+}
+
 static int thumbLoadWorker(void* arg) {
 	TaskQueue* q = (TaskQueue*)arg;
+	thumbDiskPrune(); // here rather than in initImageLoaderPool to keep the sd card walk off the ui thread
 	while (!SDL_AtomicGet(&workerThreadsShutdown)) {
 		SDL_LockMutex(q->mutex);
-		while (!q->head && !SDL_AtomicGet(&workerThreadsShutdown)) {
+		while (!q->head && thumb_prefetch_next >= thumb_prefetch_count && !SDL_AtomicGet(&workerThreadsShutdown)) {
 			SDL_CondWait(q->cond, q->mutex);
 		}
 		if (SDL_AtomicGet(&workerThreadsShutdown)) {
 			SDL_UnlockMutex(q->mutex);
 			break;
 		}
-		TaskNode* node = q->head;
-		q->head = node->next;
-		if (!q->head)
-			q->tail = NULL;
-		q->size--;
-		SDL_UnlockMutex(q->mutex);
-
-		LoadBackgroundTask* task = node->task;
-		free(node);
 
-		SDL_Surface* result = NULL;
-		SDL_Surface* image = IMG_Load(task->imagePath);
-		if (image) {
-			SDL_Surface* imageRGBA =
-				SDL_ConvertSurfaceFormat(image, cachedScreenFormat, 0);
-			SDL_FreeSurface(image);
+		// the selected thumb always goes first, neighbours only when idle
+		LoadBackgroundTask* task = NULL;
+		bool is_prefetch = false;
+		if (q->head) {
+			TaskNode* node = q->head;
+			q->head = node->next;
+			if (!q->head)
+				q->tail = NULL;
+			q->size--;
+			task = node->task;
+			free(node);
+		} else {
+			task = malloc(sizeof(LoadBackgroundTask));
+			if (task) {
+				snprintf(task->imagePath, sizeof(task->imagePath), "%s", thumb_prefetch[thumb_prefetch_next]);
+				task->callback = NULL;
+			}
+			thumb_prefetch_next += 1;
+			is_prefetch = true;
+		}
+		SDL_UnlockMutex(q->mutex);
+		if (!task)
+			continue;
 
-			if (imageRGBA) {
-				// Downscale to display dimensions before processing
-				int img_w = imageRGBA->w;
-				int img_h = imageRGBA->h;
-				double aspect_ratio = (double)img_h / img_w;
-				int max_w = (int)(cachedScreenW * CFG_getGameArtWidth());
-				int max_h = (int)(cachedScreenH * 0.6);
-				int new_w = max_w;
-				int new_h = (int)(new_w * aspect_ratio);
-				if (new_h > max_h) {
-					new_h = max_h;
-					new_w = (int)(new_h / aspect_ratio);
-				}
-
-				if (new_w > 0 && new_h > 0 &&
-					(new_w < img_w || new_h < img_h)) {
-					SDL_Surface* downscaled = SDL_CreateRGBSurfaceWithFormat(
-						0, new_w, new_h,
-						imageRGBA->format->BitsPerPixel,
-						imageRGBA->format->format);
-					if (downscaled) {
-						SDL_BlitScaled(imageRGBA, NULL, downscaled, NULL);
-						SDL_FreeSurface(imageRGBA);
-						imageRGBA = downscaled;
-					}
-				}
-
-				// Apply rounded corners at display resolution (much faster)
-				GFX_ApplyRoundedCorners_8888(
-					imageRGBA,
-					&(SDL_Rect){0, 0, imageRGBA->w, imageRGBA->h},
-					SCALE1(CFG_getThumbnailRadius()));
-
-				result = imageRGBA;
+		if (is_prefetch) {
+			SDL_LockMutex(thumbMutex);
+			bool cached = thumbCacheFind(task->imagePath) != NULL;
+			SDL_UnlockMutex(thumbMutex);
+			if (cached) {
+				free(task);
+				continue;
 			}
 		}
 
-		// Cache result and conditionally update thumbbmp
+		SDL_Surface* result = thumbLoad(task->imagePath);
+
+		// Cache result and conditionally update thumbbmp, the selection
+		// may have landed on a prefetched path while it was loading
 		SDL_LockMutex(thumbMutex);
 		bool is_current = (strcmp(task->imagePath, desiredThumbPath) == 0);
 		bool had_any = (thumbbmp != NULL);
 
-		if (result) {
-			if (is_current) {
-				// Duplicate for thumbbmp before cache takes ownership
-				SDL_Surface* thumb_copy =
-					SDL_ConvertSurface(result, result->format, 0);
-				thumbCacheInsert(task->imagePath, result);
-				if (thumbbmp)
-					SDL_FreeSurface(thumbbmp);
-				thumbbmp = thumb_copy;
-			} else {
-				thumbCacheInsert(task->imagePath, result);
-			}
+		if (result && is_current) {
+			// Duplicate for thumbbmp before cache takes ownership
+			SDL_Surface* thumb_copy =
+				SDL_ConvertSurface(result, result->format, 0);
+			if (thumbbmp)
+				SDL_FreeSurface(thumbbmp);
+			thumbbmp = thumb_copy;
 		}
+		thumbCacheInsert(task->imagePath, result);
 
 		if (is_current) {
 			if (!result) {
@@ -378,21 +684,16 @@ bool startLoadThumb(const char* thumbpath) {
 	desiredThumbPath[sizeof(desiredThumbPath) - 1] = '\0';
 
 	// Check cache - swap immediately if found
-	for (int i = 0; i < THUMB_CACHE_SIZE; i++) {
-		if (thumb_cache[i].occupied &&
-			strcmp(thumb_cache[i].path, thumbpath) == 0) {
-			thumb_cache[i].lru_counter = ++thumb_lru_counter;
-			if (thumbbmp)
-				SDL_FreeSurface(thumbbmp);
-			thumbbmp = SDL_ConvertSurface(thumb_cache[i].surface,
-										  thumb_cache[i].surface->format, 0);
-			if (thumbbmp) {
-				thumbchanged = 1;
-				setNeedDraw(1);
-			}
-			SDL_UnlockMutex(thumbMutex);
-			return thumbbmp != NULL;
-		}
+	ThumbCacheEntry* cached = thumbCacheFind(thumbpath);
+	if (cached) {
+		thumbCacheTouch(cached);
+		if (thumbbmp)
+			SDL_FreeSurface(thumbbmp);
+		thumbbmp = cached->surface ? SDL_ConvertSurface(cached->surface, cached->surface->format, 0) : NULL;
+		thumbchanged = 1;
+		setNeedDraw(1);
+		SDL_UnlockMutex(thumbMutex);
+		return thumbbmp != NULL;
 	}
 
 	// Cache miss - keep old thumb visible while loading
@@ -415,13 +716,38 @@ int thumbCheckAsyncLoaded(void) {
 	return SDL_AtomicCAS(&thumbAsyncLoaded, 1, 0);
 }
 
-static void thumbCacheClear(void) {
-	for (int i = 0; i < THUMB_CACHE_SIZE; i++) {
-		if (thumb_cache[i].surface)
-			SDL_FreeSurface(thumb_cache[i].surface);
-		thumb_cache[i] = (ThumbCacheEntry){0};
+void prefetchThumbs(const char** thumbpaths, int count) {
+	if (count > THUMB_PREFETCH_MAX)
+		count = THUMB_PREFETCH_MAX;
+
+	// skip anything already cached here rather than waking the worker for it
+	int pending = 0;
+	const char* uncached[THUMB_PREFETCH_MAX];
+	SDL_LockMutex(thumbMutex);
+	for (int i = 0; i < count; i++) {
+		if (!thumbCacheFind(thumbpaths[i]))
+			uncached[pending++] = thumbpaths[i];
+	}
+	SDL_UnlockMutex(thumbMutex);
+
+	SDL_LockMutex(thumbQueue.mutex);
+	for (int i = 0; i < pending; i++) {
+		strncpy(thumb_prefetch[i], uncached[i], MAX_PATH - 1);
+		thumb_prefetch[i][MAX_PATH - 1] = '\0';
 	}
-	thumb_lru_counter = 0;
+	thumb_prefetch_count = pending;
+	thumb_prefetch_next = 0;
+	if (pending)
+		SDL_CondSignal(thumbQueue.cond);
+	SDL_UnlockMutex(thumbQueue.mutex);
+}
+
+static void thumbCacheClear(void) {
+	while (thumb_lru_tail)
+		thumbCacheRemove(thumb_lru_tail);
+	thumb_cache_bytes = 0;
+	thumb_prefetch_count = 0;
+	thumb_prefetch_next = 0;
 	desiredThumbPath[0] = '\0';
 }
 
@@ -438,6 +764,7 @@ void initImageLoaderPool(void) {
 	cachedScreenBitsPerPixel = screen->format->BitsPerPixel;
 	cachedScreenW = screen->w;
 	cachedScreenH = screen->h;
+	mkdir_p(THUMB_CACHE_PATH);
 
 	bgQueue.mutex = SDL_CreateMutex();
 	bgQueue.cond = SDL_CreateCond();
@@ -50,7 +50,9 @@ void startLoadFolderBackground(const char* imagePath, BackgroundLoadedCallback c
 void onBackgroundLoaded(SDL_Surface* surface);
 
 // Thumbnail loading
+#define THUMB_PREFETCH_MAX 8
 bool startLoadThumb(const char* thumbpath);
+void prefetchThumbs(const char** thumbpaths, int count); // loads in the background when idle, replaces any earlier prefetch
 int thumbCheckAsyncLoaded(void);
 
 #endif // IMGLOADER_H
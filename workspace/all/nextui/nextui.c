@@ -389,6 +389,28 @@ static int GameList_handleInput(unsigned long now, int currentScreen,
 	return currentScreen;
 }
 
+// Refreshes the open directories whose entries come from the rom index
+static void reloadRomLists(void) {
+	int row_count = MAIN_ROW_COUNT - 1;
+	for (int i = 0; i < stack->count; i++) {
+		Directory* dir = stack->items[i];
+		if (!exactMatch(dir->path, SDCARD_PATH) && !exactMatch(dir->path, ROMS_PATH))
+			continue;
+		Directory_reload(dir);
+
+		// keep the window full and the selection inside it
+		int total = dir->entries->count;
+		int end = dir->start + row_count;
+		if (end > total)
+			end = total;
+		if (dir->selected >= end)
+			end = dir->selected + 1;
+		int start = end - row_count;
+		dir->start = (start < 0) ? 0 : start;
+		dir->end = end;
+	}
+}
+
 int main(int argc, char* argv[]) {
 	if (autoResume())
 		return 0; // nothing to do
@@ -453,6 +475,12 @@ int main(int argc, char* argv[]) {
 		if (PAD_anyPressed())
 			last_active_input = SDL_GetTicks();
 
+		// Swap in a finished background rescan of the rom index
+		if (confirm_shortcut_action == SHORTCUT_NONE && Content_pollRomIndex()) {
+			reloadRomLists();
+			dirty = true;
+		}
+
 		int total = top->entries->count;
 
 		PWR_update(&dirty, &show_setting, NULL, NULL);
@@ -548,8 +576,10 @@ int main(int argc, char* argv[]) {
 				menu_title = GameSwitcher_getSelectedName();
 			else if (currentScreen == SCREEN_SEARCH)
 				menu_title = "Search";
+			else if (stack->count > 1)
+				menu_title = top->name;
 			else
-				menu_title = stack->count > 1 ? top->name : "NextUI Redux";
+				menu_title = Content_isIndexing() ? "Indexing..." : "NextUI Redux";
 			int ow = UI_renderMenuBar(screen, menu_title);
 
 			// capture menu bar for fixed overlay during animation
@@ -584,30 +614,12 @@ int main(int argc, char* argv[]) {
 			} else {
 				Entry* entry = top->entries->items[top->selected];
 				assert(entry);
-				char tmp_path[MAX_PATH];
-				strncpy(tmp_path, entry->path, sizeof(tmp_path) - 1);
-				tmp_path[sizeof(tmp_path) - 1] = '\0';
-
-				char* res_name = strrchr(tmp_path, '/');
-				if (res_name)
-					res_name++;
-				else
-					res_name = tmp_path;
-
 				char path_copy[1024];
 				strncpy(path_copy, entry->path, sizeof(path_copy) - 1);
 				path_copy[sizeof(path_copy) - 1] = '\0';
 
 				char* rompath = dirname(path_copy);
 
-				char res_copy[1024];
-				strncpy(res_copy, res_name, sizeof(res_copy) - 1);
-				res_copy[sizeof(res_copy) - 1] = '\0';
-
-				char* dot = strrchr(res_copy, '.');
-				if (dot)
-					*dot = '\0';
-
 				// this is only a choice on the root folder
 				list_show_entry_names =
 					stack->count > 1 || CFG_getShowFolderNamesAtRoot();
@@ -620,10 +632,10 @@ int main(int argc, char* argv[]) {
 				// load game thumbnails
 				if (total > 0) {
 					if (CFG_getShowGameArt()) {
-						char thumbpath[1024];
-						snprintf(thumbpath, sizeof(thumbpath), "%s/.media/%s.png", rompath,
-								 res_copy);
+						char thumbpath[MAX_PATH];
+						getThumbPath(entry, thumbpath, sizeof(thumbpath));
 						had_thumb = startLoadThumb(thumbpath);
+						prefetchEntryThumbs(top->entries, top->selected);
 						int max_w = (int)(screen->w - (screen->w * CFG_getGameArtWidth()));
 						if (had_thumb)
 							ox = (int)(max_w)-SCALE1(BUTTON_MARGIN * 5);
@@ -735,7 +747,9 @@ int main(int argc, char* argv[]) {
 					}
 
 				} else {
-					UI_renderCenteredMessage(screen, "Empty folder");
+					bool indexing = Content_isIndexing() &&
+									(exactMatch(top->path, SDCARD_PATH) || exactMatch(top->path, ROMS_PATH));
+					UI_renderCenteredMessage(screen, indexing ? "Indexing..." : "Empty folder");
 				}
 
 				// Render confirmation dialog for shortcuts
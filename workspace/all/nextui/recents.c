@@ -269,10 +269,8 @@ Entry* Recents_entryFromRecent(Recent* recent) {
 	snprintf(sd_path, sizeof(sd_path), "%s%s", SDCARD_PATH, recent->path);
 	int type = suffixMatch(".pak", sd_path) ? ENTRY_PAK : ENTRY_ROM; // ???
 	Entry* entry = Entry_new(sd_path, type);
-	if (recent->alias) {
-		free(entry->name);
-		entry->name = strdup(recent->alias);
-	}
+	if (recent->alias)
+		Entry_setName(entry, recent->alias);
 	return entry;
 }
 
@@ -0,0 +1,411 @@
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "romindex.h"
+#include "types.h"
+#include "defines.h"
+#include "api.h"
+
+///////////////////////////////////////
+// Helpers
+
+static int64_t RomIndex_mtime(const char* path) {
+	struct stat st;
+	if (stat(path, &st) != 0)
+		return 0;
+	return (int64_t)st.st_mtime;
+}
+
+// validates the layout of data and points self's sections into it
+static int RomIndex_bind(RomIndex* self) {
+	if (self->size < sizeof(RomIndexHeader))
+		return 0;
+
+	const RomIndexHeader* header = self->data;
+	if (header->magic != ROMINDEX_MAGIC || header->version != ROMINDEX_VERSION)
+		return 0;
+
+	size_t consoles_size = (size_t)header->console_count * sizeof(RomIndexConsole);
+	size_t roms_size = (size_t)header->rom_count * sizeof(RomIndexRom);
+	size_t expected = sizeof(RomIndexHeader) + consoles_size + roms_size + header->pool_size;
+	if (expected != self->size || header->pool_size == 0)
+		return 0;
+
+	uint8_t* base = self->data;
+	self->header = header;
+	self->consoles = (const RomIndexConsole*)(base + sizeof(RomIndexHeader));
+	self->roms = (const RomIndexRom*)(base + sizeof(RomIndexHeader) + consoles_size);
+	self->pool = (const char*)(base + sizeof(RomIndexHeader) + consoles_size + roms_size);
+
+	// every offset must land inside the pool, and the pool must end in a NUL
+	// so a stray offset can never read past the mapping
+	uint32_t pool_size = header->pool_size;
+	if (self->pool[pool_size - 1] != '\0')
+		return 0;
+	for (uint32_t i = 0; i < header->console_count; i++) {
+		const RomIndexConsole* console = &self->consoles[i];
+		if (console->path >= pool_size || console->name >= pool_size)
+			return 0;
+	}
+	for (uint32_t i = 0; i < header->rom_count; i++) {
+		const RomIndexRom* rom = &self->roms[i];
+		if (rom->path >= pool_size || rom->name >= pool_size || rom->console >= header->console_count)
+			return 0;
+	}
+	return 1;
+}
+
+///////////////////////////////////////
+// Reading
+
+RomIndex* RomIndex_open(const char* path) {
+	int fd = open(path, O_RDONLY);
+	if (fd < 0)
+		return NULL;
+
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+		close(fd);
+		return NULL;
+	}
+
+	void* data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd); // the mapping keeps its own reference
+	if (data == MAP_FAILED)
+		return NULL;
+
+	RomIndex* self = calloc(1, sizeof(RomIndex));
+	if (!self) {
+		munmap(data, st.st_size);
+		return NULL;
+	}
+	self->data = data;
+	self->size = st.st_size;
+	self->is_mapped = 1;
+
+	if (!RomIndex_bind(self)) {
+		LOG_warn("RomIndex_open: ignoring malformed index %s\n", path);
+		RomIndex_free(self);
+		return NULL;
+	}
+	return self;
+}
+
+void RomIndex_free(RomIndex* self) {
+	if (!self)
+		return;
+	if (self->is_mapped)
+		munmap(self->data, self->size);
+	else
+		free(self->data);
+	free(self);
+}
+
+int RomIndex_save(RomIndex* self, const char* path) {
+	// write next to the real file and rename so a concurrent
+	// reader never maps a half-written index
+	char tmp_path[MAX_PATH];
+	snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+
+	FILE* file = fopen(tmp_path, "wb");
+	if (!file)
+		return 0;
+	int ok = fwrite(self->data, 1, self->size, file) == self->size;
+	if (fclose(file) != 0)
+		ok = 0;
+	if (!ok || rename(tmp_path, path) != 0) {
+		unlink(tmp_path);
+		return 0;
+	}
+	return 1;
+}
+
+// FNV-1a of a folder's name and mtime
+static uint64_t RomIndex_folderStamp(const char* name, int64_t mtime) {
+	uint64_t hash = 14695981039346656037ull;
+	while (*name) {
+		hash ^= (uint8_t)*name++;
+		hash *= 1099511628211ull;
+	}
+	for (int i = 0; i < 8; i++) {
+		hash ^= (uint8_t)(mtime >> (i * 8));
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+// summed rather than chained so readdir order doesn't matter
+uint64_t RomIndex_foldersStamp(void) {
+	DIR* dh = opendir(ROMS_PATH);
+	if (!dh)
+		return 0;
+
+	uint64_t stamp = 0;
+	char path[MAX_PATH];
+	struct dirent* dp;
+	while ((dp = readdir(dh)) != NULL) {
+		if (dp->d_name[0] == '.')
+			continue;
+		snprintf(path, sizeof(path), "%s/%s", ROMS_PATH, dp->d_name);
+		struct stat st;
+		if (stat(path, &st) != 0 || !S_ISDIR(st.st_mode))
+			continue;
+		stamp += RomIndex_folderStamp(dp->d_name, (int64_t)st.st_mtime);
+	}
+	closedir(dh);
+	return stamp;
+}
+
+int RomIndex_isFresh(RomIndex* self) {
+	char map_path[MAX_PATH];
+	snprintf(map_path, sizeof(map_path), "%s/map.txt", ROMS_PATH);
+
+	if (RomIndex_mtime(ROMS_PATH) != self->header->roms_mtime)
+		return 0;
+	if (RomIndex_mtime(map_path) != self->header->map_mtime)
+		return 0;
+	// every folder, not just the indexed consoles: adding the first rom to
+	// an empty console folder only changes that folder's mtime
+	return RomIndex_foldersStamp() == self->header->folders_stamp;
+}
+
+int RomIndex_sameConsoles(RomIndex* self, RomIndex* other) {
+	if (self->header->console_count != other->header->console_count)
+		return 0;
+	for (uint32_t i = 0; i < self->header->console_count; i++) {
+		const RomIndexConsole* a = &self->consoles[i];
+		const RomIndexConsole* b = &other->consoles[i];
+		if (strcmp(RomIndex_string(self, a->path), RomIndex_string(other, b->path)) != 0)
+			return 0;
+		if (strcmp(RomIndex_string(self, a->name), RomIndex_string(other, b->name)) != 0)
+			return 0;
+	}
+	return 1;
+}
+
+///////////////////////////////////////
+// Building
+
+struct RomIndexWriter {
+	RomIndexConsole* consoles;
+	int console_count;
+	int console_capacity;
+
+	RomIndexRom* roms;
+	int rom_count;
+	int rom_capacity;
+
+	char* pool;
+	size_t pool_size;
+	size_t pool_capacity;
+};
+
+static void* RomIndexWriter_grow(void* items, int* capacity, int count, size_t item_size) {
+	if (count < *capacity)
+		return items;
+	int new_capacity = *capacity ? *capacity * 2 : 64;
+	void* tmp = realloc(items, new_capacity * item_size);
+	if (!tmp)
+		return NULL;
+	*capacity = new_capacity;
+	return tmp;
+}
+
+// returns the pool offset of str, or UINT32_MAX if the pool could not grow
+static uint32_t RomIndexWriter_intern(RomIndexWriter* self, const char* str) {
+	size_t len = strlen(str) + 1;
+	if (self->pool_size + len > self->pool_capacity) {
+		size_t new_capacity = self->pool_capacity ? self->pool_capacity : 4096;
+		while (self->pool_size + len > new_capacity)
+			new_capacity *= 2;
+		char* tmp = realloc(self->pool, new_capacity);
+		if (!tmp)
+			return UINT32_MAX;
+		self->pool = tmp;
+		self->pool_capacity = new_capacity;
+	}
+	uint32_t offset = self->pool_size;
+	memcpy(self->pool + offset, str, len);
+	self->pool_size += len;
+	return offset;
+}
+
+RomIndexWriter* RomIndexWriter_new(void) {
+	return calloc(1, sizeof(RomIndexWriter));
+}
+
+void RomIndexWriter_free(RomIndexWriter* self) {
+	if (!self)
+		return;
+	free(self->consoles);
+	free(self->roms);
+	free(self->pool);
+	free(self);
+}
+
+int RomIndexWriter_addConsole(RomIndexWriter* self, const char* path, const char* name, time_t mtime) {
+	RomIndexConsole* consoles = RomIndexWriter_grow(self->consoles, &self->console_capacity, self->console_count, sizeof(RomIndexConsole));
+	if (!consoles)
+		return -1;
+	self->consoles = consoles;
+
+	uint32_t path_offset = RomIndexWriter_intern(self, path);
+	uint32_t name_offset = RomIndexWriter_intern(self, name);
+	if (path_offset == UINT32_MAX || name_offset == UINT32_MAX)
+		return -1;
+
+	RomIndexConsole* console = &self->consoles[self->console_count];
+	memset(console, 0, sizeof(RomIndexConsole));
+	console->path = path_offset;
+	console->name = name_offset;
+	console->mtime = mtime;
+	return self->console_count++;
+}
+
+void RomIndexWriter_addRom(RomIndexWriter* self, int console, const char* path, const char* name) {
+	if (console < 0 || console >= self->console_count)
+		return;
+
+	RomIndexRom* roms = RomIndexWriter_grow(self->roms, &self->rom_capacity, self->rom_count, sizeof(RomIndexRom));
+	if (!roms)
+		return;
+	self->roms = roms;
+
+	uint32_t path_offset = RomIndexWriter_intern(self, path);
+	uint32_t name_offset = RomIndexWriter_intern(self, name);
+	if (path_offset == UINT32_MAX || name_offset == UINT32_MAX)
+		return;
+
+	RomIndexRom* rom = &self->roms[self->rom_count++];
+	rom->path = path_offset;
+	rom->name = name_offset;
+	rom->console = console;
+	self->consoles[console].rom_count += 1;
+}
+
+typedef struct RomIndexSortItem {
+	const char* key; // Entry_makeKey of name
+	size_t key_offset; // into the key buffer, which moves while it's built
+	const char* name;
+	RomIndexRom rom;
+} RomIndexSortItem;
+
+// same order as EntryArray_sortEntry so search results line up with
+// the folder view ("Game 2" before "Game 10")
+static int RomIndexWriter_sortRom(const void* a, const void* b) {
+	const RomIndexSortItem* item1 = a;
+	const RomIndexSortItem* item2 = b;
+	int result = strcmp(item1->key, item2->key);
+	if (result)
+		return result;
+	result = strcasecmp(item1->name, item2->name);
+	return result ? result : strcmp(item1->name, item2->name);
+}
+
+// builds every key into one buffer up front so the comparisons are plain
+// strcmps, returns the buffer to free after sorting or NULL
+static char* RomIndexWriter_buildKeys(RomIndexSortItem* items, int count) {
+	size_t size = 4096;
+	size_t used = 0;
+	char* keys = malloc(size);
+	if (!keys)
+		return NULL;
+
+	char key[ENTRY_KEY_SIZE];
+	for (int i = 0; i < count; i++) {
+		Entry_makeKey(items[i].name, key);
+		size_t len = strlen(key) + 1;
+		if (used + len > size) {
+			while (used + len > size)
+				size *= 2;
+			char* tmp = realloc(keys, size);
+			if (!tmp) {
+				free(keys);
+				return NULL;
+			}
+			keys = tmp;
+		}
+		memcpy(keys + used, key, len);
+		items[i].key_offset = used;
+		used += len;
+	}
+	for (int i = 0; i < count; i++)
+		items[i].key = keys + items[i].key_offset;
+	return keys;
+}
+
+RomIndex* RomIndexWriter_finish(RomIndexWriter* self, time_t roms_mtime, time_t map_mtime, uint64_t folders_stamp) {
+	if (RomIndexWriter_intern(self, "") == UINT32_MAX) { // guarantees a non-empty, NUL-terminated pool
+		RomIndexWriter_free(self);
+		return NULL;
+	}
+
+	size_t consoles_size = (size_t)self->console_count * sizeof(RomIndexConsole);
+	size_t roms_size = (size_t)self->rom_count * sizeof(RomIndexRom);
+	size_t size = sizeof(RomIndexHeader) + consoles_size + roms_size + self->pool_size;
+
+	uint8_t* data = malloc(size);
+	RomIndexSortItem* items = malloc(sizeof(RomIndexSortItem) * (self->rom_count ? self->rom_count : 1));
+	RomIndex* index = calloc(1, sizeof(RomIndex));
+	if (!data || !items || !index) {
+		free(data);
+		free(items);
+		free(index);
+		RomIndexWriter_free(self);
+		return NULL;
+	}
+
+	RomIndexHeader* header = (RomIndexHeader*)data;
+	memset(header, 0, sizeof(RomIndexHeader));
+	header->magic = ROMINDEX_MAGIC;
+	header->version = ROMINDEX_VERSION;
+	header->console_count = self->console_count;
+	header->rom_count = self->rom_count;
+	header->pool_size = self->pool_size;
+	header->roms_mtime = roms_mtime;
+	header->map_mtime = map_mtime;
+	header->folders_stamp = folders_stamp;
+
+	uint8_t* out = data + sizeof(RomIndexHeader);
+	memcpy(out, self->consoles, consoles_size);
+	out += consoles_size;
+
+	// sort by name once here so readers can present the rows as-is
+	for (int i = 0; i < self->rom_count; i++) {
+		items[i].name = self->pool + self->roms[i].name;
+		items[i].rom = self->roms[i];
+	}
+	char* keys = RomIndexWriter_buildKeys(items, self->rom_count);
+	if (!keys) {
+		free(data);
+		free(items);
+		free(index);
+		RomIndexWriter_free(self);
+		return NULL;
+	}
+	qsort(items, self->rom_count, sizeof(RomIndexSortItem), RomIndexWriter_sortRom);
+	RomIndexRom* roms = (RomIndexRom*)out;
+	for (int i = 0; i < self->rom_count; i++)
+		roms[i] = items[i].rom;
+	free(keys);
+	free(items);
+	out += roms_size;
+
+	memcpy(out, self->pool, self->pool_size);
+	RomIndexWriter_free(self);
+
+	index->data = data;
+	index->size = size;
+	index->is_mapped = 0;
+	if (!RomIndex_bind(index)) {
+		RomIndex_free(index);
+		return NULL;
+	}
+	return index;
+}
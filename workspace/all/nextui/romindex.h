@@ -0,0 +1,82 @@
+#ifndef ROMINDEX_H
+#define ROMINDEX_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <time.h>
+
+///////////////////////////////////////
+// On-disk layout
+//
+// header | consoles[console_count] | roms[rom_count] | pool[pool_size]
+//
+// All strings live NUL-terminated in the pool and are referenced by
+// byte offset, so a mapped index can be walked without copying anything.
+// Roms are stored sorted by name, in the same order as the folder view
+// (Entry_key, so numbers sort by value).
+
+#define ROMINDEX_MAGIC 0x5849524E // "NRIX"
+#define ROMINDEX_VERSION 3 // 2: Entry_key order instead of strcasecmp, 3: folders_stamp
+
+typedef struct RomIndexHeader {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t console_count;
+	uint32_t rom_count;
+	uint32_t pool_size;
+	uint32_t reserved;
+	int64_t roms_mtime; // mtime of ROMS_PATH itself (console folders added/removed)
+	int64_t map_mtime;	// mtime of ROMS_PATH/map.txt, 0 if missing
+	uint64_t folders_stamp; // RomIndex_foldersStamp, catches folders that aren't consoles (yet)
+} RomIndexHeader;
+
+typedef struct RomIndexConsole {
+	uint32_t path; // pool offset
+	uint32_t name; // pool offset, after map.txt aliasing
+	uint32_t rom_count;
+	uint32_t reserved;
+	int64_t mtime; // console folder mtime when it was scanned
+} RomIndexConsole;
+
+typedef struct RomIndexRom {
+	uint32_t path;	  // pool offset
+	uint32_t name;	  // pool offset, "Display Name (Console)"
+	uint32_t console; // index into consoles
+} RomIndexRom;
+
+///////////////////////////////////////
+// Reading
+
+typedef struct RomIndex {
+	void* data;
+	size_t size;
+	int is_mapped; // data is an mmap of the cache file, otherwise malloc'd
+	const RomIndexHeader* header;
+	const RomIndexConsole* consoles;
+	const RomIndexRom* roms;
+	const char* pool;
+} RomIndex;
+
+RomIndex* RomIndex_open(const char* path); // NULL if missing or malformed
+void RomIndex_free(RomIndex* self);
+int RomIndex_save(RomIndex* self, const char* path);
+int RomIndex_isFresh(RomIndex* self); // compares stored mtimes against the sd card
+uint64_t RomIndex_foldersStamp(void); // names and mtimes of every folder in ROMS_PATH, see RomIndex_isFresh
+int RomIndex_sameConsoles(RomIndex* self, RomIndex* other); // same console paths and names, in order
+
+static inline const char* RomIndex_string(const RomIndex* self, uint32_t offset) {
+	return self->pool + offset;
+}
+
+///////////////////////////////////////
+// Building
+
+typedef struct RomIndexWriter RomIndexWriter;
+
+RomIndexWriter* RomIndexWriter_new(void);
+int RomIndexWriter_addConsole(RomIndexWriter* self, const char* path, const char* name, time_t mtime); // returns console index
+void RomIndexWriter_addRom(RomIndexWriter* self, int console, const char* path, const char* name);
+RomIndex* RomIndexWriter_finish(RomIndexWriter* self, time_t roms_mtime, time_t map_mtime, uint64_t folders_stamp); // frees self
+void RomIndexWriter_free(RomIndexWriter* self);
+
+#endif // ROMINDEX_H
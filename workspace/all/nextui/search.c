@@ -11,7 +11,6 @@
 #include "ui_list.h"
 #include "api.h"
 
-#include <libgen.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -147,7 +146,7 @@ void Search_render(SDL_Surface* screen, SDL_Surface* blackBG, int lastScreen) {
 	}
 
 	if (total == 0) {
-		UI_renderCenteredMessage(screen, "No results");
+		UI_renderCenteredMessage(screen, Content_isIndexing() ? "Still indexing..." : "No results");
 		return;
 	}
 
@@ -157,23 +156,10 @@ void Search_render(SDL_Surface* screen, SDL_Surface* blackBG, int lastScreen) {
 	if (CFG_getShowGameArt()) {
 		Entry* selected_entry = search_results->items[search_selected];
 
-		char path_copy[1024];
-		strncpy(path_copy, selected_entry->path, sizeof(path_copy) - 1);
-		path_copy[sizeof(path_copy) - 1] = '\0';
-		char* rompath = dirname(path_copy);
-
-		char* res_name = strrchr(selected_entry->path, '/');
-		res_name = res_name ? res_name + 1 : (char*)selected_entry->path;
-		char res_copy[1024];
-		strncpy(res_copy, res_name, sizeof(res_copy) - 1);
-		res_copy[sizeof(res_copy) - 1] = '\0';
-		char* dot = strrchr(res_copy, '.');
-		if (dot)
-			*dot = '\0';
-
-		char thumbpath[1024];
-		snprintf(thumbpath, sizeof(thumbpath), "%s/.media/%s.png", rompath, res_copy);
+		char thumbpath[MAX_PATH];
+		getThumbPath(selected_entry, thumbpath, sizeof(thumbpath));
 		had_thumb = startLoadThumb(thumbpath);
+		prefetchEntryThumbs(search_results, search_selected);
 		int max_w = (int)(screen->w - (screen->w * CFG_getGameArtWidth()));
 		if (had_thumb)
 			ox = (int)(max_w)-SCALE1(BUTTON_MARGIN * 5);
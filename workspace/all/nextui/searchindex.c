@@ -0,0 +1,210 @@
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+#include "searchindex.h"
+
+///////////////////////////////////////
+// Folding
+
+// base letters for U+00C0..U+00FF (UTF-8 0xC3 0x80..0xBF)
+static const char latin1_fold[64] =
+	"aaaaaaaceeeeiiii"
+	"dnooooo*ouuuuyts"
+	"aaaaaaaceeeeiiii"
+	"dnooooo/ouuuuyty";
+
+void SearchIndex_fold(const char* in, char* out, size_t out_size) {
+	const uint8_t* src = (const uint8_t*)in;
+	size_t len = 0;
+	while (*src && len + 1 < out_size) {
+		uint8_t c = *src++;
+		if (c == 0xC3 && *src >= 0x80 && *src <= 0xBF) {
+			out[len++] = latin1_fold[*src++ - 0x80];
+		} else {
+			out[len++] = tolower(c);
+		}
+	}
+	out[len] = '\0';
+}
+
+///////////////////////////////////////
+// Trigrams
+
+static inline uint32_t SearchIndex_bucket(const char* s) {
+	uint32_t trigram = ((uint8_t)s[0] << 16) | ((uint8_t)s[1] << 8) | (uint8_t)s[2];
+	return (trigram * 2654435761u) >> 16; // SEARCH_TRIGRAM_BUCKETS
+}
+
+SearchIndex* SearchIndex_new(RomIndex* roms) {
+	SearchIndex* self = calloc(1, sizeof(SearchIndex));
+	if (!self)
+		return NULL;
+	self->roms = roms;
+	self->count = roms->header->rom_count;
+
+	// fold every name into one buffer, folding never makes a name longer
+	size_t folded_size = 0;
+	for (int i = 0; i < self->count; i++)
+		folded_size += strlen(RomIndex_string(roms, roms->roms[i].name)) + 1;
+
+	int rows = self->count ? self->count : 1;
+	self->names = malloc(sizeof(uint32_t) * rows);
+	self->folded = malloc(folded_size ? folded_size : 1);
+	self->buckets = calloc(SEARCH_TRIGRAM_BUCKETS + 1, sizeof(uint32_t));
+	self->last_rows = malloc(sizeof(int) * rows);
+	self->ranked = malloc(sizeof(int) * rows);
+	self->ranks = malloc(rows);
+	uint32_t* last_row = malloc(sizeof(uint32_t) * SEARCH_TRIGRAM_BUCKETS);
+	if (!self->names || !self->folded || !self->buckets || !self->last_rows || !self->ranked || !self->ranks || !last_row) {
+		free(last_row);
+		SearchIndex_free(self);
+		return NULL;
+	}
+
+	size_t offset = 0;
+	for (int i = 0; i < self->count; i++) {
+		const char* name = RomIndex_string(roms, roms->roms[i].name);
+		self->names[i] = offset;
+		SearchIndex_fold(name, self->folded + offset, folded_size - offset);
+		offset += strlen(self->folded + offset) + 1;
+	}
+
+	// count postings per bucket, each row at most once per bucket...
+	memset(last_row, 0xff, sizeof(uint32_t) * SEARCH_TRIGRAM_BUCKETS);
+	for (int i = 0; i < self->count; i++) {
+		const char* name = self->folded + self->names[i];
+		size_t len = strlen(name);
+		for (size_t j = 0; j + 3 <= len; j++) {
+			uint32_t bucket = SearchIndex_bucket(name + j);
+			if (last_row[bucket] == (uint32_t)i)
+				continue;
+			last_row[bucket] = i;
+			self->buckets[bucket + 1] += 1;
+		}
+	}
+	for (int b = 0; b < SEARCH_TRIGRAM_BUCKETS; b++)
+		self->buckets[b + 1] += self->buckets[b];
+
+	// ...then fill them, rows go in ascending so every list is sorted
+	uint32_t total = self->buckets[SEARCH_TRIGRAM_BUCKETS];
+	self->postings = malloc(sizeof(uint32_t) * (total ? total : 1));
+	if (!self->postings) {
+		free(last_row);
+		SearchIndex_free(self);
+		return NULL;
+	}
+	uint32_t* cursor = last_row; // reused, the dedupe check reads the previous posting instead
+	memcpy(cursor, self->buckets, sizeof(uint32_t) * SEARCH_TRIGRAM_BUCKETS);
+	for (int i = 0; i < self->count; i++) {
+		const char* name = self->folded + self->names[i];
+		size_t len = strlen(name);
+		for (size_t j = 0; j + 3 <= len; j++) {
+			uint32_t bucket = SearchIndex_bucket(name + j);
+			if (cursor[bucket] > self->buckets[bucket] && self->postings[cursor[bucket] - 1] == (uint32_t)i)
+				continue;
+			self->postings[cursor[bucket]++] = i;
+		}
+	}
+	free(last_row);
+	return self;
+}
+
+void SearchIndex_free(SearchIndex* self) {
+	if (!self)
+		return;
+	free(self->names);
+	free(self->folded);
+	free(self->buckets);
+	free(self->postings);
+	free(self->last_rows);
+	free(self->ranked);
+	free(self->ranks);
+	free(self);
+}
+
+///////////////////////////////////////
+// Querying
+
+// 0: name starts with q, 1: a word starts with it, 2: anywhere
+static int SearchIndex_rank(const char* name, const char* q) {
+	const char* hit = strstr(name, q);
+	if (hit == name)
+		return 0;
+	while (hit) {
+		if (!isalnum((uint8_t)hit[-1]))
+			return 1;
+		hit = strstr(hit + 1, q);
+	}
+	return 2;
+}
+
+int SearchIndex_query(SearchIndex* self, const char* query, const int** rows) {
+	char q[sizeof(self->last_query)];
+	SearchIndex_fold(query ? query : "", q, sizeof(q));
+	size_t qlen = strlen(q);
+
+	int count = 0;
+	int* matches = self->last_rows;
+
+	if (self->last_query[0] && strstr(q, self->last_query)) {
+		// refining: everything that matches q also matched the last query
+		for (int i = 0; i < self->last_count; i++) {
+			int row = matches[i];
+			if (strstr(self->folded + self->names[row], q))
+				matches[count++] = row;
+		}
+	} else if (qlen >= 3) {
+		// walk the shortest posting list, every other trigram's list must contain the row too
+		int trigram_count = qlen - 2;
+		uint32_t lists[sizeof(q)];
+		uint32_t cursors[sizeof(q)];
+		int shortest = 0;
+		for (int t = 0; t < trigram_count; t++) {
+			lists[t] = SearchIndex_bucket(q + t);
+			cursors[t] = self->buckets[lists[t]];
+			uint32_t size = self->buckets[lists[t] + 1] - self->buckets[lists[t]];
+			uint32_t best = self->buckets[lists[shortest] + 1] - self->buckets[lists[shortest]];
+			if (size < best)
+				shortest = t;
+		}
+
+		uint32_t start = self->buckets[lists[shortest]];
+		uint32_t end = self->buckets[lists[shortest] + 1];
+		for (uint32_t p = start; p < end; p++) {
+			uint32_t row = self->postings[p];
+			int found = 1;
+			for (int t = 0; t < trigram_count && found; t++) {
+				if (t == shortest)
+					continue;
+				uint32_t list_end = self->buckets[lists[t] + 1];
+				while (cursors[t] < list_end && self->postings[cursors[t]] < row)
+					cursors[t] += 1;
+				found = cursors[t] < list_end && self->postings[cursors[t]] == row;
+			}
+			if (found && strstr(self->folded + self->names[row], q))
+				matches[count++] = row;
+		}
+	} else {
+		for (int row = 0; row < self->count; row++) {
+			if (strstr(self->folded + self->names[row], q))
+				matches[count++] = row;
+		}
+	}
+
+	self->last_count = count;
+	strcpy(self->last_query, q);
+
+	// stable counting sort by rank, matches are already alphabetical
+	int starts[3] = {0};
+	for (int i = 0; i < count; i++) {
+		self->ranks[i] = SearchIndex_rank(self->folded + self->names[matches[i]], q);
+		if (self->ranks[i] < 2)
+			starts[self->ranks[i] + 1] += 1;
+	}
+	starts[2] += starts[1];
+	for (int i = 0; i < count; i++)
+		self->ranked[starts[self->ranks[i]]++] = matches[i];
+
+	*rows = self->ranked;
+	return count;
+}
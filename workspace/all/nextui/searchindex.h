@@ -0,0 +1,43 @@
+#ifndef SEARCHINDEX_H
+#define SEARCHINDEX_H
+
+#include "romindex.h"
+
+///////////////////////////////////////
+// SearchIndex
+//
+// Case and accent folded copies of every rom name in a RomIndex plus
+// trigram posting lists, so a query only has to verify the rows that
+// contain all of its trigrams. Built once per RomIndex, which must
+// outlive it.
+
+#define SEARCH_TRIGRAM_BUCKETS 65536 // trigrams are hashed, collisions are weeded out by the verify step
+
+typedef struct SearchIndex {
+	RomIndex* roms;
+	int count;
+	uint32_t* names; // offset into folded for each rom row
+	char* folded;
+	uint32_t* buckets; // SEARCH_TRIGRAM_BUCKETS + 1 offsets into postings
+	uint32_t* postings; // ascending rom rows per bucket
+
+	// the last query and its matches, so a query that extends it only
+	// has to look at those rows again
+	char last_query[256];
+	int* last_rows; // ascending
+	int last_count;
+
+	int* ranked; // last_rows in result order
+	uint8_t* ranks;
+} SearchIndex;
+
+SearchIndex* SearchIndex_new(RomIndex* roms);
+void SearchIndex_free(SearchIndex* self);
+void SearchIndex_fold(const char* in, char* out, size_t out_size); // lowercase, strip latin-1 accents
+
+// Returns matching rom rows in *rows (owned by self, valid until the next
+// query) ranked by where the query hits: start of name, start of a word,
+// anywhere. Rows keep their alphabetical order within a rank.
+int SearchIndex_query(SearchIndex* self, const char* query, const int** rows);
+
+#endif // SEARCHINDEX_H
@@ -0,0 +1,14 @@
+#ifndef __API_H__
+#define __API_H__
+
+// Stand-in for common/api.h, which drags in SDL, so romindex.c can be
+// built into desktop tests. Only define what those sources actually use.
+
+#include <stdio.h>
+
+#define LOG_debug(fmt, ...)
+#define LOG_info(fmt, ...)
+#define LOG_warn(fmt, ...) fprintf(stderr, fmt, ##__VA_ARGS__)
+#define LOG_error(fmt, ...) fprintf(stderr, fmt, ##__VA_ARGS__)
+
+#endif // __API_H__
@@ -0,0 +1,177 @@
+// builds 10k Entries (and their sort keys, like a sorted folder listing)
+// with and without an EntryArena current, then frees them, and reports
+// the time, how many heap allocations that took and how far the heap
+// grew at its peak.
+//
+//	./arena_bench [seconds per row]
+//
+// The counts come from wrapping malloc and friends in this binary, which
+// the sanitizers already do, so SANITIZE builds only print the times.
+// Exits non zero if an arena Entry doesn't read back what went in.
+
+#include <malloc.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "types.h"
+
+#define ENTRY_COUNT 10000
+
+#if defined(__SANITIZE_ADDRESS__) || defined(__SANITIZE_THREAD__)
+#define COUNT_ALLOCATIONS 0
+#else
+#define COUNT_ALLOCATIONS 1
+#endif
+
+///////////////////////////////
+
+#if COUNT_ALLOCATIONS
+
+extern void* __libc_malloc(size_t size);
+extern void* __libc_calloc(size_t count, size_t size);
+extern void* __libc_realloc(void* ptr, size_t size);
+extern void __libc_free(void* ptr);
+
+static long allocations = 0;
+static long heap_bytes = 0;
+static long heap_peak = 0;
+
+static void* counted(void* ptr) {
+	if (ptr) {
+		allocations++;
+		heap_bytes += malloc_usable_size(ptr);
+		if (heap_bytes > heap_peak)
+			heap_peak = heap_bytes;
+	}
+	return ptr;
+}
+
+void* malloc(size_t size) {
+	return counted(__libc_malloc(size));
+}
+void* calloc(size_t count, size_t size) {
+	return counted(__libc_calloc(count, size));
+}
+void* realloc(void* ptr, size_t size) {
+	if (ptr)
+		heap_bytes -= malloc_usable_size(ptr);
+	void* result = __libc_realloc(ptr, size);
+	if (!result && ptr && size)
+		heap_bytes += malloc_usable_size(ptr); // failed, ptr is still ours
+	return counted(result);
+}
+void free(void* ptr) {
+	if (ptr)
+		heap_bytes -= malloc_usable_size(ptr);
+	__libc_free(ptr);
+}
+
+#endif
+
+///////////////////////////////
+
+static double now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static char paths[ENTRY_COUNT][64];
+static char names[ENTRY_COUNT][48];
+
+typedef struct Stats {
+	double build_us;
+	double free_us;
+	long allocations;
+	long heap_peak; // bytes above where the heap was before the build
+} Stats;
+
+static Array* build(void) {
+	Array* entries = Array_new();
+	for (int i = 0; i < ENTRY_COUNT; i++) {
+		Entry* entry = Entry_newNamed(paths[i], ENTRY_ROM, names[i]);
+		Entry_key(entry);
+		Array_push(entries, entry);
+	}
+	return entries;
+}
+
+static int check(Array* entries) {
+	for (int i = 0; i < ENTRY_COUNT; i++) {
+		Entry* entry = entries->items[i];
+		if (strcmp(entry->path, paths[i]) != 0 || strcmp(entry->name, names[i]) != 0) {
+			printf("FAIL: entry %i reads back as %s, %s\n", i, entry->path, entry->name);
+			return 0;
+		}
+	}
+	return 1;
+}
+
+static Stats run(int use_arena, double seconds, int* ok) {
+	Stats stats = {0};
+	int runs = 0;
+	double start = now();
+	do {
+#if COUNT_ALLOCATIONS
+		long allocations_before = allocations;
+		heap_peak = heap_bytes;
+		long heap_before = heap_bytes;
+#endif
+		double t = now();
+		EntryArena* arena = use_arena ? EntryArena_new() : NULL;
+		EntryArena* previous = EntryArena_use(arena);
+		Array* entries = build();
+		EntryArena_use(previous);
+		stats.build_us += now() - t;
+#if COUNT_ALLOCATIONS
+		stats.allocations = allocations - allocations_before;
+		stats.heap_peak = heap_peak - heap_before;
+#endif
+		if (runs == 0)
+			*ok &= check(entries);
+
+		t = now();
+		EntryArray_free(entries); // no-op per Entry for the arena ones
+		EntryArena_free(arena);
+		stats.free_us += now() - t;
+		runs++;
+	} while (now() - start < seconds);
+
+	stats.build_us = stats.build_us / runs * 1e6;
+	stats.free_us = stats.free_us / runs * 1e6;
+	return stats;
+}
+
+int main(int argc, char* argv[]) {
+	double seconds = argc > 1 ? atof(argv[1]) : 0.5;
+
+	srand(18);
+	for (int i = 0; i < ENTRY_COUNT; i++) {
+		int game = rand() % 100000;
+		int rev = rand() % 3;
+		snprintf(names[i], sizeof(names[i]), "Game %05i (Rev %i)", game, rev);
+		snprintf(paths[i], sizeof(paths[i]), "/Roms/Game Boy (GB)/Game %05i (Rev %i).gb", game, rev);
+	}
+
+	int ok = 1;
+	Stats heap = run(0, seconds, &ok);
+	Stats arena = run(1, seconds, &ok);
+
+	printf("%i entries with keys\n", ENTRY_COUNT);
+	printf("%-8s %10s %10s %12s %12s\n", "", "build us", "free us", "allocations", "heap peak");
+	Stats* rows[] = {&heap, &arena};
+	const char* labels[] = {"malloc", "arena"};
+	for (int i = 0; i < 2; i++) {
+		printf("%-8s %10.0f %10.0f", labels[i], rows[i]->build_us, rows[i]->free_us);
+		if (COUNT_ALLOCATIONS)
+			printf(" %12li %12li\n", rows[i]->allocations, rows[i]->heap_peak);
+		else
+			printf(" %12s %12s\n", "-", "-");
+	}
+
+	if (!ok)
+		printf("arena entries FAILED\n");
+	return ok ? 0 : 1;
+}
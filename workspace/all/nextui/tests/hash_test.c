@@ -0,0 +1,260 @@
+// checks the Hash in types.c: set/get across several table growths,
+// overwriting, missing keys, Hash_loadMap on a messy map.txt, and that the
+// strings it hands out stay put while more gets inserted (the arena
+// promise in types.h).
+//
+//	make hash_test && ./hash_test
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "types.h"
+
+static int failures = 0;
+
+#define CHECK(cond, ...)         \
+	do {                         \
+		if (!(cond)) {           \
+			printf("  FAIL: ");  \
+			printf(__VA_ARGS__); \
+			printf("\n");        \
+			if (++failures > 20) \
+				exit(1);         \
+		}                        \
+	} while (0)
+
+static int sameString(const char* a, const char* b) {
+	return a && b && strcmp(a, b) == 0;
+}
+
+///////////////////////////////
+
+#define GROWTH_KEYS 5000 // 16 slots to start with, so this grows nine times
+
+static void checkGrowth(void) {
+	Hash* hash = Hash_new();
+	char key[32];
+	char value[32];
+	int growths = 0;
+	int capacity = hash->capacity;
+
+	for (int i = 0; i < GROWTH_KEYS; i++) {
+		snprintf(key, sizeof(key), "key %i", i);
+		snprintf(value, sizeof(value), "value %i", i);
+		Hash_set(hash, key, value);
+
+		if (hash->capacity != capacity) {
+			growths += 1;
+			capacity = hash->capacity;
+			// everything from before the grow has to have been rehashed
+			for (int j = 0; j <= i; j++) {
+				snprintf(key, sizeof(key), "key %i", j);
+				snprintf(value, sizeof(value), "value %i", j);
+				CHECK(sameString(Hash_get(hash, key), value), "after growing to %i: %s = %s", capacity, key, Hash_get(hash, key));
+			}
+		}
+	}
+	CHECK(hash->count == GROWTH_KEYS, "count %i, expected %i", hash->count, GROWTH_KEYS);
+	CHECK(growths >= 3, "only grew %i times", growths);
+	CHECK(hash->count * 4 <= hash->capacity * 3, "load factor over 3/4 (%i in %i)", hash->count, hash->capacity);
+
+	for (int i = 0; i < GROWTH_KEYS; i++) {
+		snprintf(key, sizeof(key), "key %i", i);
+		snprintf(value, sizeof(value), "value %i", i);
+		CHECK(sameString(Hash_get(hash, key), value), "%s = %s", key, Hash_get(hash, key));
+	}
+	printf("growth: %i keys over %i growths, %i slots\n", GROWTH_KEYS, growths, hash->capacity);
+	Hash_free(hash);
+}
+
+static void checkOverwrite(void) {
+	Hash* hash = Hash_new();
+	Hash_set(hash, "gb", "Game Boy");
+	Hash_set(hash, "gbc", "Game Boy Color");
+	Hash_set(hash, "gb", "GB");
+	Hash_set(hash, "gb", "Nintendo Game Boy");
+	CHECK(sameString(Hash_get(hash, "gb"), "Nintendo Game Boy"), "gb = %s, expected the last value", Hash_get(hash, "gb"));
+	CHECK(sameString(Hash_get(hash, "gbc"), "Game Boy Color"), "gbc = %s, neighbour changed", Hash_get(hash, "gbc"));
+	CHECK(hash->count == 2, "count %i after overwriting, expected 2", hash->count);
+
+	// overwriting with an empty value is still a value, not a delete
+	Hash_set(hash, "gbc", "");
+	CHECK(sameString(Hash_get(hash, "gbc"), ""), "gbc = %s, expected empty", Hash_get(hash, "gbc"));
+	CHECK(hash->count == 2, "count %i after an empty overwrite, expected 2", hash->count);
+
+	// and so is an empty key
+	Hash_set(hash, "", "nothing");
+	CHECK(sameString(Hash_get(hash, ""), "nothing"), "empty key = %s", Hash_get(hash, ""));
+	Hash_free(hash);
+	printf("overwrite: last set wins\n");
+}
+
+static void checkMissing(void) {
+	Hash* hash = Hash_new();
+	CHECK(Hash_get(hash, "anything") == NULL, "empty hash returned a value");
+	CHECK(Hash_get(hash, "") == NULL, "empty hash returned a value for the empty key");
+
+	char key[32];
+	for (int i = 0; i < 200; i += 2) {
+		snprintf(key, sizeof(key), "%i", i);
+		Hash_set(hash, key, key);
+	}
+	// the odd ones were never set, some of them probe past full slots
+	for (int i = 1; i < 200; i += 2) {
+		snprintf(key, sizeof(key), "%i", i);
+		CHECK(Hash_get(hash, key) == NULL, "%s was never set but = %s", key, Hash_get(hash, key));
+	}
+	// prefixes and extensions of existing keys aren't matches
+	CHECK(Hash_get(hash, "1") == NULL, "prefix of 10 matched");
+	CHECK(Hash_get(hash, "100 ") == NULL, "extension of 100 matched");
+	CHECK(Hash_get(hash, "0") != NULL, "0 went missing");
+	Hash_free(hash);
+	printf("missing: never set keys return NULL\n");
+}
+
+///////////////////////////////
+
+static char* writeTemp(const char* contents, size_t size) {
+	static char path[64];
+	snprintf(path, sizeof(path), "/tmp/hash_test_XXXXXX");
+	int fd = mkstemp(path);
+	if (fd < 0) {
+		perror("mkstemp");
+		exit(1);
+	}
+	if (write(fd, contents, size) != (ssize_t)size) {
+		perror("write");
+		exit(1);
+	}
+	close(fd);
+	return path;
+}
+
+static void checkLoadMap(void) {
+	// what a hand edited map.txt ends up looking like
+	static const char map[] =
+		"mario.gb\tSuper Mario Land\r\n"
+		"\r\n"
+		"\n"
+		"zelda.gb\tLink's Awakening\n"
+		"no tab on this line\r\n"
+		"tetris.gb\tTetris\r\n"
+		"mario.gb\tSuper Mario Land (USA)\r\n" // duplicate, last one wins
+		"\tno key\n"
+		"empty.gb\t\r\n"
+		"tabs.gb\tvalue\twith a tab\n"
+		"trailing.gb\tno newline at the end";
+
+	Hash* hash = Hash_new();
+	char* path = writeTemp(map, sizeof(map) - 1);
+	int count = Hash_loadMap(hash, path);
+	unlink(path);
+
+	// every line with a tab is a pair, duplicates included
+	CHECK(count == 8, "Hash_loadMap returned %i, expected 8", count);
+	CHECK(hash->count == 7, "%i unique keys, expected 7", hash->count);
+
+	CHECK(sameString(Hash_get(hash, "mario.gb"), "Super Mario Land (USA)"), "duplicate key: mario.gb = %s", Hash_get(hash, "mario.gb"));
+	CHECK(sameString(Hash_get(hash, "zelda.gb"), "Link's Awakening"), "LF line: zelda.gb = %s", Hash_get(hash, "zelda.gb"));
+	CHECK(sameString(Hash_get(hash, "tetris.gb"), "Tetris"), "CRLF line: tetris.gb = %s", Hash_get(hash, "tetris.gb"));
+	CHECK(sameString(Hash_get(hash, "empty.gb"), ""), "empty value: empty.gb = %s", Hash_get(hash, "empty.gb"));
+	CHECK(sameString(Hash_get(hash, "tabs.gb"), "value\twith a tab"), "splits on the first tab only: tabs.gb = %s", Hash_get(hash, "tabs.gb"));
+	CHECK(sameString(Hash_get(hash, "trailing.gb"), "no newline at the end"), "last line: trailing.gb = %s", Hash_get(hash, "trailing.gb"));
+	CHECK(sameString(Hash_get(hash, ""), "no key"), "empty key = %s", Hash_get(hash, ""));
+	CHECK(Hash_get(hash, "no tab on this line") == NULL, "line without a tab became a key");
+	CHECK(Hash_get(hash, "mario.gb\r") == NULL, "carriage return left on a key");
+
+	// a map loaded on top of set values overrides them, and set after
+	// load overrides the map
+	Hash_set(hash, "tetris.gb", "Tetris DX");
+	CHECK(sameString(Hash_get(hash, "tetris.gb"), "Tetris DX"), "set after load: tetris.gb = %s", Hash_get(hash, "tetris.gb"));
+	static const char more[] = "zelda.gb\tThe Legend of Zelda\n";
+	path = writeTemp(more, sizeof(more) - 1);
+	CHECK(Hash_loadMap(hash, path) == 1, "second map");
+	unlink(path);
+	CHECK(sameString(Hash_get(hash, "zelda.gb"), "The Legend of Zelda"), "second map: zelda.gb = %s", Hash_get(hash, "zelda.gb"));
+
+	// nothing to load
+	path = writeTemp("", 0);
+	CHECK(Hash_loadMap(hash, path) == 0, "empty file");
+	unlink(path);
+	CHECK(Hash_loadMap(hash, "/nonexistent/map.txt") == 0, "missing file");
+	CHECK(hash->count == 7, "%i keys after the empty loads, expected 7", hash->count);
+
+	Hash_free(hash);
+	printf("loadMap: CRLF, blank lines, missing tabs and duplicates handled\n");
+}
+
+///////////////////////////////
+
+#define STABLE_KEYS 64
+
+static void checkStability(void) {
+	Hash* hash = Hash_new();
+
+	static const char map[] = "alpha\tfrom the map\r\nbeta\tfrom the map too\n";
+	char* path = writeTemp(map, sizeof(map) - 1);
+	Hash_loadMap(hash, path);
+	unlink(path);
+	char* mapped = Hash_get(hash, "alpha");
+
+	char key[32];
+	char value[32];
+	char* held[STABLE_KEYS];
+	for (int i = 0; i < STABLE_KEYS; i++) {
+		snprintf(key, sizeof(key), "held %i", i);
+		snprintf(value, sizeof(value), "held value %i", i);
+		Hash_set(hash, key, value);
+		held[i] = Hash_get(hash, key);
+	}
+
+	// replaced values stay in the arena until Hash_free too
+	char* replaced = Hash_get(hash, "beta");
+	Hash_set(hash, "beta", "replaced");
+
+	// lots more: several grows of the slot table and many new arena blocks,
+	// plus one string too long for a regular block
+	char* big = malloc(10000);
+	memset(big, 'x', 9999);
+	big[9999] = '\0';
+	Hash_set(hash, "big", big);
+	for (int i = 0; i < 20000; i++) {
+		snprintf(key, sizeof(key), "filler %i", i);
+		snprintf(value, sizeof(value), "filler value %i", i);
+		Hash_set(hash, key, value);
+	}
+
+	for (int i = 0; i < STABLE_KEYS; i++) {
+		snprintf(key, sizeof(key), "held %i", i);
+		snprintf(value, sizeof(value), "held value %i", i);
+		CHECK(Hash_get(hash, key) == held[i], "%s moved", key);
+		CHECK(sameString(held[i], value), "%s was overwritten with %s", key, held[i]);
+	}
+	CHECK(Hash_get(hash, "alpha") == mapped, "mapped value moved");
+	CHECK(sameString(mapped, "from the map"), "mapped value overwritten with %s", mapped);
+	CHECK(sameString(replaced, "from the map too"), "replaced value overwritten with %s", replaced);
+	CHECK(sameString(Hash_get(hash, "beta"), "replaced"), "beta = %s", Hash_get(hash, "beta"));
+	CHECK(sameString(Hash_get(hash, "big"), big), "big value mangled");
+	CHECK(Hash_get(hash, "big") != big, "big value not copied");
+
+	free(big);
+	Hash_free(hash);
+	printf("stability: returned strings survive further inserts\n");
+}
+
+int main(void) {
+	checkGrowth();
+	checkOverwrite();
+	checkMissing();
+	checkLoadMap();
+	checkStability();
+
+	if (failures) {
+		printf("%i failures\n", failures);
+		return 1;
+	}
+	printf("ok\n");
+	return 0;
+}
@@ -0,0 +1,10 @@
+#ifndef PLATFORM_H
+#define PLATFORM_H
+
+// Stand-in for workspace/<platform>/platform/platform.h so the SDL-free
+// parts of nextui/ (and the common/utils.c they lean on) can be built into
+// desktop tests. Only define what those sources actually use.
+
+#define SDCARD_PATH "/tmp/nextui-tests"
+
+#endif // PLATFORM_H
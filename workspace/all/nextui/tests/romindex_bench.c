@@ -0,0 +1,250 @@
+// times loading and searching 50k generated roms from the binary rom
+// index (romindex.c) against the tab separated text cache it replaced,
+// parsed the way content.c used to: fgets every line and strdup it into
+// an Entry. Both caches are written from the same rows, so every search
+// is also checked to return the same roms in the same order.
+//
+//	./romindex_bench [seconds per row]
+//
+// open is what getRomIndex() does on launch, search is a cold
+// Content_searchRoms() (load, filter, keep Entries for the hits).
+// Exits non zero if the two disagree.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "romindex.h"
+#include "types.h"
+
+#define ROM_COUNT 50000
+
+static const char* consoles[] = {
+	"Game Boy (GB)", "Game Boy Color (GBC)", "Game Boy Advance (GBA)", "Nintendo Entertainment System (FC)",
+	"Super Nintendo Entertainment System (SFC)", "Sega Genesis (MD)", "Sega Master System (SMS)", "Sega Game Gear (GG)",
+	"Sony PlayStation (PS)", "TurboGrafx-16 (PCE)", "Neo Geo Pocket Color (NGPC)", "Atari Lynx (LYNX)",
+	"Pico-8 (P8)", "Arcade (FBN)", "Virtual Boy (VB)", "Pokemon mini (PKM)",
+};
+#define CONSOLE_COUNT (int)(sizeof(consoles) / sizeof(consoles[0]))
+
+static const char* words[] = {
+	"Super", "Mario", "Legend", "Dragon", "Quest", "Final", "Fantasy", "Sonic", "Street", "Fighter",
+	"Mega", "Man", "Castle", "Metal", "Gear", "Star", "Wars", "Racing", "Tennis", "Golf",
+	"Kirby", "Adventure", "Island", "Zelda", "Donkey", "Kong", "Tetris", "Puzzle", "Bomber", "Ninja",
+};
+#define WORD_COUNT (int)(sizeof(words) / sizeof(words[0]))
+
+static const char* queries[] = {"zelda", "kong 1", "mario", ""};
+#define QUERY_COUNT (int)(sizeof(queries) / sizeof(queries[0]))
+
+static double now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+///////////////////////////////
+// the text cache, as content.c wrote and read it before the binary index
+
+static void writeRomIndexCache(RomIndex* index, const char* path) {
+	FILE* file = fopen(path, "w");
+	if (!file) {
+		perror(path);
+		exit(1);
+	}
+	for (uint32_t i = 0; i < index->header->rom_count; i++) {
+		const RomIndexRom* rom = &index->roms[i];
+		fputs(RomIndex_string(index, rom->path), file);
+		fputc('\t', file);
+		fputs(RomIndex_string(index, rom->name), file);
+		fputc('\n', file);
+	}
+	fclose(file);
+}
+
+static Array* readRomIndexCache(const char* path) {
+	FILE* file = fopen(path, "r");
+	if (!file)
+		return NULL;
+
+	Array* entries = Array_new();
+	char line[MAX_PATH * 2];
+	while (fgets(line, sizeof(line), file) != NULL) {
+		normalizeNewline(line);
+		trimTrailingNewlines(line);
+		if (strlen(line) == 0)
+			continue;
+
+		char* tab = strchr(line, '\t');
+		if (!tab) {
+			EntryArray_free(entries);
+			fclose(file);
+			return NULL;
+		}
+		*tab = '\0';
+		char* path = line;
+		char* name = tab + 1;
+		Array_push(entries, Entry_newNamed(path, ENTRY_ROM, name));
+	}
+	fclose(file);
+	return entries;
+}
+
+static Array* searchText(const char* path, const char* query) {
+	Array* all_roms = readRomIndexCache(path);
+	if (!all_roms)
+		return Array_new();
+
+	if (!query || strlen(query) == 0)
+		return all_roms;
+
+	Array* results = Array_new();
+	for (int i = 0; i < all_roms->count; i++) {
+		Entry* entry = all_roms->items[i];
+		if (containsString(entry->name, (char*)query)) {
+			Array_push(results, entry);
+		} else {
+			Entry_free(entry);
+		}
+	}
+	Array_free(all_roms);
+	return results;
+}
+
+///////////////////////////////
+// the binary index, as content.c uses it now
+
+static Array* searchIndex(const char* path, const char* query) {
+	Array* results = Array_new();
+	RomIndex* index = RomIndex_open(path);
+	if (!index)
+		return results;
+
+	int match_all = !query || strlen(query) == 0;
+	for (uint32_t i = 0; i < index->header->rom_count; i++) {
+		const RomIndexRom* rom = &index->roms[i];
+		const char* name = RomIndex_string(index, rom->name);
+		if (match_all || containsString((char*)name, (char*)query))
+			Array_push(results, Entry_newNamed(RomIndex_string(index, rom->path), ENTRY_ROM, name));
+	}
+	RomIndex_free(index);
+	return results;
+}
+
+///////////////////////////////
+
+static RomIndex* generate(void) {
+	RomIndexWriter* writer = RomIndexWriter_new();
+	int console_ids[CONSOLE_COUNT];
+	for (int c = 0; c < CONSOLE_COUNT; c++) {
+		char path[MAX_PATH];
+		snprintf(path, sizeof(path), "%s/%s", ROMS_PATH, consoles[c]);
+		console_ids[c] = RomIndexWriter_addConsole(writer, path, consoles[c], 0);
+	}
+
+	srand(11);
+	for (int i = 0; i < ROM_COUNT; i++) {
+		int c = i % CONSOLE_COUNT;
+		char title[128];
+		snprintf(title, sizeof(title), "%s %s %i", words[rand() % WORD_COUNT], words[rand() % WORD_COUNT], i / CONSOLE_COUNT);
+
+		char path[MAX_PATH];
+		snprintf(path, sizeof(path), "%s/%s/%s (USA).zip", ROMS_PATH, consoles[c], title);
+		char name[MAX_PATH];
+		snprintf(name, sizeof(name), "%s (%s)", title, consoles[c]);
+		RomIndexWriter_addRom(writer, console_ids[c], path, name);
+	}
+	return RomIndexWriter_finish(writer, 0, 0, 0);
+}
+
+static int sameResults(Array* a, Array* b) {
+	if (a->count != b->count)
+		return 0;
+	for (int i = 0; i < a->count; i++) {
+		Entry* x = a->items[i];
+		Entry* y = b->items[i];
+		if (strcmp(x->path, y->path) != 0 || strcmp(x->name, y->name) != 0)
+			return 0;
+	}
+	return 1;
+}
+
+// ms per open (or search, with search set) of the text cache at text_path,
+// or of the index at index_path when text_path is NULL
+static double timeIt(const char* text_path, const char* index_path, const char* query, int search, double seconds) {
+	int runs = 0;
+	double start = now();
+	double elapsed = 0.0;
+	do {
+		if (search) {
+			Array* results = text_path ? searchText(text_path, query) : searchIndex(index_path, query);
+			EntryArray_free(results);
+		} else if (text_path) {
+			EntryArray_free(readRomIndexCache(text_path));
+		} else {
+			RomIndex_free(RomIndex_open(index_path));
+		}
+		runs++;
+		elapsed = now() - start;
+	} while (elapsed < seconds);
+	return elapsed / runs * 1e3;
+}
+
+int main(int argc, char* argv[]) {
+	double seconds = argc > 1 ? atof(argv[1]) : 0.5;
+
+	char text_path[] = "/tmp/romindex_bench_XXXXXX";
+	int fd = mkstemp(text_path);
+	if (fd < 0) {
+		perror("mkstemp");
+		return 1;
+	}
+	close(fd);
+	char index_path[sizeof(text_path) + 4];
+	snprintf(index_path, sizeof(index_path), "%s.bin", text_path);
+
+	RomIndex* index = generate();
+	if (!index || index->header->rom_count != ROM_COUNT) {
+		printf("FAIL: couldn't build the index\n");
+		return 1;
+	}
+	writeRomIndexCache(index, text_path);
+	if (!RomIndex_save(index, index_path)) {
+		printf("FAIL: couldn't save the index\n");
+		return 1;
+	}
+	RomIndex_free(index);
+
+	int failed = 0;
+	for (int q = 0; q < QUERY_COUNT; q++) {
+		Array* text = searchText(text_path, queries[q]);
+		Array* binary = searchIndex(index_path, queries[q]);
+		if (!sameResults(text, binary)) {
+			printf("FAIL: \"%s\" found %i roms in the text cache, %i in the index\n", queries[q], text->count, binary->count);
+			failed++;
+		}
+		EntryArray_free(text);
+		EntryArray_free(binary);
+	}
+
+	printf("%i roms across %i consoles\n", ROM_COUNT, CONSOLE_COUNT);
+	printf("%-16s %10s %10s %8s\n", "", "text ms", "index ms", "speedup");
+	double text_ms = timeIt(text_path, NULL, NULL, 0, seconds);
+	double index_ms = timeIt(NULL, index_path, NULL, 0, seconds);
+	printf("%-16s %10.3f %10.3f %7.0fx\n", "open", text_ms, index_ms, text_ms / index_ms);
+	for (int q = 0; q < QUERY_COUNT; q++) {
+		char label[32];
+		snprintf(label, sizeof(label), "search \"%s\"", queries[q]);
+		text_ms = timeIt(text_path, NULL, queries[q], 1, seconds);
+		index_ms = timeIt(NULL, index_path, queries[q], 1, seconds);
+		printf("%-16s %10.3f %10.3f %7.1fx\n", label, text_ms, index_ms, text_ms / index_ms);
+	}
+
+	unlink(text_path);
+	unlink(index_path);
+	if (failed)
+		printf("%i searches FAILED\n", failed);
+	return failed ? 1 : 0;
+}
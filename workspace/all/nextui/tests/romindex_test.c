@@ -0,0 +1,155 @@
+// checks RomIndex_isFresh against a small ROMS_PATH under SDCARD_PATH: it
+// has to notice a rom added to an indexed console, the first rom added to
+// an empty console folder (not in the index at all), a new folder and a
+// new map.txt, and has to go back to fresh once the mtimes do. Also that
+// a saved index opens again with the same header.
+//
+//	make romindex_test && ./romindex_test
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+
+#include "romindex.h"
+#include "types.h"
+
+#define GB_PATH ROMS_PATH "/Game Boy (GB)"
+#define MD_PATH ROMS_PATH "/Sega Genesis (MD)"
+#define NEW_PATH ROMS_PATH "/Pico-8 (P8)"
+#define MAP_PATH ROMS_PATH "/map.txt"
+#define INDEX_PATH SDCARD_PATH "/romindex_test.bin"
+#define OLD_MTIME 1000000000 // 2001, nothing the test does lands there
+
+static int failures = 0;
+
+#define CHECK(cond, ...)         \
+	do {                         \
+		if (!(cond)) {           \
+			printf("  FAIL: ");  \
+			printf(__VA_ARGS__); \
+			printf("\n");        \
+			if (++failures > 20) \
+				exit(1);         \
+		}                        \
+	} while (0)
+
+static void touchFile(const char* path) {
+	FILE* file = fopen(path, "w");
+	if (!file) {
+		perror(path);
+		exit(1);
+	}
+	fclose(file);
+}
+
+static void setOld(const char* path) {
+	struct timeval times[2] = {{OLD_MTIME, 0}, {OLD_MTIME, 0}};
+	if (utimes(path, times) != 0) {
+		perror(path);
+		exit(1);
+	}
+}
+
+static void clean(void) {
+	unlink(GB_PATH "/Tetris.gb");
+	unlink(GB_PATH "/Kirby.gb");
+	unlink(MD_PATH "/Sonic.md");
+	unlink(MAP_PATH);
+	rmdir(GB_PATH);
+	rmdir(MD_PATH);
+	rmdir(NEW_PATH);
+	rmdir(ROMS_PATH);
+	unlink(INDEX_PATH);
+}
+
+// one rom in GB, MD empty, everything at OLD_MTIME
+static void setUp(void) {
+	clean();
+	mkdir(SDCARD_PATH, 0755);
+	if (mkdir(ROMS_PATH, 0755) != 0 || mkdir(GB_PATH, 0755) != 0 || mkdir(MD_PATH, 0755) != 0) {
+		perror(ROMS_PATH);
+		exit(1);
+	}
+	touchFile(GB_PATH "/Tetris.gb");
+	setOld(GB_PATH);
+	setOld(MD_PATH);
+	setOld(ROMS_PATH);
+}
+
+// what buildRomIndex writes for the tree setUp makes: only GB has roms
+static RomIndex* build(void) {
+	struct stat st;
+	stat(ROMS_PATH, &st);
+	RomIndexWriter* writer = RomIndexWriter_new();
+	int gb = RomIndexWriter_addConsole(writer, GB_PATH, "Game Boy", OLD_MTIME);
+	RomIndexWriter_addRom(writer, gb, GB_PATH "/Tetris.gb", "Tetris (Game Boy)");
+	return RomIndexWriter_finish(writer, st.st_mtime, 0, RomIndex_foldersStamp());
+}
+
+static void checkSaveOpen(void) {
+	setUp();
+	RomIndex* index = build();
+	CHECK(index && RomIndex_isFresh(index), "a just built index isn't fresh");
+	CHECK(RomIndex_save(index, INDEX_PATH), "couldn't save to %s", INDEX_PATH);
+	RomIndex* opened = RomIndex_open(INDEX_PATH);
+	CHECK(opened, "couldn't open what was saved");
+	if (opened) {
+		CHECK(memcmp(opened->header, index->header, sizeof(RomIndexHeader)) == 0, "header changed on the way through disk");
+		CHECK(RomIndex_sameConsoles(opened, index), "consoles changed on the way through disk");
+		CHECK(RomIndex_isFresh(opened), "reopened index isn't fresh");
+	}
+	RomIndex_free(opened);
+	RomIndex_free(index);
+	printf("save/open: header and consoles survive, still fresh\n");
+}
+
+static void checkFreshness(void) {
+	setUp();
+	RomIndex* index = build();
+	CHECK(RomIndex_isFresh(index), "untouched tree isn't fresh");
+
+	// the case that used to slip through: MD isn't in the index at all
+	touchFile(MD_PATH "/Sonic.md");
+	setOld(ROMS_PATH); // only to be sure the folder itself is what's noticed
+	CHECK(!RomIndex_isFresh(index), "first rom in an empty console folder not noticed");
+	unlink(MD_PATH "/Sonic.md");
+	setOld(MD_PATH);
+	CHECK(RomIndex_isFresh(index), "not fresh again once the empty folder is back as it was");
+
+	touchFile(GB_PATH "/Kirby.gb");
+	setOld(ROMS_PATH);
+	CHECK(!RomIndex_isFresh(index), "rom added to an indexed console not noticed");
+	unlink(GB_PATH "/Kirby.gb");
+	setOld(GB_PATH);
+	CHECK(RomIndex_isFresh(index), "not fresh again once the console is back as it was");
+
+	mkdir(NEW_PATH, 0755);
+	setOld(NEW_PATH);
+	setOld(ROMS_PATH);
+	CHECK(!RomIndex_isFresh(index), "new folder not noticed even with ROMS_PATH's mtime put back");
+	rmdir(NEW_PATH);
+	setOld(ROMS_PATH);
+	CHECK(RomIndex_isFresh(index), "not fresh again once the new folder is gone");
+
+	touchFile(MAP_PATH);
+	setOld(ROMS_PATH);
+	CHECK(!RomIndex_isFresh(index), "new map.txt not noticed");
+
+	RomIndex_free(index);
+	printf("isFresh: roms in indexed and empty consoles, new folders and map.txt\n");
+}
+
+int main(void) {
+	checkSaveOpen();
+	checkFreshness();
+	clean();
+
+	if (failures)
+		printf("%d failures\n", failures);
+	else
+		printf("ok\n");
+	return failures ? 1 : 0;
+}
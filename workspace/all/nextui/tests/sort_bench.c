@@ -0,0 +1,140 @@
+// times EntryArray_sort (collation keys, plain strcmp) against the
+// strcasecmp comparator it replaced on 20k generated rom names, shuffled
+// the same way before every run.
+//
+//	./sort_bench [seconds per row]
+//
+// "keys cold" is what a freshly read folder pays, key building included,
+// "keys warm" a re-sort of Entries that already have theirs. Exits non
+// zero if the key sort leaves anything out of order.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+
+#include "types.h"
+
+#define ENTRY_COUNT 20000
+
+static const char* words[] = {
+	"Super", "mario", "Legend", "Dragon", "Quest", "Final", "fantasy", "Sonic", "Street", "Fighter",
+	"Mega", "Man", "Castle", "Metal", "Gear", "Star", "Wars", "Racing", "Tennis", "Golf",
+	"Kirby", "Adventure", "Island", "Zelda", "Donkey", "Kong", "Tetris", "Puzzle", "bomber", "Ninja",
+};
+#define WORD_COUNT (int)(sizeof(words) / sizeof(words[0]))
+
+static const char* suffixes[] = {"", " (USA)", " (Europe)", " (Japan) (Rev 1)", " (Disc 1)", " (Disc 2)", " (Disc 10)"};
+#define SUFFIX_COUNT (int)(sizeof(suffixes) / sizeof(suffixes[0]))
+
+static double now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// EntryArray_sortEntry before collation keys
+static int sortStrcasecmp(const void* a, const void* b) {
+	Entry* item1 = *(Entry**)a;
+	Entry* item2 = *(Entry**)b;
+	return strcasecmp(item1->name, item2->name);
+}
+
+static void shuffle(void** items, int count) {
+	for (int i = count - 1; i > 0; i--) {
+		int j = rand() % (i + 1);
+		void* tmp = items[i];
+		items[i] = items[j];
+		items[j] = tmp;
+	}
+}
+
+enum {
+	SORT_STRCASECMP,
+	SORT_KEYS_COLD,
+	SORT_KEYS_WARM,
+};
+
+// ms per sort of a freshly shuffled copy of entries
+static double timeSort(Array* entries, Array* scratch, int mode, double seconds) {
+	int runs = 0;
+	double sorting = 0.0;
+	double start = now();
+	do {
+		memcpy(scratch->items, entries->items, entries->count * sizeof(void*));
+		scratch->count = entries->count;
+		srand(runs);
+		shuffle(scratch->items, scratch->count);
+		if (mode == SORT_KEYS_COLD) {
+			for (int i = 0; i < scratch->count; i++) {
+				Entry* entry = scratch->items[i];
+				free(entry->key);
+				entry->key = NULL;
+			}
+		}
+
+		double t = now();
+		if (mode == SORT_STRCASECMP)
+			qsort(scratch->items, scratch->count, sizeof(void*), sortStrcasecmp);
+		else
+			EntryArray_sort(scratch);
+		sorting += now() - t;
+		runs++;
+	} while (now() - start < seconds);
+	return sorting / runs * 1e3;
+}
+
+int main(int argc, char* argv[]) {
+	double seconds = argc > 1 ? atof(argv[1]) : 0.5;
+
+	srand(17);
+	Array* entries = Array_new();
+	Array* scratch = Array_new();
+	for (int i = 0; i < ENTRY_COUNT; i++) {
+		char name[256];
+		snprintf(name, sizeof(name), "%s%s %s %i%s",
+				 rand() % 8 ? "" : "The ",
+				 words[rand() % WORD_COUNT], words[rand() % WORD_COUNT], rand() % 150, suffixes[rand() % SUFFIX_COUNT]);
+		char path[MAX_PATH];
+		snprintf(path, sizeof(path), "%s/Game Boy (GB)/%s.gb", ROMS_PATH, name);
+		Array_push(entries, Entry_newNamed(path, ENTRY_ROM, name));
+		Array_push(scratch, NULL);
+	}
+
+	// the order changes, that's the point ("Disc 2" before "Disc 10")
+	memcpy(scratch->items, entries->items, entries->count * sizeof(void*));
+	EntryArray_sort(scratch);
+	int failed = 0;
+	for (int i = 1; i < scratch->count; i++) {
+		if (EntryArray_sortEntry(&scratch->items[i - 1], &scratch->items[i]) > 0) {
+			Entry* a = scratch->items[i - 1];
+			Entry* b = scratch->items[i];
+			printf("FAIL: \"%s\" sorted before \"%s\"\n", a->name, b->name);
+			failed = 1;
+			break;
+		}
+	}
+	Array* old = Array_new();
+	for (int i = 0; i < entries->count; i++)
+		Array_push(old, entries->items[i]);
+	qsort(old->items, old->count, sizeof(void*), sortStrcasecmp);
+	int moved = 0;
+	for (int i = 0; i < old->count; i++)
+		moved += old->items[i] != scratch->items[i];
+	Array_free(old);
+
+	printf("%i names, %i land somewhere else than with strcasecmp\n", ENTRY_COUNT, moved);
+	double base = timeSort(entries, scratch, SORT_STRCASECMP, seconds);
+	double cold = timeSort(entries, scratch, SORT_KEYS_COLD, seconds);
+	double warm = timeSort(entries, scratch, SORT_KEYS_WARM, seconds);
+	printf("%-12s %8.3f ms\n", "strcasecmp", base);
+	printf("%-12s %8.3f ms %6.2fx\n", "keys cold", cold, base / cold);
+	printf("%-12s %8.3f ms %6.2fx\n", "keys warm", warm, base / warm);
+
+	Array_free(scratch);
+	EntryArray_free(entries);
+	if (failed)
+		printf("key sort FAILED\n");
+	return failed;
+}
@@ -1,3 +1,5 @@
+#include <ctype.h>
+#include <strings.h>
 #include "types.h"
 
 ///////////////////////////////////////
@@ -92,62 +94,326 @@ void StringArray_free(Array* self) {
 ///////////////////////////////////////
 // Hash
 
+#define HASH_MIN_CAPACITY 16
+#define HASH_BLOCK_SIZE 4096
+
+struct HashBlock {
+	HashBlock* next;
+	size_t used;
+	size_t size;
+	char data[];
+};
+
+static uint32_t Hash_hash(const char* key) { // FNV-1a
+	uint32_t hash = 2166136261u;
+	while (*key) {
+		hash ^= (uint8_t)*key++;
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+static HashBlock* Hash_addBlock(Hash* self, size_t size) {
+	HashBlock* block = malloc(sizeof(HashBlock) + size);
+	if (!block)
+		return NULL;
+	block->used = 0;
+	block->size = size;
+	block->next = self->blocks;
+	self->blocks = block;
+	return block;
+}
+
+static char* Hash_intern(Hash* self, const char* str) {
+	size_t len = strlen(str) + 1;
+	HashBlock* block = self->blocks;
+	if (!block || block->size - block->used < len) {
+		block = Hash_addBlock(self, len > HASH_BLOCK_SIZE ? len : HASH_BLOCK_SIZE);
+		if (!block)
+			return NULL;
+	}
+	char* copy = block->data + block->used;
+	memcpy(copy, str, len);
+	block->used += len;
+	return copy;
+}
+
+static HashSlot* Hash_find(Hash* self, const char* key, uint32_t hash) {
+	int mask = self->capacity - 1;
+	int i = hash & mask;
+	while (self->slots[i].key) {
+		if (self->slots[i].hash == hash && exactMatch(self->slots[i].key, key))
+			break;
+		i = (i + 1) & mask;
+	}
+	return &self->slots[i]; // matching or the empty slot to insert into
+}
+
+static int Hash_grow(Hash* self) {
+	int capacity = self->capacity * 2;
+	HashSlot* slots = calloc(capacity, sizeof(HashSlot));
+	if (!slots)
+		return 0;
+	HashSlot* old = self->slots;
+	int old_capacity = self->capacity;
+	self->slots = slots;
+	self->capacity = capacity;
+	for (int i = 0; i < old_capacity; i++) {
+		if (!old[i].key)
+			continue;
+		int j = old[i].hash & (capacity - 1);
+		while (slots[j].key)
+			j = (j + 1) & (capacity - 1);
+		slots[j] = old[i];
+	}
+	free(old);
+	return 1;
+}
+
+// takes key and value as-is, they must already live in the arena
+static void Hash_insert(Hash* self, char* key, char* value) {
+	uint32_t hash = Hash_hash(key);
+	HashSlot* slot = Hash_find(self, key, hash);
+	if (slot->key) {
+		slot->value = value;
+		return;
+	}
+	// keep the load factor under 3/4 so probes stay short
+	if ((self->count + 1) * 4 > self->capacity * 3) {
+		if (!Hash_grow(self))
+			return;
+		slot = Hash_find(self, key, hash);
+	}
+	slot->key = key;
+	slot->value = value;
+	slot->hash = hash;
+	self->count += 1;
+}
+
 Hash* Hash_new(void) {
 	Hash* self = malloc(sizeof(Hash));
-	self->keys = Array_new();
-	self->values = Array_new();
+	self->capacity = HASH_MIN_CAPACITY;
+	self->count = 0;
+	self->slots = calloc(self->capacity, sizeof(HashSlot));
+	self->blocks = NULL;
 	return self;
 }
 void Hash_free(Hash* self) {
-	StringArray_free(self->keys);
-	StringArray_free(self->values);
+	HashBlock* block = self->blocks;
+	while (block) {
+		HashBlock* next = block->next;
+		free(block);
+		block = next;
+	}
+	free(self->slots);
 	free(self);
 }
 void Hash_set(Hash* self, const char* key, const char* value) {
-	int i = StringArray_indexOf(self->keys, key);
-	if (i >= 0) {
-		free(self->values->items[i]);
-		self->values->items[i] = strdup(value);
+	uint32_t hash = Hash_hash(key);
+	HashSlot* slot = Hash_find(self, key, hash);
+	char* copy = Hash_intern(self, value);
+	if (!copy)
+		return;
+	if (slot->key) { // replaced values stay in the arena until Hash_free
+		slot->value = copy;
 		return;
 	}
-	Array_push(self->keys, strdup(key));
-	Array_push(self->values, strdup(value));
+	char* key_copy = Hash_intern(self, key);
+	if (key_copy)
+		Hash_insert(self, key_copy, copy);
 }
 char* Hash_get(Hash* self, const char* key) {
-	int i = StringArray_indexOf(self->keys, key);
-	if (i == -1)
-		return NULL;
-	return self->values->items[i];
+	HashSlot* slot = Hash_find(self, key, Hash_hash(key));
+	return slot->key ? slot->value : NULL;
+}
+int Hash_loadMap(Hash* self, const char* path) {
+	FILE* file = fopen(path, "rb");
+	if (!file)
+		return 0;
+	fseek(file, 0, SEEK_END);
+	long size = ftell(file);
+	fseek(file, 0, SEEK_SET);
+	if (size <= 0) {
+		fclose(file);
+		return 0;
+	}
+
+	// the whole file becomes an arena block, keys and values are
+	// terminated in place instead of being copied
+	HashBlock* block = Hash_addBlock(self, size + 1);
+	if (!block) {
+		fclose(file);
+		return 0;
+	}
+	size_t read = fread(block->data, 1, size, file);
+	fclose(file);
+	block->data[read] = '\0';
+	block->used = read + 1;
+
+	int count = 0;
+	char* line = block->data;
+	char* end = block->data + read;
+	while (line < end) {
+		char* next = memchr(line, '\n', end - line);
+		if (next)
+			*next = '\0';
+		else
+			next = end;
+
+		size_t len = next - line;
+		if (len > 0 && line[len - 1] == '\r') // windows!
+			line[--len] = '\0';
+
+		char* tab = len ? strchr(line, '\t') : NULL;
+		if (tab) {
+			*tab = '\0';
+			Hash_insert(self, line, tab + 1);
+			count += 1;
+		}
+		line = next + 1;
+	}
+	return count;
+}
+
+///////////////////////////////////////
+// EntryArena
+
+#define ENTRY_ARENA_BLOCK_SIZE 16384
+
+typedef struct EntryArenaBlock EntryArenaBlock;
+struct EntryArenaBlock {
+	EntryArenaBlock* next;
+	size_t used;
+	size_t size;
+	char data[];
+};
+
+struct EntryArena {
+	EntryArenaBlock* blocks;
+};
+
+static __thread EntryArena* current_arena = NULL;
+
+EntryArena* EntryArena_new(void) {
+	return calloc(1, sizeof(EntryArena));
+}
+
+void EntryArena_free(EntryArena* self) {
+	if (!self)
+		return;
+	EntryArenaBlock* block = self->blocks;
+	while (block) {
+		EntryArenaBlock* next = block->next;
+		free(block);
+		block = next;
+	}
+	free(self);
+}
+
+EntryArena* EntryArena_use(EntryArena* self) {
+	EntryArena* previous = current_arena;
+	current_arena = self;
+	return previous;
+}
+
+static void* EntryArena_alloc(EntryArena* self, size_t size, size_t align) {
+	EntryArenaBlock* block = self->blocks;
+	size_t offset = block ? (block->used + align - 1) & ~(align - 1) : 0;
+	if (!block || offset + size > block->size) {
+		size_t block_size = size > ENTRY_ARENA_BLOCK_SIZE ? size : ENTRY_ARENA_BLOCK_SIZE;
+		block = malloc(sizeof(EntryArenaBlock) + block_size);
+		if (!block)
+			return NULL;
+		block->used = 0;
+		block->size = block_size;
+		block->next = self->blocks;
+		self->blocks = block;
+		offset = 0;
+	}
+	block->used = offset + size;
+	return block->data + offset;
 }
 
 ///////////////////////////////////////
 // Entry
 
-Entry* Entry_new(const char* path, int type) {
-	char display_name[MAX_PATH];
-	getDisplayName(path, display_name);
-	Entry* self = malloc(sizeof(Entry));
-	self->path = strdup(path);
-	self->name = strdup(display_name);
+// Entries made while an arena is current live in it along with all of
+// their strings, Entry_free leaves those alone and the arena releases
+// them all at once. Everything else is plain malloc.
+
+static char* Entry_strdup(EntryArena* arena, const char* str) {
+	if (!arena)
+		return strdup(str);
+	size_t len = strlen(str) + 1;
+	char* copy = EntryArena_alloc(arena, len, 1);
+	if (copy)
+		memcpy(copy, str, len);
+	return copy;
+}
+
+static void Entry_release(Entry* self, void* ptr) {
+	if (!self->arena)
+		free(ptr);
+}
+
+static Entry* Entry_create(const char* path, int type, const char* name) {
+	EntryArena* arena = current_arena;
+	Entry* self = arena ? EntryArena_alloc(arena, sizeof(Entry), sizeof(void*)) : malloc(sizeof(Entry));
+	self->arena = arena;
+	self->path = Entry_strdup(arena, path);
+	self->name = Entry_strdup(arena, name);
 	self->unique = NULL;
+	self->key = NULL;
 	self->type = type;
 	self->alpha = 0;
 	self->quickId = QUICK_NONE;
 	return self;
 }
 
+Entry* Entry_new(const char* path, int type) {
+	char display_name[MAX_PATH];
+	getDisplayName(path, display_name);
+	return Entry_create(path, type, display_name);
+}
+
 Entry* Entry_newNamed(const char* path, int type, const char* displayName) {
-	Entry* self = Entry_new(path, type);
-	free(self->name);
-	self->name = strdup(displayName);
-	return self;
+	return Entry_create(path, type, displayName);
+}
+
+void Entry_setName(Entry* self, const char* name) {
+	char* copy = Entry_strdup(self->arena, name); // name may be self->name
+	Entry_release(self, self->name);
+	Entry_release(self, self->key);
+	self->name = copy;
+	self->key = NULL;
+}
+
+void Entry_setUnique(Entry* self, const char* unique) {
+	char* copy = unique ? Entry_strdup(self->arena, unique) : NULL;
+	Entry_release(self, self->unique);
+	self->unique = copy;
+}
+
+Entry* Entry_copy(Entry* self) {
+	EntryArena* arena = current_arena;
+	Entry* copy = arena ? EntryArena_alloc(arena, sizeof(Entry), sizeof(void*)) : malloc(sizeof(Entry));
+	*copy = *self;
+	copy->arena = arena;
+	copy->path = Entry_strdup(arena, self->path);
+	copy->name = Entry_strdup(arena, self->name);
+	copy->unique = self->unique ? Entry_strdup(arena, self->unique) : NULL;
+	copy->key = self->key ? Entry_strdup(arena, self->key) : NULL;
+	return copy;
 }
 
 void Entry_free(Entry* self) {
+	if (self->arena)
+		return; // reclaimed with the arena
 	free(self->path);
 	free(self->name);
 	if (self->unique)
 		free(self->unique);
+	free(self->key);
 	free(self);
 }
 
@@ -159,12 +425,69 @@ int EntryArray_indexOf(Array* self, const char* path) {
 	}
 	return -1;
 }
+
+// lowercased name without a leading "The ", with every run of digits
+// rewritten as '0', a length byte and the digits minus leading zeros so
+// plain strcmp puts "Disc 2" before "Disc 10". '0' can't appear in a key
+// any other way, so a number only ever gets compared against another number.
+void Entry_makeKey(const char* name, char* key) {
+	if (strncasecmp(name, "the ", 4) == 0 && name[4])
+		name += 4;
+
+	char* out = key;
+	const char* c = name;
+	while (*c && c - name < MAX_PATH) {
+		if (*c >= '0' && *c <= '9') {
+			while (*c == '0' && c - name < MAX_PATH)
+				c += 1;
+			const char* digits = c;
+			while (*c >= '0' && *c <= '9' && c - name < MAX_PATH)
+				c += 1;
+			int len = c - digits;
+			*out++ = '0';
+			*out++ = len < 200 ? len + 1 : 200;
+			memcpy(out, digits, len);
+			out += len;
+		} else {
+			*out++ = tolower((unsigned char)*c++);
+		}
+	}
+	*out = '\0';
+}
+
+static char* Entry_buildKey(Entry* self) {
+	char key[ENTRY_KEY_SIZE];
+	Entry_makeKey(self->name, key);
+	return Entry_strdup(self->arena, key);
+}
+
+const char* Entry_key(Entry* self) {
+	if (!self->key)
+		self->key = Entry_buildKey(self);
+	return self->key ? self->key : self->name;
+}
+
+int Entry_indexChar(Entry* self) {
+	char c = Entry_key(self)[0];
+	if (c >= 'a' && c <= 'z')
+		return (c - 'a') + 1;
+	return 0;
+}
+
 int EntryArray_sortEntry(const void* a, const void* b) {
 	Entry* item1 = *(Entry**)a;
 	Entry* item2 = *(Entry**)b;
-	return strcasecmp(item1->name, item2->name);
+	int result = strcmp(Entry_key(item1), Entry_key(item2));
+	if (result)
+		return result;
+	// same key, keep identical names next to each other for Directory_index
+	result = strcasecmp(item1->name, item2->name);
+	return result ? result : strcmp(item1->name, item2->name);
 }
 void EntryArray_sort(Array* self) {
+	// build every key up front so the comparisons are plain strcmps
+	for (int i = 0; i < self->count; i++)
+		Entry_key(self->items[i]);
 	qsort(self->items, self->count, sizeof(void*), EntryArray_sortEntry);
 }
 
@@ -195,6 +518,7 @@ void Directory_free(Directory* self) {
 	free(self->path);
 	free(self->name);
 	EntryArray_free(self->entries);
+	EntryArena_free(self->arena);
 	free(self);
 }
 
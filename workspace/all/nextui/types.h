@@ -31,15 +31,30 @@ void StringArray_free(Array* self);
 ///////////////////////////////////////
 // Hash
 
+// open addressing with linear probing, keys and values live in an
+// arena of blocks that never move, so returned strings stay valid
+// until Hash_free
+
+typedef struct HashSlot {
+	char* key; // NULL if empty
+	char* value;
+	uint32_t hash;
+} HashSlot;
+
+typedef struct HashBlock HashBlock;
+
 typedef struct Hash {
-	Array* keys;
-	Array* values;
-} Hash; // not really a hash
+	HashSlot* slots;
+	int capacity; // power of two
+	int count;
+	HashBlock* blocks;
+} Hash;
 
 Hash* Hash_new(void);
 void Hash_free(Hash* self);
 void Hash_set(Hash* self, const char* key, const char* value);
 char* Hash_get(Hash* self, const char* key);
+int Hash_loadMap(Hash* self, const char* path); // reads a tab-separated key/value file, returns number of pairs
 
 ///////////////////////////////////////
 // Entry
@@ -64,10 +79,19 @@ enum QuickAction {
 	QUICK_SCREENSHOT,
 };
 
+typedef struct EntryArena EntryArena;
+
+// bump allocator for Entries and their strings, see Entry_new
+EntryArena* EntryArena_new(void);
+void EntryArena_free(EntryArena* self); // frees every Entry allocated from it
+EntryArena* EntryArena_use(EntryArena* self); // Entries made on this thread come from self (NULL for malloc), returns the previous arena
+
 typedef struct Entry {
+	EntryArena* arena; // owner, NULL if malloc'd
 	char* path;
 	char* name;
 	char* unique;
+	char* key; // collation key, built on first sort, NULL until then
 	int type;
 	int alpha;	 // index in parent Directory's alphas Array, which points to the index of an Entry in its entries Array :sweat_smile:
 	int quickId; // QuickAction enum, 0 for non-DIP entries
@@ -75,6 +99,14 @@ typedef struct Entry {
 
 Entry* Entry_new(const char* path, int type);
 Entry* Entry_newNamed(const char* path, int type, const char* displayName);
+Entry* Entry_copy(Entry* self);
+void Entry_setName(Entry* self, const char* name); // also drops the stale key
+void Entry_setUnique(Entry* self, const char* unique);
+const char* Entry_key(Entry* self);
+// every digit run adds 2 bytes and there's at most one per 2 chars of name
+#define ENTRY_KEY_SIZE (MAX_PATH * 2 + 3)
+void Entry_makeKey(const char* name, char* key); // the collation key Entry_key caches, key needs ENTRY_KEY_SIZE bytes
+int Entry_indexChar(Entry* self); // 1-26 for a-z, 0 otherwise, by sort order
 void Entry_free(Entry* self);
 int EntryArray_indexOf(Array* self, const char* path);
 int EntryArray_sortEntry(const void* a, const void* b);
@@ -100,6 +132,7 @@ typedef struct Directory {
 	char* path;
 	char* name;
 	Array* entries;
+	EntryArena* arena; // owns entries, NULL if they're malloc'd
 	IntArray alphas;
 	// rendering
 	int selected;
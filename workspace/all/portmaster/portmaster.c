@@ -90,7 +90,6 @@ static bool bash_available(void) {
 }
 
 static void invalidate_emulist_cache(void) {
-	unlink(EMULIST_CACHE_PATH);
 	unlink(ROMINDEX_CACHE_PATH);
 }
 
@@ -1392,7 +1392,6 @@ static void reset_ra_page(void) {
 
 static SettingItem* refresh_emulist_item = NULL;
 static void refresh_emulist(void) {
-	unlink(EMULIST_CACHE_PATH);
 	unlink(ROMINDEX_CACHE_PATH);
 	if (refresh_emulist_item)
 		refresh_emulist_item->desc = "Done! Emulator list will refresh on next launch.";
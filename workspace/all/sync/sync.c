@@ -1089,7 +1089,6 @@ int main(int argc, char* argv[]) {
 
 				if (sync_result == 0) {
 					if (sync_roms) {
-						unlink(EMULIST_CACHE_PATH);
 						unlink(ROMINDEX_CACHE_PATH);
 					}
 					state = STATE_DONE;